@@ -0,0 +1,56 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common.js');
+
+// Throughput of the string encoders and decoders that have vectorized
+// fast paths, from tiny to very large inputs.
+var bench = common.createBenchmark(main, {
+  encoding: ['hex', 'ascii', 'utf8'],
+  op: ['toString', 'write'],
+  len: [16, 1024, 64 * 1024, 16 * 1024 * 1024]
+});
+
+function main(conf) {
+  var len = +conf.len;
+  var encoding = conf.encoding;
+  var n = Math.max(1, (256 * 1024 * 1024 / len) | 0);
+  var buf = new Buffer(len);
+
+  for (var i = 0; i < len; i++)
+    buf[i] = 32 + i % 95;
+
+  var str = buf.toString(encoding);
+  var out = new Buffer(Buffer.byteLength(str, encoding));
+  var bytes = 0;
+
+  if (conf.op === 'toString') {
+    bench.start();
+    for (var i = 0; i < n; i++)
+      bytes += buf.toString(encoding).length;
+    bench.end(n * len / 1e6);
+  } else {
+    bench.start();
+    for (var i = 0; i < n; i++)
+      bytes += out.write(str, 0, encoding);
+    bench.end(n * len / 1e6);
+  }
+}
@@ -2,10 +2,10 @@ var common = require('../common.js');
 
 var bench = common.createBenchmark(main, {
   writes: [500],
-  cipher: [ 'AES192', 'AES256' ],
+  cipher: [ 'AES192', 'AES256', 'aes-256-ctr' ],
   type: ['asc', 'utf', 'buf'],
   len: [2, 1024, 102400, 1024 * 1024],
-  api: ['legacy', 'stream']
+  api: ['legacy', 'stream', 'into', 'inplace']
 });
 
 function main(conf) {
@@ -17,6 +17,16 @@ function main(conf) {
   }
 
   var crypto = require('crypto');
+  if ((api === 'into' || api === 'inplace') &&
+      !crypto.Cipher.prototype.updateInto) {
+    console.error('updateInto() not available, using the legacy api');
+    api = 'legacy';
+  }
+  if (api === 'inplace' && !/-ctr$/.test(conf.cipher)) {
+    console.error('Block modes can\'t update in place, using updateInto()');
+    api = 'into';
+  }
+
   var assert = require('assert');
   var alice = crypto.getDiffieHellman('modp5');
   var bob = crypto.getDiffieHellman('modp5');
@@ -54,7 +64,10 @@ function main(conf) {
       throw new Error('unknown message type: ' + conf.type);
   }
 
-  var fn = api === 'stream' ? streamWrite : legacyWrite;
+  var fn = api === 'stream' ? streamWrite :
+           api === 'into' ? intoWrite :
+           api === 'inplace' ? inPlaceWrite :
+           legacyWrite;
 
   // write data as fast as possible to alice, and have bob decrypt.
   // use old API for comparison to v0.8
@@ -96,6 +109,42 @@ function legacyWrite(alice, bob, message, encoding, writes) {
   dec = bob.final();
   written += dec.length;
   var bits = written * 8;
-  var gbits = written / (1024 * 1024 * 1024);
+  var gbits = bits / (1024 * 1024 * 1024);
+  bench.end(gbits);
+}
+
+// Same as legacy, but into preallocated buffers
+function intoWrite(alice, bob, message, encoding, writes) {
+  if (!Buffer.isBuffer(message))
+    message = new Buffer(message, encoding);
+
+  // Room for a block held back by each side
+  var enc = new Buffer(message.length + 32);
+  var dec = new Buffer(message.length + 64);
+  var written = 0;
+  for (var i = 0; i < writes; i++) {
+    var n = alice.updateInto(message, enc, 0);
+    written += bob.updateInto(enc.slice(0, n), dec, 0);
+  }
+  var rest = alice.final();
+  written += bob.updateInto(rest, dec, 0);
+  written += bob.final().length;
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+  bench.end(gbits);
+}
+
+// Stream modes only, encrypt and decrypt the same buffer back and forth
+function inPlaceWrite(alice, bob, message, encoding, writes) {
+  if (!Buffer.isBuffer(message))
+    message = new Buffer(message, encoding);
+
+  var written = 0;
+  for (var i = 0; i < writes; i++) {
+    alice.updateInto(message);
+    written += bob.updateInto(message);
+  }
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
   bench.end(gbits);
 }
@@ -0,0 +1,48 @@
+// Hash large buffers while a 1 ms interval timer runs and report the worst
+// event loop lag seen, in milliseconds (lower is better). The sync api runs
+// createHash().update().digest() on the main thread, async uses hashAsync().
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  api: ['sync', 'async'],
+  algo: ['sha256', 'md5'],
+  len: [16 * 1024 * 1024, 200 * 1024 * 1024],
+  n: [8]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var algo = conf.algo;
+  var data = new Buffer(+conf.len);
+  data.fill('h');
+
+  var maxLag = 0;
+  var last = now();
+  var timer = setInterval(function() {
+    var t = now();
+    maxLag = Math.max(maxLag, t - last - 1);
+    last = t;
+  }, 1);
+
+  var done = 0;
+  function next() {
+    if (done++ === n) {
+      clearInterval(timer);
+      return bench.report(maxLag);
+    }
+    if (conf.api === 'sync') {
+      crypto.createHash(algo).update(data).digest();
+      setImmediate(next);
+    } else {
+      crypto.hashAsync(algo, data, next);
+    }
+  }
+  // Let the timer settle first.
+  setTimeout(next, 10);
+}
+
+function now() {
+  var t = process.hrtime();
+  return t[0] * 1e3 + t[1] / 1e6;
+}
@@ -1,5 +1,6 @@
 // throughput benchmark
 // creates a single hasher, then pushes a bunch of data through it
+// batch and batch-async digest all messages with one crypto.hashBatch() call
 var common = require('../common.js');
 var crypto = require('crypto');
 
@@ -9,7 +10,7 @@ var bench = common.createBenchmark(main, {
   type: ['asc', 'utf', 'buf'],
   out: ['hex', 'binary', 'buffer'],
   len: [2, 1024, 102400, 1024 * 1024],
-  api: ['legacy', 'stream']
+  api: ['legacy', 'stream', 'batch', 'batch-async']
 });
 
 function main(conf) {
@@ -23,6 +24,11 @@ function main(conf) {
   var crypto = require('crypto');
   var assert = require('assert');
 
+  if (/^batch/.test(api) && !crypto.hashBatch) {
+    console.error('crypto.hashBatch() not available');
+    api = 'legacy';
+  }
+
   var message;
   var encoding;
   switch (conf.type) {
@@ -42,7 +48,10 @@ function main(conf) {
       throw new Error('unknown message type: ' + conf.type);
   }
 
-  var fn = api === 'stream' ? streamWrite : legacyWrite;
+  var fn = api === 'stream' ? streamWrite :
+           api === 'batch' ? batchWrite :
+           api === 'batch-async' ? batchAsyncWrite :
+           legacyWrite;
 
   bench.start();
   fn(conf.algo, message, encoding, conf.writes, conf.len, conf.out);
@@ -84,3 +93,40 @@ function streamWrite(algo, message, encoding, writes, len, outEnc) {
 
   bench.end(gbits);
 }
+
+function batchInputs(message, encoding, writes) {
+  if (!Buffer.isBuffer(message))
+    message = new Buffer(message, encoding);
+
+  var inputs = new Array(writes);
+  for (var i = 0; i < writes; i++)
+    inputs[i] = message;
+  return inputs;
+}
+
+function batchWrite(algo, message, encoding, writes, len, outEnc) {
+  var written = writes * len;
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+
+  crypto.hashBatch(algo,
+                   batchInputs(message, encoding, writes),
+                   { encoding: outEnc });
+
+  bench.end(gbits);
+}
+
+function batchAsyncWrite(algo, message, encoding, writes, len, outEnc) {
+  var written = writes * len;
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+
+  crypto.hashBatch(algo,
+                   batchInputs(message, encoding, writes),
+                   { encoding: outEnc },
+                   function(err, res) {
+                     if (err)
+                       throw err;
+                     bench.end(gbits);
+                   });
+}
@@ -0,0 +1,72 @@
+// Tail latency of fs.stat() while a burst of key derivations is running.
+// Key derivation runs as slow CPU work in the thread pool, which is capped
+// separately so it can't take every thread away from file system requests.
+// Reports the 99th percentile latency in milliseconds.
+
+var common = require('../common.js');
+var crypto = require('crypto');
+var fs = require('fs');
+
+var bench = common.createBenchmark(main, {
+  kdf: ['none', 'pbkdf2', 'scrypt'],
+  burst: [4, 16],
+  n: [500]
+});
+
+var kdfs = {
+  none: null,
+  pbkdf2: function(cb) {
+    return crypto.pbkdf2('password', 'salt', 1e5, 64, cb);
+  },
+  scrypt: function(cb) {
+    return crypto.scrypt('password', 'salt', 64, cb);
+  }
+};
+
+function main(conf) {
+  var kdf = kdfs[conf.kdf];
+  var burst = +conf.burst;
+  var n = +conf.n;
+  var latencies = [];
+  var pending = [];
+
+  // Keep the burst going for as long as the measurement runs.
+  function derive() {
+    var req = kdf(function(er) {
+      pending.splice(pending.indexOf(req), 1);
+      if (er && er.code !== 'ECANCELED')
+        throw er;
+      if (kdf !== null)
+        derive();
+    });
+    pending.push(req);
+  }
+
+  if (kdf !== null)
+    for (var i = 0; i < burst; i++)
+      derive();
+
+  next();
+
+  function next() {
+    if (latencies.length === n)
+      return done();
+    var start = process.hrtime();
+    fs.stat(__filename, function(er) {
+      if (er)
+        throw er;
+      var t = process.hrtime(start);
+      latencies.push(t[0] * 1e3 + t[1] / 1e6);
+      next();
+    });
+  }
+
+  function done() {
+    kdf = null;
+    pending.forEach(function(req) {
+      req.cancel();
+    });
+    latencies.sort(function(a, b) { return a - b; });
+    bench.report(latencies[Math.floor(latencies.length * 0.99)]);
+  }
+}
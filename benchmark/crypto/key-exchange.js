@@ -0,0 +1,35 @@
+// Key generation plus secret computation, one side of an exchange per
+// operation. Pairs are of roughly equal strength: modp14 (2048 bits) and
+// secp224r1 give 112-bit security, modp15 (3072 bits) and prime256v1 128-bit,
+// modp17 (6144 bits) and secp384r1 192-bit.
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  exchange: ['dh-modp14', 'ecdh-secp224r1',
+             'dh-modp15', 'ecdh-prime256v1',
+             'dh-modp17', 'ecdh-secp384r1'],
+  n: [50]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var type = conf.exchange.split('-')[0];
+  var name = conf.exchange.slice(type.length + 1);
+
+  var create = type === 'dh' ?
+      function() { return crypto.getDiffieHellman(name); } :
+      function() { return crypto.createECDH(name); };
+
+  var peer = create();
+  peer.generateKeys();
+  var peerKey = peer.getPublicKey();
+
+  bench.start();
+  for (var i = 0; i < n; i++) {
+    var self = create();
+    self.generateKeys();
+    self.computeSecret(peerKey);
+  }
+  bench.end(n);
+}
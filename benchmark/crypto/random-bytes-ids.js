@@ -0,0 +1,62 @@
+// Async crypto.randomBytes(16) as used for request ids. With the pool api
+// small requests are served from pregenerated bytes, direct queues a thread
+// pool job per call like before.
+//
+// metric:
+//   ids   ids per second
+//   jobs  thread pool jobs per 1000 ids
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  api: ['pool', 'direct'],
+  size: [16],
+  concurrency: [1, 64],
+  metric: ['ids', 'jobs'],
+  dur: [3]
+});
+
+function main(conf) {
+  var size = +conf.size;
+  var fn = crypto.randomBytes;
+  if (conf.api === 'direct')
+    fn = process.binding('crypto').randomBytes;
+
+  var uv = process.binding('uv');
+  if (conf.metric === 'jobs' && !uv.getThreadpoolStats) {
+    console.error('Thread pool counters not available');
+    process.exit(0);
+  }
+
+  var ids = 0;
+  var running = true;
+  var startJobs = 0;
+
+  // Let the pool fill up first
+  setTimeout(function() {
+    if (conf.metric === 'jobs')
+      startJobs = uv.getThreadpoolStats().cpu.completed;
+    bench.start();
+    for (var i = 0; i < +conf.concurrency; i++)
+      next();
+    setTimeout(function() {
+      running = false;
+      if (conf.metric === 'jobs') {
+        var jobs = uv.getThreadpoolStats().cpu.completed - startJobs;
+        bench.report(jobs * 1000 / ids);
+      } else {
+        bench.end(ids);
+      }
+    }, +conf.dur * 1000);
+  }, 100);
+
+  function next() {
+    fn(size, function(err, buf) {
+      if (err)
+        throw err;
+      ids++;
+      if (running)
+        next();
+    });
+  }
+}
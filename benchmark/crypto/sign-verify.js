@@ -0,0 +1,65 @@
+// Sign or verify a short token with the same key over and over, passing the
+// key as a PEM string (parsed on every call) or as a pre-parsed key object,
+// through the Sign/Verify objects or the one-shot crypto.sign/verify.
+var common = require('../common.js');
+var crypto = require('crypto');
+var fs = require('fs');
+var path = require('path');
+
+var fixtures = path.resolve(__dirname, '../../test/fixtures');
+
+var keys = {
+  rsa: {
+    algo: 'RSA-SHA256',
+    priv: fs.readFileSync(fixtures + '/test_rsa_privkey.pem', 'ascii'),
+    pub: fs.readFileSync(fixtures + '/test_rsa_pubkey.pem', 'ascii')
+  },
+  ec: {
+    algo: 'SHA256',
+    priv: fs.readFileSync(fixtures + '/keys/ec-key.pem', 'ascii'),
+    pub: fs.readFileSync(fixtures + '/keys/ec-cert.pem', 'ascii')
+  }
+};
+
+var bench = common.createBenchmark(main, {
+  type: ['rsa', 'ec'],
+  op: ['sign', 'verify'],
+  key: ['pem', 'object'],
+  api: ['stream', 'oneshot'],
+  n: [10000]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var k = keys[conf.type];
+  var oneshot = conf.api === 'oneshot';
+  var data = new Buffer('{"alg":"RS256","typ":"JWT"}.{"sub":"1234567890"}');
+
+  var priv = k.priv;
+  var pub = k.pub;
+  if (conf.key === 'object') {
+    priv = crypto.createPrivateKey(priv);
+    pub = crypto.createPublicKey(pub);
+  }
+
+  var sig = crypto.createSign(k.algo).update(data).sign(k.priv);
+  var i;
+
+  bench.start();
+  if (conf.op === 'sign') {
+    for (i = 0; i < n; i++) {
+      if (oneshot)
+        crypto.sign(k.algo, data, priv);
+      else
+        crypto.createSign(k.algo).update(data).sign(priv);
+    }
+  } else {
+    for (i = 0; i < n; i++) {
+      if (oneshot)
+        crypto.verify(k.algo, data, pub, sig);
+      else
+        crypto.createVerify(k.algo).update(data).verify(pub, sig);
+    }
+  }
+  bench.end(n);
+}
@@ -7,14 +7,27 @@ if (cluster.isMaster) {
     // unicode confuses ab on os x.
     type: ['bytes', 'buffer'],
     length: [4, 1024, 102400],
-    c: [50, 500]
+    c: [50, 500],
+    sched: ['rr', 'none', 'reuseport']
   });
 } else {
-  require('../http_simple.js');
+  var requests = 0;
+  require('../http_simple.js').on('request', function() {
+    requests++;
+  });
+  process.on('message', function() {
+    process.send({ requests: requests });
+  });
 }
 
 function main(conf) {
   process.env.PORT = PORT;
+  cluster.schedulingPolicy = {
+    rr: cluster.SCHED_RR,
+    none: cluster.SCHED_NONE,
+    reuseport: cluster.SCHED_REUSEPORT
+  }[conf.sched];
+
   var workers = 0;
   var w1 = cluster.fork();
   var w2 = cluster.fork();
@@ -29,9 +42,31 @@ function main(conf) {
       var args = ['-d', '10s', '-t', 8, '-c', conf.c];
 
       bench.http(path, args, function() {
-        w1.destroy();
-        w2.destroy();
+        balance([w1, w2], function() {
+          w1.destroy();
+          w2.destroy();
+        });
       });
     }, 100);
   });
 }
+
+// Print how the requests were spread over the workers. A perfectly balanced
+// run prints a max/min ratio of 1.00.
+function balance(workers, cb) {
+  var counts = [];
+  workers.forEach(function(w) {
+    w.once('message', function(msg) {
+      counts.push(msg.requests);
+      if (counts.length < workers.length)
+        return;
+      var max = Math.max.apply(null, counts);
+      var min = Math.min.apply(null, counts);
+      console.error('requests per worker: %s (max/min %s)',
+                    counts.join(' '),
+                    (max / Math.max(min, 1)).toFixed(2));
+      cb();
+    });
+    w.send('count');
+  });
+}
@@ -0,0 +1,57 @@
+// measure header delivery cost of the parser binding, comparing the default
+// array of strings with the flat Buffer + offset table mode.
+
+var common = require('../common.js');
+var HTTPParser = process.binding('http_parser').HTTPParser;
+
+var kOnHeaders = HTTPParser.kOnHeaders | 0;
+var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+
+var bench = common.createBenchmark(main, {
+  mode: ['strings', 'flat'],
+  headers: [4, 16, 30],
+  n: [1e5]
+});
+
+// A typical browser request, padded with custom headers.
+var browserHeaders = [
+  'Host: example.com',
+  'Connection: keep-alive',
+  'Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8',
+  'User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36',
+  'Accept-Encoding: gzip,deflate,sdch',
+  'Accept-Language: en-US,en;q=0.8',
+  'Cookie: session=0123456789abcdef; tracking=fedcba9876543210',
+  'X-Forwarded-For: 10.0.0.1'
+];
+
+function main(conf) {
+  var n = +conf.n;
+  var request = 'GET /index.html HTTP/1.1\r\n';
+  for (var i = 0; i < +conf.headers; i++) {
+    if (i < browserHeaders.length)
+      request += browserHeaders[i] + '\r\n';
+    else
+      request += 'X-Custom-Header-' + i + ': value ' + i + '\r\n';
+  }
+  request = new Buffer(request + '\r\n', 'binary');
+
+  var parser = new HTTPParser(HTTPParser.REQUEST);
+  var complete = 0;
+  var count = 0;
+  parser.setFlatHeaders(conf.mode === 'flat');
+  parser[kOnHeaders] = function() {};
+  parser[kOnHeadersComplete] = function(info) {
+    // touch the headers so that the work can't be optimized away
+    count += info.headers.length;
+  };
+  parser[kOnMessageComplete] = function() { complete++; };
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    parser.execute(request);
+  if (complete !== n)
+    throw new Error('parsed ' + complete + ' of ' + n + ' requests');
+  bench.end(n);
+}
@@ -0,0 +1,44 @@
+// measure the cost of parsing requests whose headers are split across
+// several execute() calls, e.g. by TCP segment boundaries.
+
+var common = require('../common.js');
+var HTTPParser = process.binding('http_parser').HTTPParser;
+
+var kOnHeaders = HTTPParser.kOnHeaders | 0;
+var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+
+var bench = common.createBenchmark(main, {
+  headers: [8, 32],
+  chunk: [1, 7, 64, 0],  // 0 means the whole request at once
+  n: [1e4]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var request = 'GET /some/path?with=a&query=string HTTP/1.1\r\n';
+  for (var i = 0; i < +conf.headers; i++)
+    request += 'X-Header-' + i + ': some header value number ' + i + '\r\n';
+  request += '\r\n';
+  request = new Buffer(request, 'binary');
+
+  var size = +conf.chunk || request.length;
+  var chunks = [];
+  for (var off = 0; off < request.length; off += size)
+    chunks.push(request.slice(off, off + size));
+
+  var parser = new HTTPParser(HTTPParser.REQUEST);
+  var complete = 0;
+  parser[kOnHeaders] = function() {};
+  parser[kOnHeadersComplete] = function() {};
+  parser[kOnMessageComplete] = function() { complete++; };
+
+  bench.start();
+  for (var i = 0; i < n; i++) {
+    for (var j = 0; j < chunks.length; j++)
+      parser.execute(chunks[j]);
+  }
+  if (complete !== n)
+    throw new Error('parsed ' + complete + ' of ' + n + ' requests');
+  bench.end(n);
+}
@@ -0,0 +1,38 @@
+// measure the cost of parsing requests with many headers and make sure they
+// reach JS in one callback.
+
+var common = require('../common.js');
+var HTTPParser = process.binding('http_parser').HTTPParser;
+
+var kOnHeaders = HTTPParser.kOnHeaders | 0;
+var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+
+var bench = common.createBenchmark(main, {
+  headers: [8, 32, 64, 128],
+  n: [1e4]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var request = 'GET /index.html HTTP/1.1\r\n';
+  for (var i = 0; i < +conf.headers; i++)
+    request += 'X-Header-' + i + ': some header value ' + i + '\r\n';
+  request = new Buffer(request + '\r\n', 'binary');
+
+  var parser = new HTTPParser(HTTPParser.REQUEST);
+  var crossings = 0;
+  var complete = 0;
+  parser[kOnHeaders] = function() { crossings++; };
+  parser[kOnHeadersComplete] = function() { crossings++; };
+  parser[kOnMessageComplete] = function() { complete++; };
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    parser.execute(request);
+  if (complete !== n)
+    throw new Error('parsed ' + complete + ' of ' + n + ' requests');
+  if (crossings !== n)
+    throw new Error(crossings + ' header callbacks for ' + n + ' requests');
+  bench.end(n);
+}
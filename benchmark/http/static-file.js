@@ -0,0 +1,91 @@
+// Serve a static file the way benchmark/static_http_server.js serves a
+// string, with and without the sendfile() fast path, and report the CPU
+// seconds the process spent per GB served (lower is better).
+
+var common = require('../common.js');
+var fs = require('fs');
+var http = require('http');
+var net = require('net');
+var path = require('path');
+var Readable = require('stream').Readable;
+
+var filename = path.resolve(__dirname, '.removeme-benchmark-garbage');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  sendfile: ['true', 'false'],
+  size: [64 * 1024, 1024 * 1024, 16 * 1024 * 1024],
+  c: [30]
+});
+
+// Falls back to wall clock time where /proc is not available.
+function cpuSeconds() {
+  try {
+    var stat = fs.readFileSync('/proc/self/stat', 'ascii');
+    var fields = stat.slice(stat.lastIndexOf(')') + 2).split(' ');
+    // utime and stime, in clock ticks of (almost always) 10 ms.
+    return (+fields[11] + +fields[12]) / 100;
+  } catch (e) {
+    var t = process.hrtime();
+    return t[0] + t[1] / 1e9;
+  }
+}
+
+function main(conf) {
+  var size = +conf.size;
+  var concurrency = +conf.c;
+  var total = Math.max(concurrency, (2 * 1024 * 1024 * 1024 / size) | 0);
+  var useSendfile = conf.sendfile === 'true';
+
+  var chunk = new Buffer(64 * 1024);
+  chunk.fill('C');
+  var fd = fs.openSync(filename, 'w');
+  for (var written = 0; written < size; written += chunk.length)
+    fs.writeSync(fd, chunk, 0, Math.min(chunk.length, size - written));
+  fs.closeSync(fd);
+
+  var header = 'HTTP/1.1 200 OK\r\n' +
+               'Content-Type: text/plain\r\n' +
+               'Content-Length: ' + size + '\r\n' +
+               'Connection: close\r\n\r\n';
+
+  var server = net.createServer(function(socket) {
+    socket.once('data', function() {
+      socket.write(header);
+      var file = fs.createReadStream(filename);
+      if (useSendfile)
+        file.pipe(socket);
+      else
+        Readable.prototype.pipe.call(file, socket);
+    });
+  });
+
+  server.listen(PORT, function() {
+    var agent = new http.Agent();
+    agent.maxSockets = concurrency;
+
+    var requests = 0;
+    var responses = 0;
+    var start = cpuSeconds();
+
+    function request() {
+      requests++;
+      http.get({ port: PORT, path: '/', agent: agent }, function(res) {
+        res.resume();
+        res.on('end', function() {
+          if (++responses === total) {
+            var gb = total * size / (1024 * 1024 * 1024);
+            server.close();
+            try { fs.unlinkSync(filename); } catch (e) {}
+            bench.report((cpuSeconds() - start) / gb);
+          } else if (requests < total) {
+            request();
+          }
+        });
+      });
+    }
+
+    for (var i = 0; i < concurrency; i++)
+      request();
+  });
+}
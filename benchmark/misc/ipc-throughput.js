@@ -0,0 +1,71 @@
+// Messages per second over a child_process IPC channel, JSON vs. binary
+// framing. The 'object' payload looks like a cluster internal message.
+if (process.argv[2] === 'child')
+  return child();
+
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  serialization: ['json', 'binary'],
+  payload: ['object', 'buffer'],
+  len: [64, 1024],
+  dur: [5]
+});
+
+var fork = require('child_process').fork;
+
+function main(conf) {
+  var dur = +conf.dur;
+  var len = +conf.len;
+
+  var message;
+  if (conf.payload === 'buffer') {
+    message = { cmd: 'data', data: new Buffer(len), seq: 0 };
+    message.data.fill(42);
+  } else {
+    message = {
+      cmd: 'NODE_CLUSTER',
+      act: 'newconn',
+      key: '0.0.0.0:8000:4:' + Array(len).join('.'),
+      seq: 0
+    };
+  }
+
+  var child = fork(__filename, ['child'], {
+    serialization: conf.serialization
+  });
+
+  var running = true;
+  child.on('message', function(count) {
+    bench.end(count);
+    child.disconnect();
+  });
+
+  bench.start();
+  pump();
+
+  setTimeout(function() {
+    running = false;
+    child.send('end');
+  }, dur * 1000);
+
+  // Keep the channel busy but back off when the write queue fills up.
+  function pump() {
+    if (!running) return;
+    for (var i = 0; i < 1000; i++) {
+      if (child._channel.writeQueueSize >= 65536) break;
+      child.send(message);
+      message.seq++;
+    }
+    setImmediate(pump);
+  }
+}
+
+function child() {
+  var count = 0;
+  process.on('message', function(m) {
+    if (m === 'end')
+      process.send(count);
+    else
+      count++;
+  });
+}
@@ -0,0 +1,108 @@
+// Tail latency of zlib, dns.lookup() and fs requests while other file system
+// requests are stuck in the thread pool, the way they are on a hung NFS
+// mount. The stuck requests are opens of a fifo that has no writer yet.
+// Reports the 99th percentile latency in milliseconds.
+
+var common = require('../common.js');
+var child_process = require('child_process');
+var dns = require('dns');
+var fs = require('fs');
+var path = require('path');
+var zlib = require('zlib');
+
+var constants = process.binding('constants');
+var O_WRONLY = constants.O_WRONLY;
+var O_NONBLOCK = constants.O_NONBLOCK;
+
+var fifo = path.resolve(__dirname, '.removeme-benchmark-fifo');
+
+var bench = common.createBenchmark(main, {
+  op: ['zlib', 'dns', 'fs'],
+  stuck: [0, 8],
+  n: [500]
+});
+
+// Don't hang forever if the pool can't make progress.
+var kRelease = 2000;
+
+var input = new Buffer(16 * 1024);
+for (var i = 0; i < input.length; i++)
+  input[i] = i % 17;
+
+var ops = {
+  zlib: function(cb) {
+    zlib.deflate(input, cb);
+  },
+  dns: function(cb) {
+    dns.lookup('localhost', cb);
+  },
+  fs: function(cb) {
+    fs.stat(__filename, cb);
+  }
+};
+
+function main(conf) {
+  var op = ops[conf.op];
+  var n = +conf.n;
+  var stuck = +conf.stuck;
+  var latencies = [];
+
+  if (process.platform === 'win32')
+    throw new Error('this benchmark needs mkfifo');
+
+  try { fs.unlinkSync(fifo); } catch (e) {}
+  child_process.spawnSync('mkfifo', [fifo]);
+
+  var opened = 0;
+  var writer = null;
+
+  for (var i = 0; i < stuck; i++)
+    fs.open(fifo, 'r', function(er, fd) {
+      if (er)
+        throw er;
+      fs.closeSync(fd);
+      if (++opened === stuck)
+        finish();
+    });
+
+  var timer = setTimeout(release, kRelease);
+  next();
+
+  function next() {
+    if (latencies.length === n)
+      return done();
+    var start = process.hrtime();
+    op(function(er) {
+      if (er)
+        throw er;
+      var t = process.hrtime(start);
+      latencies.push(t[0] * 1e3 + t[1] / 1e6);
+      next();
+    });
+  }
+
+  function done() {
+    clearTimeout(timer);
+    release();
+    finish();
+  }
+
+  // Holding the write end open lets every pending open of the read end
+  // finish. Non-blocking, or this would wait for a reader when there is
+  // none.
+  function release() {
+    if (writer === null && stuck > 0)
+      writer = fs.openSync(fifo, O_WRONLY | O_NONBLOCK);
+  }
+
+  // Don't exit while threads are blocked, the pool joins them at exit.
+  function finish() {
+    if (latencies.length < n || opened < stuck)
+      return;
+    if (writer !== null)
+      fs.closeSync(writer);
+    fs.unlinkSync(fifo);
+    latencies.sort(function(a, b) { return a - b; });
+    bench.report(latencies[Math.floor(latencies.length * 0.99)]);
+  }
+}
@@ -1,14 +1,17 @@
 var common = require('../common.js');
+var timers = require('timers');
 
 var bench = common.createBenchmark(main, {
   thousands: [500],
-  type: ['depth', 'breadth']
+  type: ['depth', 'breadth', 'reset']
 });
 
 function main(conf) {
   var n = +conf.thousands * 1e3;
   if (conf.type === 'breadth')
     breadth(n);
+  else if (conf.type === 'reset')
+    reset(n);
   else
     depth(n);
 }
@@ -38,3 +41,23 @@ function breadth(N) {
     setTimeout(cb);
   }
 }
+
+// Idle timeouts of many connections with different timeout values, reset
+// over and over again like net.Socket does on every read and write.
+// Compare with and without --timer-wheel.
+function reset(N) {
+  var items = [];
+  var i;
+  for (i = 0; i < 10000; i++) {
+    var item = { _onTimeout: function() {} };
+    timers.enroll(item, 60000 + (i % 13) * 7919);
+    timers._unrefActive(item);
+    items.push(item);
+  }
+  bench.start();
+  for (i = 0; i < N; i++)
+    timers._unrefActive(items[(i * 7) % items.length]);
+  bench.end(N / 1e3);
+  for (i = 0; i < items.length; i++)
+    timers.unenroll(items[i]);
+}
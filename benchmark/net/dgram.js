@@ -1,4 +1,9 @@
-// test UDP send/recv throughput
+// test UDP send/recv throughput in packets per second
+//
+// `batch` is 'syscall' to read datagrams with recvmmsg() where available and
+// 'delivery' to also hand them to JS in 'batch' events. To see the system
+// calls per packet, run a single configuration under
+// `strace -c -e trace=recvmsg,recvmmsg,sendmsg,sendmmsg`.
 
 var common = require('../common.js');
 var PORT = common.PORT;
@@ -10,6 +15,7 @@ var bench = common.createBenchmark(main, {
   len: [1, 64, 256, 1024],
   num: [100],
   type: ['send', 'recv'],
+  batch: ['none', 'syscall', 'delivery'],
   dur: [5]
 });
 
@@ -17,6 +23,7 @@ var dur;
 var len;
 var num;
 var type;
+var batch;
 var chunk;
 var encoding;
 
@@ -25,6 +32,7 @@ function main(conf) {
   len = +conf.len;
   num = +conf.num;
   type = conf.type;
+  batch = conf.batch;
   chunk = new Buffer(len);
   server();
 }
@@ -47,9 +55,7 @@ function server() {
     onsend();
 
     setTimeout(function() {
-      var bytes = (type === 'send' ? sent : received) * chunk.length;
-      var gbits = (bytes * 8) / (1024 * 1024 * 1024);
-      bench.end(gbits);
+      bench.end(type === 'send' ? sent : received);
     }, dur * 1000);
   });
 
@@ -57,5 +63,11 @@ function server() {
     received++;
   });
 
+  socket.on('batch', function(buf, entries, addresses) {
+    received += entries.length / 5;
+  });
+
+  socket.setBatchReceive(batch !== 'none');
+  socket.setBatchDelivery(batch === 'delivery');
   socket.bind(PORT);
 }
@@ -0,0 +1,61 @@
+// measure read throughput and memory use with many concurrent connections
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  conns: [100, 1000, 10000],
+  len: [64, 1024],
+  measure: ['reads', 'rss'],
+  dur: [5],
+});
+
+var net = require('net');
+
+function main(conf) {
+  var conns = +conf.conns;
+  var chunk = new Buffer(+conf.len);
+  chunk.fill('x');
+
+  var reads = 0;
+  var running = true;
+  var kept = [];
+
+  var server = net.createServer(function(socket) {
+    socket.on('data', function(data) {
+      reads++;
+      // hold on to a few buffers per connection, like a parser that is
+      // waiting for the rest of a message would.
+      if (kept.length < conns * 4)
+        kept.push(data);
+      else
+        kept[reads % kept.length] = data;
+    });
+  });
+
+  server.listen(PORT, function() {
+    var connected = 0;
+    for (var i = 0; i < conns; i++) {
+      net.connect(PORT, function() {
+        var socket = this;
+        (function write() {
+          if (running)
+            socket.write(chunk, write);
+        })();
+        if (++connected === conns)
+          start();
+      });
+    }
+  });
+
+  function start() {
+    bench.start();
+    setTimeout(function() {
+      running = false;
+      if (conf.measure === 'rss')
+        bench.report(process.memoryUsage().rss / (1024 * 1024));
+      else
+        bench.end(reads);
+    }, conf.dur * 1000);
+  }
+}
@@ -0,0 +1,114 @@
+// Round trip latency of established connections while a child process opens
+// new ones as fast as it can. Reports the 99th percentile in milliseconds
+// (lower is better). With async the server's handshakes run on the thread
+// pool.
+var common = require('../common.js');
+var fork = require('child_process').fork;
+var fs = require('fs');
+var path = require('path');
+var tls = require('tls');
+
+var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+
+if (process.argv[2] === 'storm')
+  return storm(+process.argv[3]);
+
+var bench = common.createBenchmark(main, {
+  handshake: ['sync', 'async'],
+  storm: [0, 16, 64],
+  clients: [10],
+  dur: [5]
+});
+
+function main(conf) {
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
+                  asyncHandshake: conf.handshake === 'async' };
+
+  var server = tls.createServer(options, function(conn) {
+    conn.pipe(conn);
+  });
+
+  server.listen(common.PORT, function() {
+    var samples = [];
+    var running = true;
+    var ready = 0;
+    var conns = [];
+    var child = null;
+
+    for (var i = 0; i < +conf.clients; i++)
+      conns.push(ping(samples, onReady, function() { return running; }));
+
+    function onReady() {
+      if (++ready !== conns.length)
+        return;
+      if (+conf.storm > 0) {
+        child = fork(__filename, ['storm', conf.storm]);
+      }
+      samples.length = 0;
+      bench.start();
+      setTimeout(finish, +conf.dur * 1000);
+    }
+
+    function finish() {
+      running = false;
+      if (child)
+        child.kill();
+      conns.forEach(function(conn) {
+        conn.destroy();
+      });
+      server.close();
+
+      samples.sort(function(a, b) { return a - b; });
+      var p99 = samples[Math.floor(samples.length * 0.99)] || 0;
+      bench.report(p99);
+    }
+  });
+}
+
+// Sends one byte and waits for the echo, over and over.
+function ping(samples, onReady, isRunning) {
+  var sent;
+  var conn = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  }, function() {
+    onReady();
+    send();
+  });
+  conn.on('data', function() {
+    samples.push(now() - sent);
+    if (isRunning())
+      send();
+  });
+  conn.on('error', function() {});
+
+  function send() {
+    sent = now();
+    conn.write('x');
+  }
+  return conn;
+}
+
+function storm(concurrency) {
+  for (var i = 0; i < concurrency; i++)
+    connect();
+
+  function connect() {
+    var conn = tls.connect({
+      port: common.PORT,
+      rejectUnauthorized: false
+    }, function() {
+      conn.destroy();
+      connect();
+    });
+    conn.on('error', function() {
+      setTimeout(connect, 10);
+    });
+  }
+}
+
+function now() {
+  var t = process.hrtime();
+  return t[0] * 1e3 + t[1] / 1e6;
+}
@@ -1,12 +1,14 @@
+// Cleartext throughput of one TLS connection in Mbits/s. Small messages
+// exercise the per-record path, large ones the buffering in NodeBIO.
 var common = require('../common.js');
 var bench = common.createBenchmark(main, {
   dur: [5],
   type: ['buf', 'asc', 'utf'],
-  size: [2, 1024, 1024 * 1024]
+  size: [2, 1024, 16 * 1024, 1024 * 1024]
 });
 
 var dur, type, encoding, size;
-var server;
+var server, conn;
 
 var path = require('path');
 var fs = require('fs');
@@ -46,14 +48,13 @@ function main(conf) {
   setTimeout(done, dur * 1000);
   server.listen(common.PORT, function() {
     var opt = { port: common.PORT, rejectUnauthorized: false };
-    var conn = tls.connect(opt, function() {
+    conn = tls.connect(opt, function() {
       bench.start();
       conn.on('drain', write);
       write();
     });
 
     function write() {
-      var i = 0;
       while (false !== conn.write(chunk, encoding));
     }
   });
@@ -1,11 +1,19 @@
 var assert = require('assert'),
+    constants = require('constants'),
     fs = require('fs'),
     path = require('path'),
     tls = require('tls');
 
+// resume:
+//   none    full handshake on every connection
+//   ticket  clients resume with session tickets
+//   event   session id resumption through newSession/resumeSession in JS
+//   cache   session id resumption from the native in-process cache
+//   shared  session id resumption from the native shared memory cache
 var common = require('../common.js');
 var bench = common.createBenchmark(main, {
   concurrency: [1, 10],
+  resume: ['none', 'ticket', 'event', 'cache', 'shared'],
   dur: [5]
 });
 
@@ -15,10 +23,13 @@ var server;
 var dur;
 var concurrency;
 var running = true;
+var resume;
+var session = null;
 
 function main(conf) {
   dur = +conf.dur;
   concurrency = +conf.concurrency;
+  resume = conf.resume;
 
   var cert_dir = path.resolve(__dirname, '../../test/fixtures'),
       options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
@@ -26,7 +37,26 @@ function main(conf) {
                   ca: [ fs.readFileSync(cert_dir + '/test_ca.pem') ],
                   ciphers: 'AES256-GCM-SHA384' };
 
+  if (resume !== 'none' && resume !== 'ticket')
+    options.secureOptions = constants.SSL_OP_NO_TICKET;
+  if (resume === 'cache')
+    options.sessionCacheSize = 1024;
+  if (resume === 'shared')
+    options.sharedSessionCache = 'node-benchmark';
+
   server = tls.createServer(options, onConnection);
+
+  if (resume === 'event') {
+    var sessions = {};
+    server.on('newSession', function(id, data, cb) {
+      sessions[id.toString('hex')] = data;
+      cb();
+    });
+    server.on('resumeSession', function(id, cb) {
+      cb(null, sessions[id.toString('hex')] || null);
+    });
+  }
+
   server.listen(common.PORT, onListening);
 }
 
@@ -43,8 +73,11 @@ function onConnection(conn) {
 
 function makeConnection() {
   var conn = tls.connect({ port: common.PORT,
+                           session: session,
                            rejectUnauthorized: false }, function() {
     clientConn++;
+    if (resume !== 'none')
+      session = conn.getSession();
     conn.on('error', function(er) {
       console.error('client error', er);
       throw er;
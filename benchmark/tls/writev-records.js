@@ -0,0 +1,120 @@
+// Send responses made of many small writes over TLS and report how the
+// encrypted stream looks on the wire: TLS records per response, or reads per
+// response as seen by a plain TCP proxy sitting between client and server
+// (with Nagle disabled that approximates the server's write syscalls).
+
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  metric: ['records', 'reads'],
+  chunks: [1, 16, 64],
+  size: [64, 1024],
+  cork: ['true', 'false'],
+  n: [1000]
+});
+
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+var tls = require('tls');
+var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+
+function main(conf) {
+  var chunks = +conf.chunks;
+  var size = +conf.size;
+  var cork = conf.cork === 'true';
+  var n = +conf.n;
+  var expected = chunks * size;
+
+  var chunk = new Buffer(size);
+  chunk.fill('r');
+
+  var options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+                  cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
+                  ciphers: 'AES256-GCM-SHA384' };
+
+  var server = tls.createServer(options, function(conn) {
+    conn.setNoDelay(true);
+    conn.on('data', function() {
+      if (cork)
+        conn.cork();
+      for (var i = 0; i < chunks; i++)
+        conn.write(chunk);
+      if (cork)
+        conn.uncork();
+    });
+  });
+
+  var records = 0;
+  var reads = 0;
+  var counting = false;
+
+  // Parses the 5 byte TLS record headers of the server to client direction.
+  var header = new Buffer(5);
+  var headerLen = 0;
+  var bodyLeft = 0;
+  function parse(data) {
+    var off = 0;
+    while (off < data.length) {
+      if (bodyLeft > 0) {
+        var skip = Math.min(bodyLeft, data.length - off);
+        bodyLeft -= skip;
+        off += skip;
+        continue;
+      }
+      header[headerLen++] = data[off++];
+      if (headerLen === header.length) {
+        headerLen = 0;
+        bodyLeft = header.readUInt16BE(3);
+        if (counting)
+          records++;
+      }
+    }
+  }
+
+  var proxy = net.createServer(function(client) {
+    var upstream = net.connect(common.PORT, function() {
+      client.pipe(upstream);
+    });
+    upstream.setNoDelay(true);
+    client.setNoDelay(true);
+    upstream.on('data', function(data) {
+      parse(data);
+      if (counting)
+        reads++;
+      client.write(data);
+    });
+  });
+
+  server.listen(common.PORT, function() {
+    proxy.listen(common.PORT + 1, function() {
+      var conn = tls.connect({
+        port: common.PORT + 1,
+        rejectUnauthorized: false
+      }, function() {
+        counting = true;
+        bench.start();
+        request();
+      });
+
+      var responses = 0;
+      var received = 0;
+      function request() {
+        received = 0;
+        conn.write('x');
+      }
+
+      conn.on('data', function(data) {
+        received += data.length;
+        if (received < expected)
+          return;
+        if (++responses < n)
+          return request();
+
+        conn.destroy();
+        proxy.close();
+        server.close();
+        bench.report((conf.metric === 'records' ? records : reads) / n);
+      });
+    });
+  });
+}
@@ -121,6 +121,7 @@ test/test-poll-close.c
 test/test-poll.c
 test/test-process-title.c
 test/test-ref.c
+test/test-reuseport.c
 test/test-run-nowait.c
 test/test-run-once.c
 test/test-semaphore.c
@@ -152,9 +153,11 @@ test/test-threadpool-cancel.c
 test/test-threadpool.c
 test/test-timer-again.c
 test/test-timer.c
+test/test-timer-wheel.c
 test/test-tty.c
 test/test-udp-dgram-too-big.c
 test/test-udp-ipv6.c
+test/test-udp-mmsg.c
 test/test-udp-multicast-join.c
 test/test-udp-multicast-ttl.c
 test/test-udp-open.c
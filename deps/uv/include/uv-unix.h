@@ -93,6 +93,8 @@ struct uv__work {
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
   void* wq[2];
+  unsigned int kind;
+  uint64_t submitted;
 };
 
 #ifndef UV_PLATFORM_SEM_T
@@ -182,6 +184,7 @@ typedef struct {
     unsigned int nelts;                                                       \
   } timer_heap;                                                               \
   uint64_t timer_counter;                                                     \
+  void* timer_wheel;                                                          \
   uint64_t time;                                                              \
   int signal_pipefd[2];                                                       \
   uv__io_t signal_io_watcher;                                                 \
@@ -811,7 +811,14 @@ UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used */
-  UV_TCP_IPV6ONLY = 1
+  UV_TCP_IPV6ONLY = 1,
+  /*
+   * Used with uv_tcp_bind. Lets any number of sockets that all set it bind
+   * to the same address and port, the kernel balances incoming connections
+   * over them. Needs SO_REUSEPORT with load balancing semantics, i.e. Linux
+   * 3.9 or newer; UV_ENOTSUP elsewhere.
+   */
+  UV_TCP_REUSEPORT = 2
 };
 
 /*
@@ -865,7 +872,19 @@ enum uv_udp_flags {
    * Indicates message was truncated because read buffer was too small. The
    * remainder was discarded by the OS. Used in uv_udp_recv_cb.
    */
-  UV_UDP_PARTIAL = 2
+  UV_UDP_PARTIAL = 2,
+  /*
+   * Indicates message was received together with others by a single
+   * recvmmsg() call, see uv_udp_set_recvmmsg(). `buf` points into the
+   * buffer from alloc_cb and must not be freed; that buffer is handed back
+   * in a final uv_udp_recv_cb with nread == 0 and addr == NULL.
+   */
+  UV_UDP_MMSG_CHUNK = 4,
+  /*
+   * Used with uv_udp_bind. Like UV_TCP_REUSEPORT, the kernel balances
+   * incoming datagrams over all sockets bound to the address and port.
+   */
+  UV_UDP_REUSEPORT = 8
 };
 
 /*
@@ -940,7 +959,7 @@ UV_EXTERN int uv_udp_open(uv_udp_t* handle, uv_os_sock_t sock);
  *  handle    UDP handle. Should have been initialized with `uv_udp_init`.
  *  addr      struct sockaddr_in or struct sockaddr_in6 with the address and
  *            port to bind to.
- *  flags     Unused.
+ *  flags     UV_UDP_IPV6ONLY and/or UV_UDP_REUSEPORT.
  *
  * Returns:
  *  0 on success, or an error code < 0 on failure.
@@ -1088,6 +1107,25 @@ UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
 
+/*
+ * Receive a batch of datagrams per system call instead of one.
+ *
+ * Arguments:
+ *  handle    UDP handle. Should have been initialized with `uv_udp_init`.
+ *  on        1 for on, 0 for off
+ *
+ * Returns:
+ *  0 on success, or an error code < 0 on failure. UV_ENOSYS if the platform
+ *  has no recvmmsg() (only Linux has it at the moment.)
+ *
+ * When on, alloc_cb is asked for room for several datagrams at once. The
+ * buffer it returns is cut into 64 KB slots, one per datagram, and each
+ * datagram is passed to uv_udp_recv_cb with the UV_UDP_MMSG_CHUNK flag set.
+ * Return a buffer smaller than 128 KB from alloc_cb to read a single datagram
+ * the normal way. Sends are always batched with sendmmsg() where available.
+ */
+UV_EXTERN int uv_udp_set_recvmmsg(uv_udp_t* handle, int on);
+
 /*
  * Stop listening for incoming datagrams.
  *
@@ -1413,6 +1451,17 @@ UV_EXTERN void uv_timer_set_repeat(uv_timer_t* handle, uint64_t repeat);
 
 UV_EXTERN uint64_t uv_timer_get_repeat(const uv_timer_t* handle);
 
+/*
+ * Switch the loop's timers between the default binary heap and a
+ * hierarchical timing wheel. The wheel starts and stops timers in O(1)
+ * instead of O(log n), which pays off with many timers that are frequently
+ * reset, like idle timeouts. Expiry order is the same in both modes.
+ *
+ * Returns UV_EBUSY when the loop has active timers. The timing wheel is not
+ * implemented on Windows, it returns UV_ENOSYS there.
+ */
+UV_EXTERN int uv_loop_set_timer_wheel(uv_loop_t* loop, int on);
+
 
 /*
  * uv_getaddrinfo_t is a subclass of uv_req_t
@@ -1660,6 +1709,62 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
 
+/* Thread pool work classes, see uv_threadpool_stats(). File system requests
+ * are I/O, uv_getaddrinfo() is DNS and uv_queue_work() is CPU. SLOW_CPU is
+ * for work that holds a thread for a long time, like key derivation, and has
+ * a lower default limit so it can't crowd out everything else.
+ */
+typedef enum {
+  UV_THREADPOOL_CPU,
+  UV_THREADPOOL_IO,
+  UV_THREADPOOL_DNS,
+  UV_THREADPOOL_SLOW_CPU,
+  UV_THREADPOOL_CLASSES
+} uv_threadpool_class_t;
+
+/* Like uv_queue_work() but queues the request as `cls`, which is either
+ * UV_THREADPOOL_CPU or UV_THREADPOOL_SLOW_CPU. Returns UV_EINVAL for other
+ * classes.
+ *
+ * On Windows the class is ignored.
+ */
+UV_EXTERN int uv_queue_work_class(uv_loop_t* loop,
+                                  uv_work_t* req,
+                                  uv_threadpool_class_t cls,
+                                  uv_work_cb work_cb,
+                                  uv_after_work_cb after_work_cb);
+
+#define UV_THREADPOOL_WAIT_BUCKETS 24
+
+typedef struct {
+  unsigned int queued;
+  unsigned int running;
+  unsigned int limit;
+  uint64_t completed;
+  /* Histogram of the time requests spent queued before a worker picked
+   * them up. wait[0] counts waits under 1 us, wait[i] waits of
+   * [2^(i-1), 2^i) us. The last bucket takes everything longer.
+   */
+  uint64_t wait[UV_THREADPOOL_WAIT_BUCKETS];
+} uv_threadpool_class_stats_t;
+
+typedef struct {
+  unsigned int threads;
+  unsigned int idle;
+  unsigned int min_threads;
+  unsigned int max_threads;
+  uv_threadpool_class_stats_t classes[UV_THREADPOOL_CLASSES];
+} uv_threadpool_stats_t;
+
+/* Takes a snapshot of the thread pool's counters. Everything is zero until
+ * the first request is queued.
+ *
+ * This function is currently only implemented on UNIX platforms. On Windows,
+ * it always returns UV_ENOSYS.
+ */
+UV_EXTERN int uv_threadpool_stats(uv_threadpool_stats_t* stats);
+
+
 struct uv_cpu_info_s {
   char* model;
   int speed;
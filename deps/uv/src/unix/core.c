@@ -530,6 +530,35 @@ int uv__cloexec(int fd, int set) {
 #endif /* defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__) */
 
 
+/* Older C libraries don't know about SO_REUSEPORT yet, the kernel has had
+ * it since Linux 3.9.
+ */
+#if defined(__linux__) && !defined(SO_REUSEPORT)
+# define SO_REUSEPORT 15
+#endif
+
+/* Only Linux balances connections and datagrams over the sockets sharing a
+ * port. On the BSDs the option exists but the last socket to bind wins, that
+ * is not what callers of this function want.
+ */
+int uv__reuseport(int fd) {
+#if defined(__linux__)
+  int on;
+
+  on = 1;
+  if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on))) {
+    if (errno == ENOPROTOOPT)
+      return -ENOTSUP;  /* Kernel older than 3.9. */
+    return -errno;
+  }
+
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
 /* This function is not execve-safe, there is a race window
  * between the call to dup() and fcntl(FD_CLOEXEC).
  */
@@ -122,6 +122,7 @@ int uv_getaddrinfo(uv_loop_t* loop,
 
   uv__work_submit(loop,
                   &req->work_req,
+                  UV__WORK_DNS,
                   uv__getaddrinfo_work,
                   uv__getaddrinfo_done);
 
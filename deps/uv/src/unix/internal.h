@@ -134,7 +134,8 @@ enum {
   UV_STREAM_READ_EOF      = 0x200,  /* read(2) read EOF. */
   UV_TCP_NODELAY          = 0x400,  /* Disable Nagle. */
   UV_TCP_KEEPALIVE        = 0x800,  /* Turn on keep-alive. */
-  UV_TCP_SINGLE_ACCEPT    = 0x1000  /* Only accept() when idle. */
+  UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
+  UV_UDP_RECVMMSG         = 0x10000 /* Read datagrams with recvmmsg(). */
 };
 
 typedef enum {
@@ -148,6 +149,7 @@ int uv__close(int fd);
 int uv__cloexec(int fd, int set);
 int uv__socket(int domain, int type, int protocol);
 int uv__dup(int fd);
+int uv__reuseport(int fd);
 ssize_t uv__recvmsg(int fd, struct msghdr *msg, int flags);
 void uv__make_close_pending(uv_handle_t* handle);
 
@@ -192,6 +194,7 @@ int uv_pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
 /* timer */
 void uv__run_timers(uv_loop_t* loop);
 int uv__next_timeout(const uv_loop_t* loop);
+void uv__timer_wheel_delete(uv_loop_t* loop);
 
 /* signal */
 void uv__signal_close(uv_signal_t* handle);
@@ -199,8 +202,17 @@ void uv__signal_global_once_init(void);
 void uv__signal_loop_cleanup(uv_loop_t* loop);
 
 /* thread pool */
+enum uv__work_kind {
+  UV__WORK_CPU = UV_THREADPOOL_CPU,
+  UV__WORK_SLOW_IO = UV_THREADPOOL_IO,
+  UV__WORK_DNS = UV_THREADPOOL_DNS,
+  UV__WORK_SLOW_CPU = UV_THREADPOOL_SLOW_CPU,
+  UV__WORK_NKINDS = UV_THREADPOOL_CLASSES
+};
+
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work *w,
+                     enum uv__work_kind kind,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 void uv__work_done(uv_async_t* handle, int status);
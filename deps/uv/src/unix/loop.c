@@ -192,4 +192,6 @@ static void uv__loop_close(uv_loop_t* loop) {
   free(loop->watchers);
   loop->watchers = NULL;
   loop->nwatchers = 0;
+
+  uv__timer_wheel_delete(loop);
 }
@@ -63,6 +63,10 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   int err;
   int on;
 
+  /* Check for bad flags. */
+  if (flags & ~(UV_TCP_IPV6ONLY | UV_TCP_REUSEPORT))
+    return -EINVAL;
+
   err = maybe_new_socket(tcp,
                          addr->sa_family,
                          UV_STREAM_READABLE | UV_STREAM_WRITABLE);
@@ -73,6 +77,12 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if (setsockopt(tcp->io_watcher.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
     return -errno;
 
+  if (flags & UV_TCP_REUSEPORT) {
+    err = uv__reuseport(tcp->io_watcher.fd);
+    if (err)
+      return err;
+  }
+
 #ifdef IPV6_V6ONLY
   if (addr->sa_family == AF_INET6) {
     on = (flags & UV_TCP_IPV6ONLY) != 0;
@@ -21,17 +21,48 @@
 
 #include "internal.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
+#define DEFAULT_THREADPOOL_SIZE 4
+
+/* Workers above the minimum exit after being idle this long, in ns. */
+#define IDLE_TIMEOUT ((uint64_t) 5e9)
+
+/* Work is queued per class. A class never occupies more than its limit of
+ * worker threads, so a pile of stuck file system requests (think a hung NFS
+ * mount) can't hold up DNS lookups or CPU bound work like compression.
+ * Workers pick the next class round-robin so no class starves another.
+ *
+ * The pool starts with UV_THREADPOOL_SIZE threads. It grows, up to
+ * UV_THREADPOOL_MAX, when there is runnable work and no idle worker and
+ * shrinks back to UV_THREADPOOL_MIN as workers go idle. Both default to
+ * UV_THREADPOOL_SIZE, i.e. a fixed size pool.
+ */
+static const char* const limit_env[UV__WORK_NKINDS] = {
+  "UV_THREADPOOL_CPU_MAX",
+  "UV_THREADPOOL_IO_MAX",
+  "UV_THREADPOOL_DNS_MAX",
+  "UV_THREADPOOL_SLOW_CPU_MAX"
+};
 
 static uv_once_t once = UV_ONCE_INIT;
 static uv_cond_t cond;
 static uv_mutex_t mutex;
 static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static unsigned int nidle;
+static unsigned int min_threads;
+static unsigned int max_threads;
+static uv_thread_t threads[MAX_THREADPOOL_SIZE];
+static char live[MAX_THREADPOOL_SIZE];
+static QUEUE wq[UV__WORK_NKINDS];
+static unsigned int queued[UV__WORK_NKINDS];
+static unsigned int running[UV__WORK_NKINDS];
+static unsigned int limits[UV__WORK_NKINDS];
+static uint64_t completed[UV__WORK_NKINDS];
+static uint64_t waits[UV__WORK_NKINDS][UV_THREADPOOL_WAIT_BUCKETS];
+static unsigned int next_kind;
+static int exiting;
 static volatile int initialized;
 
 
@@ -40,37 +71,127 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
+/* Returns the oldest request of the next class that is below its limit or
+ * NULL if there is none. Must be called with the global mutex held.
+ */
+static QUEUE* next_work(unsigned int* kind) {
+  unsigned int i;
+  unsigned int k;
+
+  for (i = 0; i < UV__WORK_NKINDS; i++) {
+    k = (next_kind + i) % UV__WORK_NKINDS;
+    if (QUEUE_EMPTY(&wq[k]) || running[k] >= limits[k])
+      continue;
+    next_kind = (k + 1) % UV__WORK_NKINDS;
+    *kind = k;
+    return QUEUE_HEAD(&wq[k]);
+  }
+
+  return NULL;
+}
+
+
+/* Bucket 0 counts waits under 1 us, bucket i > 0 waits of [2^(i-1), 2^i) us.
+ * The last bucket takes everything longer.
+ */
+static unsigned int wait_bucket(uint64_t ns) {
+  uint64_t us;
+  unsigned int i;
+
+  us = ns / 1000;
+  for (i = 0; us > 0 && i < UV_THREADPOOL_WAIT_BUCKETS - 1; i++)
+    us >>= 1;
+
+  return i;
+}
+
+
+static void worker(void* arg);
+
+
+/* Starts another worker if there is more runnable work than idle workers
+ * to take it. Must be called with the global mutex held.
+ */
+static void maybe_grow(void) {
+  unsigned int runnable;
+  unsigned int avail;
+  unsigned int slot;
+  unsigned int i;
+
+  if (exiting || nthreads >= max_threads)
+    return;
+
+  runnable = 0;
+  for (i = 0; i < UV__WORK_NKINDS; i++) {
+    avail = running[i] < limits[i] ? limits[i] - running[i] : 0;
+    runnable += queued[i] < avail ? queued[i] : avail;
+  }
+
+  if (runnable <= nidle)
+    return;
+
+  /* nthreads < max_threads so there is a free slot. */
+  for (slot = 0; live[slot]; slot++)
+    ;
+
+  /* Not fatal, the running workers will get to it eventually. */
+  if (uv_thread_create(threads + slot, worker, (void*) (uintptr_t) slot))
+    return;
+
+  live[slot] = 1;
+  nthreads++;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
   struct uv__work* w;
+  unsigned int slot;
+  unsigned int kind;
+  int timed_out;
   QUEUE* q;
 
-  (void) arg;
+  slot = (unsigned int) (uintptr_t) arg;
 
   for (;;) {
     uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq))
-      uv_cond_wait(&cond, &mutex);
-
-    q = QUEUE_HEAD(&wq);
-
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
+    for (timed_out = 0; !exiting; ) {
+      q = next_work(&kind);
+      if (q != NULL)
+        break;
+
+      if (timed_out && nthreads > min_threads) {
+        /* Nobody joins a retired worker. */
+        live[slot] = 0;
+        nthreads--;
+        pthread_detach(pthread_self());
+        uv_mutex_unlock(&mutex);
+        return;
+      }
+
+      nidle++;
+      timed_out = uv_cond_timedwait(&cond, &mutex, IDLE_TIMEOUT) != 0;
+      nidle--;
     }
 
-    uv_mutex_unlock(&mutex);
-
-    if (q == &exit_message)
+    if (exiting) {
+      uv_mutex_unlock(&mutex);
       break;
+    }
+
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is executing. */
+    queued[kind]--;
+    running[kind]++;
 
     w = QUEUE_DATA(q, struct uv__work, wq);
+    waits[kind][wait_bucket(uv__hrtime(UV_CLOCK_FAST) - w->submitted)]++;
+
+    uv_mutex_unlock(&mutex);
+
     w->work(w);
 
     uv_mutex_lock(&w->loop->wq_mutex);
@@ -79,39 +200,61 @@ static void worker(void* arg) {
     QUEUE_INSERT_TAIL(&w->loop->wq, &w->wq);
     uv_async_send(&w->loop->wq_async);
     uv_mutex_unlock(&w->loop->wq_mutex);
+
+    uv_mutex_lock(&mutex);
+    running[kind]--;
+    completed[kind]++;
+    /* Requests of this class that were held back by the limit can run now. */
+    if (queued[kind] > 0)
+      uv_cond_signal(&cond);
+    uv_mutex_unlock(&mutex);
   }
 }
 
 
-static void post(QUEUE* q) {
+static void post(QUEUE* q, enum uv__work_kind kind) {
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  uv_cond_signal(&cond);
+  QUEUE_INSERT_TAIL(&wq[kind], q);
+  queued[kind]++;
+  if (running[kind] < limits[kind]) {
+    uv_cond_signal(&cond);
+    maybe_grow();
+  }
   uv_mutex_unlock(&mutex);
 }
 
 
+static unsigned int uint_from_env(const char* name, unsigned int def) {
+  const char* val;
+  unsigned int n;
+
+  val = getenv(name);
+  if (val == NULL)
+    return def;
+
+  n = atoi(val);
+  if (n == 0)
+    n = 1;
+  if (n > MAX_THREADPOOL_SIZE)
+    n = MAX_THREADPOOL_SIZE;
+
+  return n;
+}
+
+
 static void init_once(void) {
+  unsigned int size;
   unsigned int i;
-  const char* val;
 
-  nthreads = ARRAY_SIZE(default_threads);
-  val = getenv("UV_THREADPOOL_SIZE");
-  if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
+  size = uint_from_env("UV_THREADPOOL_SIZE", DEFAULT_THREADPOOL_SIZE);
+  min_threads = uint_from_env("UV_THREADPOOL_MIN", size);
+  max_threads = uint_from_env("UV_THREADPOOL_MAX", size);
+  if (max_threads < min_threads)
+    max_threads = min_threads;
+  if (size < min_threads)
+    size = min_threads;
+  if (size > max_threads)
+    size = max_threads;
 
   if (uv_cond_init(&cond))
     abort();
@@ -119,11 +262,26 @@ static void init_once(void) {
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  /* By default file system, DNS and slow CPU requests may each take up half
+   * of the threads, CPU bound work all of them.
+   */
+  for (i = 0; i < UV__WORK_NKINDS; i++) {
+    QUEUE_INIT(&wq[i]);
+    limits[i] = uint_from_env(limit_env[i],
+                              i == UV__WORK_CPU ? max_threads
+                                                : (max_threads + 1) / 2);
+    if (limits[i] > max_threads)
+      limits[i] = max_threads;
+  }
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+  for (nthreads = 0; nthreads < size; nthreads++) {
+    if (uv_thread_create(threads + nthreads,
+                         worker,
+                         (void*) (uintptr_t) nthreads)) {
       abort();
+    }
+    live[nthreads] = 1;
+  }
 
   initialized = 1;
 }
@@ -135,33 +293,38 @@ UV_DESTRUCTOR(static void cleanup(void)) {
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  uv_mutex_lock(&mutex);
+  exiting = 1;
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+  /* No worker starts or retires once `exiting` is set. */
+  for (i = 0; i < ARRAY_SIZE(threads); i++)
+    if (live[i] && uv_thread_join(threads + i))
       abort();
 
-  if (threads != default_threads)
-    free(threads);
-
   uv_mutex_destroy(&mutex);
   uv_cond_destroy(&cond);
 
-  threads = NULL;
+  memset(live, 0, sizeof(live));
   nthreads = 0;
+  exiting = 0;
   initialized = 0;
 }
 
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     enum uv__work_kind kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  w->kind = kind;
+  w->submitted = uv__hrtime(UV_CLOCK_FAST);
+  post(&w->wq, kind);
 }
 
 
@@ -172,8 +335,10 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    queued[w->kind]--;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -243,14 +408,34 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_class(loop,
+                             req,
+                             UV_THREADPOOL_CPU,
+                             work_cb,
+                             after_work_cb);
+}
+
+
+int uv_queue_work_class(uv_loop_t* loop,
+                        uv_work_t* req,
+                        uv_threadpool_class_t cls,
+                        uv_work_cb work_cb,
+                        uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return -EINVAL;
 
+  if (cls != UV_THREADPOOL_CPU && cls != UV_THREADPOOL_SLOW_CPU)
+    return -EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  &req->work_req,
+                  (enum uv__work_kind) cls,
+                  uv__queue_work,
+                  uv__queue_done);
   return 0;
 }
 
@@ -278,3 +463,35 @@ int uv_cancel(uv_req_t* req) {
 
   return uv__work_cancel(loop, req, wreq);
 }
+
+
+int uv_threadpool_stats(uv_threadpool_stats_t* stats) {
+  uv_threadpool_class_stats_t* cs;
+  unsigned int i;
+
+  memset(stats, 0, sizeof(*stats));
+
+  /* Don't start the pool just to report that it's empty. */
+  if (initialized == 0)
+    return 0;
+
+  uv_mutex_lock(&mutex);
+
+  stats->threads = nthreads;
+  stats->idle = nidle;
+  stats->min_threads = min_threads;
+  stats->max_threads = max_threads;
+
+  for (i = 0; i < UV__WORK_NKINDS; i++) {
+    cs = stats->classes + i;
+    cs->queued = queued[i];
+    cs->running = running[i];
+    cs->limit = limits[i];
+    cs->completed = completed[i];
+    memcpy(cs->wait, waits[i], sizeof(cs->wait));
+  }
+
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
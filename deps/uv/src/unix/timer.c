@@ -24,6 +24,42 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+
+/* Optional hierarchical timing wheel, see uv_loop_set_timer_wheel().
+ *
+ * The first level has a slot for every millisecond of the next 256 ms. The
+ * four levels above it have 64 slots each and cover the next 2^14, 2^20, 2^26
+ * and 2^32 ms. A timer is filed in the lowest level that covers its expiry
+ * time and cascades down when the wheel reaches its slot, so starting and
+ * stopping a timer is O(1). All timers in a first level slot expire at the
+ * same time and are kept in start_id order, which makes expiry order match
+ * that of the binary heap.
+ *
+ * The timer reuses its heap_node: the first two pointers link it into a
+ * slot, the third one holds the slot index.
+ */
+#define WHEEL_L0_BITS 8
+#define WHEEL_LN_BITS 6
+#define WHEEL_LEVELS 5
+#define WHEEL_L0_SIZE (1 << WHEEL_L0_BITS)
+#define WHEEL_LN_SIZE (1 << WHEEL_LN_BITS)
+#define WHEEL_SLOTS (WHEEL_L0_SIZE + (WHEEL_LEVELS - 1) * WHEEL_LN_SIZE)
+#define WHEEL_MAX_DELTA ((uint64_t) 0xFFFFFFFF)
+#define WHEEL_DUE ((uintptr_t) -1)
+
+#define WHEEL_SHIFT(level)                                                    \
+  ((level) == 0 ? 0 : WHEEL_L0_BITS + WHEEL_LN_BITS * ((level) - 1))
+
+#define TIMER_QUEUE(handle) ((QUEUE*) &(handle)->heap_node[0])
+#define TIMER_SLOT(handle) ((uintptr_t) (handle)->heap_node[2])
+
+struct uv__timer_wheel {
+  uint64_t time;  /* Next tick to process. */
+  unsigned int count[WHEEL_LEVELS];
+  QUEUE due;  /* Timers that were already expired when started. */
+  QUEUE slots[WHEEL_SLOTS];
+};
 
 
 static int timer_less_than(const struct heap_node* ha,
@@ -51,6 +87,158 @@ static int timer_less_than(const struct heap_node* ha,
 }
 
 
+static unsigned int timer_wheel_level(uintptr_t slot) {
+  if (slot < WHEEL_L0_SIZE)
+    return 0;
+  return 1 + (slot - WHEEL_L0_SIZE) / WHEEL_LN_SIZE;
+}
+
+
+static uintptr_t timer_wheel_slot(unsigned int level, uint64_t tick) {
+  if (level == 0)
+    return tick & (WHEEL_L0_SIZE - 1);
+
+  return WHEEL_L0_SIZE +
+         (level - 1) * WHEEL_LN_SIZE +
+         ((tick >> WHEEL_SHIFT(level)) & (WHEEL_LN_SIZE - 1));
+}
+
+
+static void timer_wheel_insert(struct uv__timer_wheel* wheel,
+                               uv_timer_t* handle) {
+  const uv_timer_t* other;
+  uint64_t timeout;
+  uint64_t delta;
+  unsigned int level;
+  uintptr_t slot;
+  QUEUE* q;
+
+  timeout = handle->timeout;
+  if (timeout < wheel->time) {
+    QUEUE_INSERT_TAIL(&wheel->due, TIMER_QUEUE(handle));
+    handle->heap_node[2] = (void*) WHEEL_DUE;
+    return;
+  }
+
+  /* Timers beyond the range of the wheel are filed at the far end and
+   * re-filed when they cascade.
+   */
+  delta = timeout - wheel->time;
+  if (delta > WHEEL_MAX_DELTA) {
+    delta = WHEEL_MAX_DELTA;
+    timeout = wheel->time + delta;
+  }
+
+  for (level = 0; level < WHEEL_LEVELS - 1; level++)
+    if (delta >> WHEEL_SHIFT(level + 1) == 0)
+      break;
+
+  slot = timer_wheel_slot(level, timeout);
+  q = &wheel->slots[slot];
+
+  if (level == 0) {
+    /* Cascaded timers can have a lower start_id than the timers that are
+     * already in the slot. Those are rare, new timers simply go at the end.
+     */
+    while (QUEUE_PREV(q) != &wheel->slots[slot]) {
+      other = QUEUE_DATA(QUEUE_PREV(q), const uv_timer_t, heap_node);
+      if (other->start_id < handle->start_id)
+        break;
+      q = QUEUE_PREV(q);
+    }
+  }
+
+  QUEUE_INSERT_TAIL(q, TIMER_QUEUE(handle));
+  handle->heap_node[2] = (void*) slot;
+  wheel->count[level]++;
+}
+
+
+static void timer_wheel_remove(struct uv__timer_wheel* wheel,
+                               uv_timer_t* handle) {
+  QUEUE_REMOVE(TIMER_QUEUE(handle));
+  if (TIMER_SLOT(handle) != WHEEL_DUE)
+    wheel->count[timer_wheel_level(TIMER_SLOT(handle))]--;
+}
+
+
+/* Re-file the timers in the current slot of `level`. Returns the index of
+ * that slot, the caller continues with the next level when it's zero.
+ */
+static unsigned int timer_wheel_cascade(struct uv__timer_wheel* wheel,
+                                        unsigned int level) {
+  uv_timer_t* handle;
+  uintptr_t slot;
+  QUEUE queue;
+  QUEUE* q;
+
+  slot = timer_wheel_slot(level, wheel->time);
+
+  if (!QUEUE_EMPTY(&wheel->slots[slot])) {
+    q = QUEUE_HEAD(&wheel->slots[slot]);
+    QUEUE_SPLIT(&wheel->slots[slot], q, &queue);
+
+    while (!QUEUE_EMPTY(&queue)) {
+      q = QUEUE_HEAD(&queue);
+      QUEUE_REMOVE(q);
+      handle = QUEUE_DATA(q, uv_timer_t, heap_node);
+      wheel->count[level]--;
+      timer_wheel_insert(wheel, handle);
+    }
+  }
+
+  return (wheel->time >> WHEEL_SHIFT(level)) & (WHEEL_LN_SIZE - 1);
+}
+
+
+int uv_loop_set_timer_wheel(uv_loop_t* loop, int on) {
+  struct uv__timer_wheel* wheel;
+  unsigned int i;
+
+  wheel = loop->timer_wheel;
+  if (!!on == (wheel != NULL))
+    return 0;
+
+  /* Active timers can't move between the heap and the wheel. */
+  if (wheel == NULL) {
+    if (heap_min((const struct heap*) &loop->timer_heap) != NULL)
+      return -EBUSY;
+  } else {
+    if (!QUEUE_EMPTY(&wheel->due))
+      return -EBUSY;
+    for (i = 0; i < WHEEL_LEVELS; i++)
+      if (wheel->count[i] != 0)
+        return -EBUSY;
+  }
+
+  if (!on) {
+    free(wheel);
+    loop->timer_wheel = NULL;
+    return 0;
+  }
+
+  wheel = malloc(sizeof(*wheel));
+  if (wheel == NULL)
+    return -ENOMEM;
+
+  wheel->time = loop->time;
+  for (i = 0; i < WHEEL_LEVELS; i++)
+    wheel->count[i] = 0;
+  QUEUE_INIT(&wheel->due);
+  for (i = 0; i < WHEEL_SLOTS; i++)
+    QUEUE_INIT(&wheel->slots[i]);
+
+  loop->timer_wheel = wheel;
+  return 0;
+}
+
+
+void uv__timer_wheel_delete(uv_loop_t* loop) {
+  free(loop->timer_wheel);
+  loop->timer_wheel = NULL;
+}
+
+
 int uv_timer_init(uv_loop_t* loop, uv_timer_t* handle) {
   uv__handle_init(loop, (uv_handle_t*)handle, UV_TIMER);
   handle->timer_cb = NULL;
@@ -78,9 +266,12 @@ int uv_timer_start(uv_timer_t* handle,
   /* start_id is the second index to be compared in uv__timer_cmp() */
   handle->start_id = handle->loop->timer_counter++;
 
-  heap_insert((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->loop->timer_wheel != NULL)
+    timer_wheel_insert(handle->loop->timer_wheel, handle);
+  else
+    heap_insert((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
   uv__handle_start(handle);
 
   return 0;
@@ -91,9 +282,12 @@ int uv_timer_stop(uv_timer_t* handle) {
   if (!uv__is_active(handle))
     return 0;
 
-  heap_remove((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->loop->timer_wheel != NULL)
+    timer_wheel_remove(handle->loop->timer_wheel, handle);
+  else
+    heap_remove((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
   uv__handle_stop(handle);
 
   return 0;
@@ -123,11 +317,71 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 }
 
 
+static int timer_wheel_next_timeout(const uv_loop_t* loop,
+                                    const struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  unsigned int shift;
+  uint64_t base;
+  uint64_t next;
+  uint64_t diff;
+  unsigned int i;
+
+  if (!QUEUE_EMPTY(&wheel->due))
+    return 0;
+
+  next = (uint64_t) -1;
+
+  /* The first level is exact. */
+  if (wheel->count[0] != 0) {
+    for (i = 0; i < WHEEL_L0_SIZE; i++) {
+      if (!QUEUE_EMPTY(&wheel->slots[timer_wheel_slot(0, wheel->time + i)])) {
+        next = wheel->time + i;
+        break;
+      }
+    }
+  }
+
+  /* For the other levels, wake up when the first non-empty slot cascades.
+   * That is a lower bound, the timers in it may expire later.
+   */
+  for (level = 1; level < WHEEL_LEVELS; level++) {
+    if (wheel->count[level] == 0)
+      continue;
+
+    shift = WHEEL_SHIFT(level);
+    base = (wheel->time + ((uint64_t) 1 << shift) - 1) >> shift;
+    for (i = 0; i < WHEEL_LN_SIZE; i++) {
+      if (!QUEUE_EMPTY(&wheel->slots[timer_wheel_slot(level,
+                                                      (base + i) << shift)])) {
+        if (((base + i) << shift) < next)
+          next = (base + i) << shift;
+        break;
+      }
+    }
+  }
+
+  if (next == (uint64_t) -1)
+    return -1; /* block indefinitely */
+
+  if (next <= loop->time)
+    return 0;
+
+  diff = next - loop->time;
+  if (diff > INT_MAX)
+    diff = INT_MAX;
+
+  return diff;
+}
+
+
 int uv__next_timeout(const uv_loop_t* loop) {
   const struct heap_node* heap_node;
   const uv_timer_t* handle;
   uint64_t diff;
 
+  if (loop->timer_wheel != NULL)
+    return timer_wheel_next_timeout(loop, loop->timer_wheel);
+
   heap_node = heap_min((const struct heap*) &loop->timer_heap);
   if (heap_node == NULL)
     return -1; /* block indefinitely */
@@ -144,10 +398,82 @@ int uv__next_timeout(const uv_loop_t* loop) {
 }
 
 
+/* Runs the timers in `queue` until it is empty. Returns 0 when the callback
+ * switched the loop back to the binary heap.
+ */
+static int timer_wheel_expire(uv_loop_t* loop,
+                              struct uv__timer_wheel* wheel,
+                              QUEUE* queue) {
+  uv_timer_t* handle;
+
+  while (!QUEUE_EMPTY(queue)) {
+    handle = QUEUE_DATA(QUEUE_HEAD(queue), uv_timer_t, heap_node);
+    uv_timer_stop(handle);
+    uv_timer_again(handle);
+    handle->timer_cb(handle, 0);
+    if (loop->timer_wheel != wheel)
+      return 0;
+  }
+
+  return 1;
+}
+
+
+static void timer_wheel_run(uv_loop_t* loop, struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  uint64_t next;
+
+  if (!timer_wheel_expire(loop, wheel, &wheel->due))
+    return;
+
+  while (wheel->time <= loop->time) {
+    if (wheel->count[0] == 0) {
+      for (level = 1; level < WHEEL_LEVELS; level++)
+        if (wheel->count[level] != 0)
+          break;
+
+      if (level == WHEEL_LEVELS) {
+        /* The wheel is empty. */
+        wheel->time = loop->time + 1;
+        break;
+      }
+
+      if ((wheel->time & (WHEEL_L0_SIZE - 1)) != 0) {
+        /* Nothing to do until the next cascade. */
+        next = (wheel->time | (WHEEL_L0_SIZE - 1)) + 1;
+        if (next > loop->time + 1)
+          next = loop->time + 1;
+        wheel->time = next;
+        continue;
+      }
+    }
+
+    if ((wheel->time & (WHEEL_L0_SIZE - 1)) == 0) {
+      for (level = 1; level < WHEEL_LEVELS; level++)
+        if (timer_wheel_cascade(wheel, level) != 0)
+          break;
+    }
+
+    if (!timer_wheel_expire(loop,
+                            wheel,
+                            &wheel->slots[timer_wheel_slot(0, wheel->time)])) {
+      return;
+    }
+
+    wheel->time++;
+  }
+}
+
+
 void uv__run_timers(uv_loop_t* loop) {
   struct heap_node* heap_node;
   uv_timer_t* handle;
 
+  if (loop->timer_wheel != NULL) {
+    timer_wheel_run(loop, loop->timer_wheel);
+    return;
+  }
+
   for (;;) {
     heap_node = heap_min((struct heap*) &loop->timer_heap);
     if (heap_node == NULL)
@@ -28,6 +28,14 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+/* The largest datagram that can be received, every recvmmsg() slot is this
+ * big so nothing gets truncated that recvmsg() would have read in full.
+ */
+#define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
+
+/* Datagrams per recvmmsg() or sendmmsg() call. */
+#define UV__MMSG_MAXWIDTH 20
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_run_pending(uv_udp_t* handle);
@@ -79,12 +87,86 @@ void uv__udp_finish_close(uv_udp_t* handle) {
 }
 
 
+#if defined(__linux__)
+/* Send up to UV__MMSG_MAXWIDTH queued requests per system call. Returns
+ * -ENOSYS without touching the queue if the kernel has no sendmmsg().
+ */
+static int uv__udp_sendmmsg(uv_udp_t* handle) {
+  struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr* p;
+  uv_udp_send_t* req;
+  ssize_t npkts;
+  size_t pkts;
+  size_t i;
+  QUEUE* q;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    pkts = 0;
+    q = QUEUE_HEAD(&handle->write_queue);
+    while (pkts < ARRAY_SIZE(h) && q != &handle->write_queue) {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      p = &h[pkts++];
+      memset(p, 0, sizeof(*p));
+      p->msg_hdr.msg_name = &req->addr;
+      p->msg_hdr.msg_namelen = (req->addr.sin6_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      p->msg_hdr.msg_iov = (struct iovec*) req->bufs;
+      p->msg_hdr.msg_iovlen = req->nbufs;
+      q = QUEUE_NEXT(q);
+    }
+
+    do {
+      npkts = uv__sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+    }
+    while (npkts == -1 && errno == EINTR);
+
+    if (npkts == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+
+      if (errno == ENOSYS)
+        return -ENOSYS;
+
+      /* sendmmsg() only fails when the first datagram can't be sent, report
+       * that one and try again with the rest, like the sendmsg() loop would.
+       */
+      req = QUEUE_DATA(QUEUE_HEAD(&handle->write_queue), uv_udp_send_t, queue);
+      req->status = -errno;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+      continue;
+    }
+
+    /* All or nothing per datagram, see uv__udp_run_pending(). */
+    for (i = 0; i < (size_t) npkts; i++) {
+      req = QUEUE_DATA(QUEUE_HEAD(&handle->write_queue), uv_udp_send_t, queue);
+      req->status = h[i].msg_len;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+    }
+  }
+
+  return 0;
+}
+#endif  /* defined(__linux__) */
+
+
 static void uv__udp_run_pending(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if defined(__linux__)
+  static int no_sendmmsg;
+
+  if (no_sendmmsg == 0) {
+    if (uv__udp_sendmmsg(handle) == 0)
+      return;
+    no_sendmmsg = 1;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -161,6 +243,80 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if defined(__linux__)
+/* Fill the UV__UDP_DGRAM_MAXSIZE slots of `buf` with one recvmmsg() call.
+ * Returns the number of datagrams, -1 if there were none or on error (both
+ * reported to recv_cb like in uv__udp_recvmsg()) or -ENOSYS without calling
+ * recv_cb if the kernel has no recvmmsg().
+ */
+static ssize_t uv__udp_recvmmsg(uv_udp_t* handle, const uv_buf_t* buf) {
+  struct sockaddr_in6 peers[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  uv_udp_recv_cb recv_cb;
+  ssize_t nread;
+  uv_buf_t chunk;
+  size_t chunks;
+  size_t k;
+  int flags;
+
+  chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
+  if (chunks > ARRAY_SIZE(iov))
+    chunks = ARRAY_SIZE(iov);
+
+  for (k = 0; k < chunks; k++) {
+    iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
+    iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
+    memset(&msgs[k], 0, sizeof(msgs[k]));
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[0]);
+  }
+
+  do {
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+  }
+  while (nread == -1 && errno == EINTR);
+
+  if (nread == -1) {
+    if (errno == ENOSYS)
+      return -ENOSYS;
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    else
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+    return -1;
+  }
+
+  /* recv_cb may stop or close the handle. Hold on to it, the buffer has to
+   * be handed back regardless.
+   */
+  recv_cb = handle->recv_cb;
+
+  for (k = 0; k < (size_t) nread; k++) {
+    if (handle->io_watcher.fd == -1 || handle->recv_cb == NULL)
+      break;
+
+    flags = UV_UDP_MMSG_CHUNK;
+    if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+      flags |= UV_UDP_PARTIAL;
+
+    chunk = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
+    handle->recv_cb(handle,
+                    msgs[k].msg_len,
+                    &chunk,
+                    (const struct sockaddr*) &peers[k],
+                    flags);
+  }
+
+  recv_cb(handle, 0, buf, NULL, 0);
+
+  return nread;
+}
+#endif  /* defined(__linux__) */
+
+
 static void uv__udp_recvmsg(uv_loop_t* loop,
                             uv__io_t* w,
                             unsigned int revents) {
@@ -168,6 +324,7 @@ static void uv__udp_recvmsg(uv_loop_t* loop,
   struct msghdr h;
   uv_udp_t* handle;
   ssize_t nread;
+  size_t size;
   uv_buf_t buf;
   int flags;
   int count;
@@ -188,13 +345,27 @@ static void uv__udp_recvmsg(uv_loop_t* loop,
   h.msg_name = &peer;
 
   do {
-    handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
+    size = UV__UDP_DGRAM_MAXSIZE;
+    if (handle->flags & UV_UDP_RECVMMSG)
+      size *= UV__MMSG_MAXWIDTH;
+
+    handle->alloc_cb((uv_handle_t*) handle, size, &buf);
     if (buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
     }
     assert(buf.base != NULL);
 
+#if defined(__linux__)
+    if ((handle->flags & UV_UDP_RECVMMSG) &&
+        buf.len >= 2 * UV__UDP_DGRAM_MAXSIZE) {
+      nread = uv__udp_recvmmsg(handle, &buf);
+      if (nread != -ENOSYS)
+        continue;
+      handle->flags &= ~UV_UDP_RECVMMSG;
+    }
+#endif
+
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (void*) &buf;
     h.msg_iovlen = 1;
@@ -300,7 +471,7 @@ int uv__udp_bind(uv_udp_t* handle,
   fd = -1;
 
   /* Check for bad flags. */
-  if (flags & ~UV_UDP_IPV6ONLY)
+  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEPORT))
     return -EINVAL;
 
   /* Cannot set IPv6-only mode on non-IPv6 socket. */
@@ -319,6 +490,12 @@ int uv__udp_bind(uv_udp_t* handle,
   if (err)
     goto out;
 
+  if (flags & UV_UDP_REUSEPORT) {
+    err = uv__reuseport(fd);
+    if (err)
+      goto out;
+  }
+
   if (flags & UV_UDP_IPV6ONLY) {
 #ifdef IPV6_V6ONLY
     yes = 1;
@@ -607,6 +784,19 @@ int uv__udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv_udp_set_recvmmsg(uv_udp_t* handle, int on) {
+#if defined(__linux__)
+  if (on)
+    handle->flags |= UV_UDP_RECVMMSG;
+  else
+    handle->flags &= ~UV_UDP_RECVMMSG;
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   uv__io_stop(handle->loop, &handle->io_watcher, UV__POLLIN);
 
@@ -20,6 +20,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 
 #include "uv.h"
 #include "internal.h"
@@ -74,6 +75,24 @@ int uv_cancel(uv_req_t* req) {
 }
 
 
+int uv_queue_work_class(uv_loop_t* loop,
+                        uv_work_t* req,
+                        uv_threadpool_class_t cls,
+                        uv_work_cb work_cb,
+                        uv_after_work_cb after_work_cb) {
+  if (cls != UV_THREADPOOL_CPU && cls != UV_THREADPOOL_SLOW_CPU)
+    return UV_EINVAL;
+
+  return uv_queue_work(loop, req, work_cb, after_work_cb);
+}
+
+
+int uv_threadpool_stats(uv_threadpool_stats_t* stats) {
+  memset(stats, 0, sizeof(*stats));
+  return UV_ENOSYS;
+}
+
+
 void uv_process_work_req(uv_loop_t* loop, uv_work_t* req) {
   uv__req_unregister(loop, req);
   if(req->after_work_cb)
@@ -193,6 +193,11 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 }
 
 
+int uv_loop_set_timer_wheel(uv_loop_t* loop, int on) {
+  return on ? UV_ENOSYS : 0;
+}
+
+
 DWORD uv_get_poll_timeout(uv_loop_t* loop) {
   uv_timer_t* timer;
   int64_t delta;
@@ -349,6 +349,12 @@ int uv__udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloc_cb,
 }
 
 
+/* Windows has no recvmmsg(). */
+int uv_udp_set_recvmmsg(uv_udp_t* handle, int on) {
+  return UV_ENOSYS;
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   if (handle->flags & UV_HANDLE_READING) {
     handle->flags &= ~UV_HANDLE_READING;
@@ -747,6 +753,10 @@ int uv__udp_bind(uv_udp_t* handle,
                  unsigned int flags) {
   int err;
 
+  /* Windows has no load balancing SO_REUSEPORT. */
+  if (flags & UV_UDP_REUSEPORT)
+    return UV_ENOTSUP;
+
   err = uv_udp_try_bind(handle, addr, addrlen, flags);
   if (err)
     return uv_translate_sys_error(err);
@@ -64,6 +64,8 @@ TEST_DECLARE   (tcp_bind_error_addrnotavail_2)
 TEST_DECLARE   (tcp_bind_error_fault)
 TEST_DECLARE   (tcp_bind_error_inval)
 TEST_DECLARE   (tcp_bind_localhost_ok)
+TEST_DECLARE   (tcp_reuseport)
+TEST_DECLARE   (tcp_reuseport_bad_flags)
 TEST_DECLARE   (tcp_listen_without_bind)
 TEST_DECLARE   (tcp_connect_error_fault)
 TEST_DECLARE   (tcp_connect_timeout)
@@ -80,6 +82,8 @@ TEST_DECLARE   (tcp_bind6_error_fault)
 TEST_DECLARE   (tcp_bind6_error_inval)
 TEST_DECLARE   (tcp_bind6_localhost_ok)
 TEST_DECLARE   (udp_send_and_recv)
+TEST_DECLARE   (udp_mmsg)
+TEST_DECLARE   (udp_reuseport)
 TEST_DECLARE   (udp_multicast_join)
 TEST_DECLARE   (udp_multicast_ttl)
 TEST_DECLARE   (udp_multicast_interface)
@@ -114,6 +118,10 @@ TEST_DECLARE   (timer_huge_timeout)
 TEST_DECLARE   (timer_huge_repeat)
 TEST_DECLARE   (timer_run_once)
 TEST_DECLARE   (timer_from_check)
+TEST_DECLARE   (timer_wheel_busy)
+TEST_DECLARE   (timer_wheel_order)
+TEST_DECLARE   (timer_wheel_reset)
+TEST_DECLARE   (timer_wheel_huge_timeout)
 TEST_DECLARE   (idle_starvation)
 TEST_DECLARE   (loop_handles)
 TEST_DECLARE   (get_loadavg)
@@ -221,6 +229,11 @@ TEST_DECLARE   (threadpool_cancel_getaddrinfo)
 TEST_DECLARE   (threadpool_cancel_work)
 TEST_DECLARE   (threadpool_cancel_fs)
 TEST_DECLARE   (threadpool_cancel_single)
+#ifndef _WIN32
+TEST_DECLARE   (threadpool_slow_io_limit)
+TEST_DECLARE   (threadpool_grow)
+TEST_DECLARE   (threadpool_slow_cpu_limit)
+#endif
 TEST_DECLARE   (thread_local_storage)
 TEST_DECLARE   (thread_mutex)
 TEST_DECLARE   (thread_rwlock)
@@ -326,6 +339,8 @@ TASK_LIST_START
   TEST_ENTRY  (tcp_bind_error_fault)
   TEST_ENTRY  (tcp_bind_error_inval)
   TEST_ENTRY  (tcp_bind_localhost_ok)
+  TEST_ENTRY  (tcp_reuseport)
+  TEST_ENTRY  (tcp_reuseport_bad_flags)
   TEST_ENTRY  (tcp_listen_without_bind)
   TEST_ENTRY  (tcp_connect_error_fault)
   TEST_ENTRY  (tcp_connect_timeout)
@@ -346,6 +361,8 @@ TASK_LIST_START
   TEST_ENTRY  (tcp_bind6_localhost_ok)
 
   TEST_ENTRY  (udp_send_and_recv)
+  TEST_ENTRY  (udp_mmsg)
+  TEST_ENTRY  (udp_reuseport)
   TEST_ENTRY  (udp_dgram_too_big)
   TEST_ENTRY  (udp_dual_stack)
   TEST_ENTRY  (udp_ipv6_only)
@@ -391,6 +408,10 @@ TASK_LIST_START
   TEST_ENTRY  (timer_huge_repeat)
   TEST_ENTRY  (timer_run_once)
   TEST_ENTRY  (timer_from_check)
+  TEST_ENTRY  (timer_wheel_busy)
+  TEST_ENTRY  (timer_wheel_order)
+  TEST_ENTRY  (timer_wheel_reset)
+  TEST_ENTRY  (timer_wheel_huge_timeout)
 
   TEST_ENTRY  (idle_starvation)
 
@@ -544,6 +565,11 @@ TASK_LIST_START
   TEST_ENTRY  (threadpool_cancel_work)
   TEST_ENTRY  (threadpool_cancel_fs)
   TEST_ENTRY  (threadpool_cancel_single)
+#ifndef _WIN32
+  TEST_ENTRY  (threadpool_slow_io_limit)
+  TEST_ENTRY  (threadpool_grow)
+  TEST_ENTRY  (threadpool_slow_cpu_limit)
+#endif
   TEST_ENTRY  (thread_local_storage)
   TEST_ENTRY  (thread_mutex)
   TEST_ENTRY  (thread_rwlock)
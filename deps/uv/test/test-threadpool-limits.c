@@ -0,0 +1,278 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FIFO_NAME "test_fifo"
+#define NUM_OPENS 8
+
+static uv_fs_t open_reqs[NUM_OPENS];
+static uv_work_t work_req;
+static int open_cb_called;
+static int after_work_cb_called;
+static int writer_fd = -1;
+
+
+static void open_cb(uv_fs_t* req) {
+  uv_fs_t close_req;
+
+  ASSERT(req->result >= 0);
+  ASSERT(0 == uv_fs_close(req->loop, &close_req, req->result, NULL));
+  uv_fs_req_cleanup(&close_req);
+  uv_fs_req_cleanup(req);
+
+  if (++open_cb_called == NUM_OPENS)
+    ASSERT(0 == close(writer_fd));
+}
+
+
+static void work_cb(uv_work_t* req) {
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  /* Every file system request is still blocked on the fifo. */
+  ASSERT(open_cb_called == 0);
+  after_work_cb_called++;
+
+  writer_fd = open(FIFO_NAME, O_WRONLY | O_NONBLOCK);
+  ASSERT(writer_fd >= 0);
+}
+
+
+/* Opening a fifo for reading blocks until there is a writer. That ties up
+ * the threads that run the opens but should never hold up other work.
+ */
+TEST_IMPL(threadpool_slow_io_limit) {
+  uv_loop_t* loop;
+  int i;
+
+  loop = uv_default_loop();
+  unlink(FIFO_NAME);
+  ASSERT(0 == mkfifo(FIFO_NAME, 0600));
+
+  for (i = 0; i < NUM_OPENS; i++)
+    ASSERT(0 == uv_fs_open(loop, open_reqs + i, FIFO_NAME, O_RDONLY, 0,
+                           open_cb));
+
+  ASSERT(0 == uv_queue_work(loop, &work_req, work_cb, after_work_cb));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(after_work_cb_called == 1);
+  ASSERT(open_cb_called == NUM_OPENS);
+
+  unlink(FIFO_NAME);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+#define NUM_GROW 4
+
+static uv_work_t grow_reqs[NUM_GROW];
+static uv_mutex_t grow_mutex;
+static uv_cond_t grow_cond;
+static int grow_started;
+static int grow_done_cb_called;
+
+
+/* Holds its thread until all NUM_GROW requests run at the same time. */
+static void grow_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&grow_mutex);
+  if (++grow_started == NUM_GROW)
+    uv_cond_broadcast(&grow_cond);
+  while (grow_started < NUM_GROW)
+    ASSERT(0 == uv_cond_timedwait(&grow_cond, &grow_mutex, 5e9));
+  uv_mutex_unlock(&grow_mutex);
+}
+
+
+static void grow_done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  grow_done_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_grow) {
+  uv_threadpool_stats_t stats;
+  uv_threadpool_class_stats_t* cpu;
+  uint64_t waits;
+  int i;
+
+  /* Start with one thread, the pool has to grow to run the requests. */
+  setenv("UV_THREADPOOL_SIZE", "1", 1);
+  setenv("UV_THREADPOOL_MAX", "8", 1);
+
+  ASSERT(0 == uv_threadpool_stats(&stats));
+  ASSERT(stats.threads == 0);
+
+  ASSERT(0 == uv_mutex_init(&grow_mutex));
+  ASSERT(0 == uv_cond_init(&grow_cond));
+
+  for (i = 0; i < NUM_GROW; i++)
+    ASSERT(0 == uv_queue_work(uv_default_loop(),
+                              grow_reqs + i,
+                              grow_work_cb,
+                              grow_done_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(grow_done_cb_called == NUM_GROW);
+
+  ASSERT(0 == uv_threadpool_stats(&stats));
+  ASSERT(stats.min_threads == 1);
+  ASSERT(stats.max_threads == 8);
+  ASSERT(stats.threads >= NUM_GROW);
+  ASSERT(stats.threads <= 8);
+
+  cpu = stats.classes + UV_THREADPOOL_CPU;
+  ASSERT(cpu->queued == 0);
+  ASSERT(cpu->running == 0);
+  ASSERT(cpu->limit == 8);
+  ASSERT(cpu->completed == NUM_GROW);
+
+  waits = 0;
+  for (i = 0; i < UV_THREADPOOL_WAIT_BUCKETS; i++)
+    waits += cpu->wait[i];
+  ASSERT(waits == NUM_GROW);
+
+  ASSERT(stats.classes[UV_THREADPOOL_IO].completed == 0);
+  ASSERT(stats.classes[UV_THREADPOOL_IO].limit == 4);
+
+  uv_cond_destroy(&grow_cond);
+  uv_mutex_destroy(&grow_mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+#define NUM_SLOW 8
+
+static uv_work_t slow_reqs[NUM_SLOW];
+static uv_work_t fast_req;
+static uv_mutex_t slow_mutex;
+static uv_cond_t slow_cond;
+static int slow_released;
+static int slow_done_cb_called;
+static int fast_done_cb_called;
+
+
+/* Holds its thread until the CPU request has run. */
+static void slow_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&slow_mutex);
+  while (!slow_released)
+    ASSERT(0 == uv_cond_timedwait(&slow_cond, &slow_mutex, 5e9));
+  uv_mutex_unlock(&slow_mutex);
+}
+
+
+static void slow_done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  ASSERT(fast_done_cb_called == 1);
+  slow_done_cb_called++;
+}
+
+
+static void fast_work_cb(uv_work_t* req) {
+}
+
+
+static void fast_done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  ASSERT(slow_done_cb_called == 0);
+  fast_done_cb_called++;
+
+  uv_mutex_lock(&slow_mutex);
+  slow_released = 1;
+  uv_cond_broadcast(&slow_cond);
+  uv_mutex_unlock(&slow_mutex);
+}
+
+
+/* Slow CPU work that fills the queue leaves threads for other CPU work. */
+TEST_IMPL(threadpool_slow_cpu_limit) {
+  uv_threadpool_stats_t stats;
+  uv_loop_t* loop;
+  int i;
+
+  /* A fixed pool of four threads, two of which may run slow CPU work. */
+  setenv("UV_THREADPOOL_SIZE", "4", 1);
+  setenv("UV_THREADPOOL_MIN", "4", 1);
+  setenv("UV_THREADPOOL_MAX", "4", 1);
+  setenv("UV_THREADPOOL_SLOW_CPU_MAX", "2", 1);
+
+  loop = uv_default_loop();
+  ASSERT(0 == uv_mutex_init(&slow_mutex));
+  ASSERT(0 == uv_cond_init(&slow_cond));
+
+  for (i = 0; i < NUM_SLOW; i++)
+    ASSERT(0 == uv_queue_work_class(loop,
+                                    slow_reqs + i,
+                                    UV_THREADPOOL_SLOW_CPU,
+                                    slow_work_cb,
+                                    slow_done_cb));
+
+  /* Let the workers take what they may before the CPU request comes in. */
+  for (;;) {
+    ASSERT(0 == uv_threadpool_stats(&stats));
+    if (stats.threads > 0 &&
+        stats.classes[UV_THREADPOOL_SLOW_CPU].running + stats.idle ==
+            stats.threads) {
+      break;
+    }
+    uv_sleep(10);
+  }
+  ASSERT(stats.threads == 4);
+  ASSERT(stats.classes[UV_THREADPOOL_SLOW_CPU].running == 2);
+
+  ASSERT(UV_EINVAL == uv_queue_work_class(loop,
+                                          &fast_req,
+                                          UV_THREADPOOL_IO,
+                                          fast_work_cb,
+                                          fast_done_cb));
+  ASSERT(0 == uv_queue_work(loop, &fast_req, fast_work_cb, fast_done_cb));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(fast_done_cb_called == 1);
+  ASSERT(slow_done_cb_called == NUM_SLOW);
+
+  ASSERT(0 == uv_threadpool_stats(&stats));
+  ASSERT(stats.classes[UV_THREADPOOL_SLOW_CPU].limit == 2);
+  ASSERT(stats.classes[UV_THREADPOOL_SLOW_CPU].completed == NUM_SLOW);
+  ASSERT(stats.classes[UV_THREADPOOL_CPU].completed == 1);
+
+  uv_cond_destroy(&slow_cond);
+  uv_mutex_destroy(&slow_mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+#endif  /* !_WIN32 */
@@ -0,0 +1,202 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_TIMERS 64
+
+static uv_timer_t timers[NUM_TIMERS];
+static uint64_t timeouts[NUM_TIMERS];
+static uint64_t start_time;
+static int fired[NUM_TIMERS];
+static int order[NUM_TIMERS];
+static int order_cb_called;
+static int reset_cb_called;
+
+
+static void never_cb(uv_timer_t* handle, int status) {
+  FATAL("never_cb should never be called");
+}
+
+
+static void order_cb(uv_timer_t* handle, int status) {
+  int index;
+
+  ASSERT(status == 0);
+  index = (int) (handle - timers);
+  ASSERT(index >= 0 && index < NUM_TIMERS);
+  ASSERT(fired[index] == 0);
+  ASSERT(uv_now(handle->loop) >= start_time + timeouts[index]);
+
+  fired[index] = 1;
+  order[order_cb_called++] = index;
+}
+
+
+static void reset_cb(uv_timer_t* handle, int status) {
+  ASSERT(status == 0);
+  ASSERT(uv_now(handle->loop) >= start_time + 42);
+  reset_cb_called++;
+}
+
+
+TEST_IMPL(timer_wheel_busy) {
+#ifdef _WIN32
+  RETURN_SKIP("Timer wheel is not implemented on Windows.");
+#endif
+  uv_loop_t* loop;
+  uv_timer_t handle;
+
+  loop = uv_default_loop();
+  ASSERT(0 == uv_timer_init(loop, &handle));
+
+  ASSERT(0 == uv_timer_start(&handle, never_cb, 1000, 0));
+  ASSERT(UV_EBUSY == uv_loop_set_timer_wheel(loop, 1));
+  ASSERT(0 == uv_timer_stop(&handle));
+  ASSERT(0 == uv_loop_set_timer_wheel(loop, 1));
+  ASSERT(0 == uv_loop_set_timer_wheel(loop, 1));
+
+  ASSERT(0 == uv_timer_start(&handle, never_cb, 1000, 0));
+  ASSERT(UV_EBUSY == uv_loop_set_timer_wheel(loop, 0));
+  ASSERT(0 == uv_timer_stop(&handle));
+  ASSERT(0 == uv_loop_set_timer_wheel(loop, 0));
+
+  uv_close((uv_handle_t*) &handle, NULL);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+/* Timers in different levels of the wheel must expire in the same order as
+ * with the binary heap: by timeout first, then by start order.
+ */
+TEST_IMPL(timer_wheel_order) {
+#ifdef _WIN32
+  RETURN_SKIP("Timer wheel is not implemented on Windows.");
+#endif
+  uv_loop_t* loop;
+  int i;
+  int j;
+
+  loop = uv_default_loop();
+  ASSERT(0 == uv_loop_set_timer_wheel(loop, 1));
+  start_time = uv_now(loop);
+
+  for (i = 0; i < NUM_TIMERS; i++) {
+    /* Mix of zero, short and cascading timeouts with many duplicates. */
+    timeouts[i] = (i * 37) % 11 * 71;
+    ASSERT(0 == uv_timer_init(loop, &timers[i]));
+    ASSERT(0 == uv_timer_start(&timers[i], order_cb, timeouts[i], 0));
+  }
+
+  /* Stopped timers must not fire. */
+  for (i = 0; i < NUM_TIMERS; i += 7) {
+    ASSERT(0 == uv_timer_stop(&timers[i]));
+    fired[i] = -1;
+  }
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  for (i = 0; i < NUM_TIMERS; i++)
+    ASSERT(fired[i] != 0);
+
+  for (i = 1; i < order_cb_called; i++) {
+    j = order[i - 1];
+    ASSERT(timeouts[j] < timeouts[order[i]] ||
+           (timeouts[j] == timeouts[order[i]] && j < order[i]));
+  }
+
+  for (i = 0; i < NUM_TIMERS; i++)
+    uv_close((uv_handle_t*) &timers[i], NULL);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+/* Idle timeout pattern: the same timer is reset over and over again. */
+TEST_IMPL(timer_wheel_reset) {
+#ifdef _WIN32
+  RETURN_SKIP("Timer wheel is not implemented on Windows.");
+#endif
+  uv_loop_t* loop;
+  uv_timer_t handle;
+  int i;
+
+  loop = uv_default_loop();
+  ASSERT(0 == uv_loop_set_timer_wheel(loop, 1));
+  ASSERT(0 == uv_timer_init(loop, &handle));
+
+  for (i = 0; i < 100000; i++)
+    ASSERT(0 == uv_timer_start(&handle, reset_cb, i % 50000, 0));
+
+  start_time = uv_now(loop);
+  ASSERT(0 == uv_timer_start(&handle, reset_cb, 42, 0));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(reset_cb_called == 1);
+
+  uv_close((uv_handle_t*) &handle, NULL);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+/* Far away timers must not wake up the loop early, also not when they are
+ * beyond the range of the wheel.
+ */
+TEST_IMPL(timer_wheel_huge_timeout) {
+#ifdef _WIN32
+  RETURN_SKIP("Timer wheel is not implemented on Windows.");
+#endif
+  uv_loop_t* loop;
+  uv_timer_t far_timer;
+  uv_timer_t huge_timer;
+  int timeout;
+
+  loop = uv_default_loop();
+  ASSERT(0 == uv_loop_set_timer_wheel(loop, 1));
+  ASSERT(0 == uv_timer_init(loop, &far_timer));
+  ASSERT(0 == uv_timer_init(loop, &huge_timer));
+
+  ASSERT(0 == uv_timer_start(&far_timer, never_cb, 20000, 0));
+  timeout = uv_backend_timeout(loop);
+  ASSERT(timeout > 0 && timeout <= 20000);
+
+  ASSERT(0 == uv_timer_start(&huge_timer, never_cb, (uint64_t) -1, 0));
+  ASSERT(0 == uv_timer_stop(&far_timer));
+  ASSERT(uv_backend_timeout(loop) > 20000);
+
+  ASSERT(0 != uv_run(loop, UV_RUN_NOWAIT));
+  ASSERT(0 == uv_timer_stop(&huge_timer));
+
+  uv_close((uv_handle_t*) &far_timer, NULL);
+  uv_close((uv_handle_t*) &huge_timer, NULL);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
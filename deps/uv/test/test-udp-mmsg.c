@@ -0,0 +1,154 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_DGRAMS 10
+
+#define CHECK_HANDLE(handle) \
+  ASSERT((uv_udp_t*)(handle) == &server || (uv_udp_t*)(handle) == &client)
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_reqs[NUM_DGRAMS];
+
+static int alloc_cb_called;
+static int send_cb_called;
+static int recv_cb_called;
+static int chunk_cb_called;
+static int free_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  CHECK_HANDLE(handle);
+  /* Room for more than one datagram. */
+  ASSERT(suggested_size >= 2 * 64 * 1024);
+  buf->base = malloc(suggested_size);
+  ASSERT(buf->base != NULL);
+  buf->len = suggested_size;
+  alloc_cb_called++;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  CHECK_HANDLE(handle);
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT(status == 0);
+  CHECK_HANDLE(req->handle);
+  send_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  CHECK_HANDLE(handle);
+  ASSERT(nread >= 0);
+
+  if (nread == 0) {
+    /* The whole buffer is handed back once, after its chunks. */
+    ASSERT(addr == NULL);
+    ASSERT(!(flags & UV_UDP_MMSG_CHUNK));
+    free(buf->base);
+    free_cb_called++;
+    return;
+  }
+
+  ASSERT(addr != NULL);
+  ASSERT(nread == 4);
+  ASSERT(!memcmp("PING", buf->base, nread));
+
+  if (flags & UV_UDP_MMSG_CHUNK)
+    chunk_cb_called++;
+  else
+    free(buf->base);
+
+  if (++recv_cb_called == NUM_DGRAMS) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_mmsg) {
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  int i;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+
+  r = uv_udp_init(uv_default_loop(), &server);
+  ASSERT(r == 0);
+
+  r = uv_udp_set_recvmmsg(&server, 1);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("No recvmmsg() on this platform.");
+  ASSERT(r == 0);
+
+  r = uv_udp_bind(&server, (const struct sockaddr*) &addr, 0);
+  ASSERT(r == 0);
+
+  r = uv_udp_recv_start(&server, alloc_cb, recv_cb);
+  ASSERT(r == 0);
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  r = uv_udp_init(uv_default_loop(), &client);
+  ASSERT(r == 0);
+
+  /* Queued up front so they go out together and arrive as one batch. */
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_DGRAMS; i++) {
+    r = uv_udp_send(&send_reqs[i],
+                    &client,
+                    &buf,
+                    1,
+                    (const struct sockaddr*) &addr,
+                    send_cb);
+    ASSERT(r == 0);
+  }
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(send_cb_called == NUM_DGRAMS);
+  ASSERT(recv_cb_called == NUM_DGRAMS);
+  ASSERT(chunk_cb_called > 0);
+  ASSERT(alloc_cb_called < NUM_DGRAMS);
+  ASSERT(close_cb_called == 2);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
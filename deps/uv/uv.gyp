@@ -344,6 +344,7 @@
         'test/test-poll-close.c',
         'test/test-process-title.c',
         'test/test-ref.c',
+        'test/test-reuseport.c',
         'test/test-run-nowait.c',
         'test/test-run-once.c',
         'test/test-semaphore.c',
@@ -374,6 +375,7 @@
         'test/test-tcp-read-stop.c',
         'test/test-threadpool.c',
         'test/test-threadpool-cancel.c',
+        'test/test-threadpool-limits.c',
         'test/test-mutexes.c',
         'test/test-thread.c',
         'test/test-barrier.c',
@@ -381,9 +383,11 @@
         'test/test-timer-again.c',
         'test/test-timer-from-check.c',
         'test/test-timer.c',
+        'test/test-timer-wheel.c',
         'test/test-tty.c',
         'test/test-udp-dgram-too-big.c',
         'test/test-udp-ipv6.c',
+        'test/test-udp-mmsg.c',
         'test/test-udp-open.c',
         'test/test-udp-options.c',
         'test/test-udp-send-and-recv.c',
@@ -251,6 +251,9 @@ TLSSocket.prototype._init = function(socket) {
          this.server.listeners('newSession').length > 0)) {
       this.ssl.enableSessionCallbacks();
     }
+
+    if (options.asyncHandshake)
+      this.ssl.enableAsyncHandshake();
   } else {
     this.ssl.onhandshakestart = function() {};
     this.ssl.onhandshakedone = this._finishInit.bind(this);
@@ -492,6 +495,9 @@ TLSSocket.prototype.getCipher = function(err) {
 // - cert: string.
 // - ca: string or array of strings.
 // - sessionTimeout: integer.
+// - sessionCacheSize: integer, size of the native session cache.
+// - sharedSessionCache: string, name of a shared memory session cache.
+// - asyncHandshake: boolean, run handshake steps on the thread pool.
 //
 // emit 'secureConnection'
 //   function (tlsSocket) { }
@@ -558,6 +564,15 @@ function Server(/* [options], listener */) {
     sharedCreds.context.setTicketKeys(self.ticketKeys);
   }
 
+  if (self.sessionCacheSize) {
+    sharedCreds.context.setSessionCache(self.sessionCacheSize);
+  }
+
+  if (self.sharedSessionCache) {
+    sharedCreds.context.setSharedSessionCache(self.sharedSessionCache,
+                                              self.sessionCacheSize || 4096);
+  }
+
   // constructor call
   net.Server.call(this, function(raw_socket) {
     var socket = new TLSSocket(raw_socket, {
@@ -568,7 +583,8 @@ function Server(/* [options], listener */) {
       rejectUnauthorized: self.rejectUnauthorized,
       handshakeTimeout: timeout,
       NPNProtocols: self.NPNProtocols,
-      SNICallback: options.SNICallback || SNICallback
+      SNICallback: options.SNICallback || SNICallback,
+      asyncHandshake: self.asyncHandshake
     });
 
     socket.on('secure', function() {
@@ -626,6 +642,11 @@ Server.prototype._getServerData = function() {
 };
 
 
+Server.prototype.getSessionCacheStats = function() {
+  return this._sharedCreds.context.getSessionCacheStats();
+};
+
+
 Server.prototype._setServerData = function(data) {
   this._sharedCreds.context.setTicketKeys(new Buffer(data.ticketKeys, 'hex'));
 };
@@ -656,6 +677,22 @@ Server.prototype.setOptions = function(options) {
     this.ecdhCurve = options.ecdhCurve;
   if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
   if (options.ticketKeys) this.ticketKeys = options.ticketKeys;
+  if (options.sessionCacheSize) {
+    if (!util.isNumber(options.sessionCacheSize) ||
+        options.sessionCacheSize < 0) {
+      throw new TypeError('sessionCacheSize must be a positive number');
+    }
+    this.sessionCacheSize = options.sessionCacheSize;
+  }
+  if (options.sharedSessionCache) {
+    if (!util.isString(options.sharedSessionCache) ||
+        /\//.test(options.sharedSessionCache)) {
+      throw new TypeError('sharedSessionCache must be a name without slashes');
+    }
+    this.sharedSessionCache = options.sharedSessionCache;
+  }
+  if (util.isBoolean(options.asyncHandshake))
+    this.asyncHandshake = options.asyncHandshake;
   var secureOptions = options.secureOptions || 0;
   if (options.honorCipherOrder) {
     secureOptions |= constants.SSL_OP_CIPHER_SERVER_PREFERENCE;
@@ -319,38 +319,85 @@ function handleMessage(target, message, handle) {
   target.emit(eventName, message, handle);
 }
 
-function setupChannel(target, channel) {
+// Binary messages are prefixed with their size in native byte order.
+var readMessageSize = require('os').endianness() === 'LE' ?
+    Buffer.prototype.readUInt32LE : Buffer.prototype.readUInt32BE;
+
+function setupChannel(target, channel, serialization) {
   target._channel = channel;
   target._handleQueue = null;
 
+  var binary = serialization === 'binary';
+
+  function deliver(message, recvHandle) {
+    // There will be at most one NODE_HANDLE message in every chunk we
+    // read because SCM_RIGHTS messages don't get coalesced. Make sure
+    // that we deliver the handle with the right message however.
+    if (message && message.cmd === 'NODE_HANDLE')
+      handleMessage(target, message, recvHandle);
+    else
+      handleMessage(target, message, undefined);
+  }
+
   var decoder = new StringDecoder('utf8');
   var jsonBuffer = '';
-  channel.buffering = false;
-  channel.onread = function(nread, pool, recvHandle) {
-    // TODO(bnoordhuis) Check that nread > 0.
-    if (pool) {
-      jsonBuffer += decoder.write(pool);
 
-      var i, start = 0;
+  function readJSON(pool, recvHandle) {
+    jsonBuffer += decoder.write(pool);
 
-      //Linebreak is used as a message end sign
-      while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
-        var json = jsonBuffer.slice(start, i);
-        var message = JSON.parse(json);
+    var i, start = 0;
 
-        // There will be at most one NODE_HANDLE message in every chunk we
-        // read because SCM_RIGHTS messages don't get coalesced. Make sure
-        // that we deliver the handle with the right message however.
-        if (message && message.cmd === 'NODE_HANDLE')
-          handleMessage(target, message, recvHandle);
-        else
-          handleMessage(target, message, undefined);
+    //Linebreak is used as a message end sign
+    while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
+      var json = jsonBuffer.slice(start, i);
+      deliver(JSON.parse(json), recvHandle);
+      start = i + 1;
+    }
+    jsonBuffer = jsonBuffer.slice(start);
+    return jsonBuffer.length !== 0;
+  }
 
-        start = i + 1;
-      }
-      jsonBuffer = jsonBuffer.slice(start);
-      this.buffering = jsonBuffer.length !== 0;
+  // Chunks of an incomplete binary message. Don't concatenate them until
+  // the whole message is in, large messages would be copied over and over.
+  var chunks = [];
+  var chunksLength = 0;
+  var messageLength = 0;
+
+  function readBinary(pool, recvHandle) {
+    chunks.push(pool);
+    chunksLength += pool.length;
+    if (chunksLength < messageLength)
+      return true;
 
+    var data = chunks.length === 1 ? chunks[0] : Buffer.concat(chunks);
+    var messages = [];
+    var consumed = channel.readMessages(data, messages);
+
+    chunks = [];
+    chunksLength = 0;
+    messageLength = 0;
+    if (consumed < data.length) {
+      var rest = data.slice(consumed);
+      chunks.push(rest);
+      chunksLength = rest.length;
+      if (rest.length >= 4)
+        messageLength = 4 + readMessageSize.call(rest, 0);
+    }
+
+    for (var i = 0; i < messages.length; i++)
+      deliver(messages[i], recvHandle);
+
+    return chunksLength !== 0;
+  }
+
+  channel.buffering = false;
+  channel.onread = function(nread, pool, recvHandle) {
+    // TODO(bnoordhuis) Check that nread > 0.
+    if (pool) {
+      if (binary)
+        this.buffering = readBinary(pool, recvHandle);
+      else
+        this.buffering = readJSON(pool, recvHandle);
     } else {
       this.buffering = false;
       target.disconnect();
@@ -463,8 +510,13 @@ function setupChannel(target, channel) {
     }
 
     var req = { oncomplete: nop };
-    var string = JSON.stringify(message) + '\n';
-    var err = channel.writeUtf8String(req, string, handle);
+    var err;
+    if (binary) {
+      err = channel.writeMessage(req, message, handle);
+    } else {
+      var string = JSON.stringify(message) + '\n';
+      err = channel.writeUtf8String(req, string, handle);
+    }
 
     if (err) {
       if (!swallowErrors)
@@ -567,12 +619,12 @@ exports.fork = function(modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function(fd) {
+exports._forkChild = function(fd, serialization) {
   // set process.send()
   var p = createPipe(true);
   p.open(fd);
   p.unref();
-  setupChannel(process, p);
+  setupChannel(process, p, serialization);
 
   var refs = 0;
   process.on('newListener', function(name) {
@@ -967,6 +1019,7 @@ var spawn = exports.spawn = function(/*file, args, options*/) {
     detached: !!(options && options.detached),
     envPairs: envPairs,
     stdio: options ? options.stdio : null,
+    serialization: options ? options.serialization : null,
     uid: options ? options.uid : null,
     gid: options ? options.gid : null
   });
@@ -1080,6 +1133,12 @@ ChildProcess.prototype.spawn = function(options) {
       // If no `stdio` option was given - use default
       stdio = options.stdio || 'pipe';
 
+  if (!util.isNullOrUndefined(options.serialization) &&
+      options.serialization !== 'json' &&
+      options.serialization !== 'binary') {
+    throw new TypeError('Bad serialization: ' + options.serialization);
+  }
+
   stdio = _validateStdio(stdio, false);
 
   ipc = stdio.ipc;
@@ -1090,6 +1149,8 @@ ChildProcess.prototype.spawn = function(options) {
     // Let child process know about opened IPC channel
     options.envPairs = options.envPairs || [];
     options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+    if (options.serialization === 'binary')
+      options.envPairs.push('NODE_CHANNEL_SERIALIZATION=binary');
   }
 
   var err = this._handle.spawn(options);
@@ -1147,7 +1208,7 @@ ChildProcess.prototype.spawn = function(options) {
   });
 
   // Add .send() method and start listening for IPC data
-  if (!util.isUndefined(ipc)) setupChannel(this, ipc);
+  if (!util.isUndefined(ipc)) setupChannel(this, ipc, options.serialization);
 
   return err;
 };
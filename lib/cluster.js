@@ -27,6 +27,7 @@ var net = require('net');
 var util = require('util');
 var SCHED_NONE = 1;
 var SCHED_RR = 2;
+var SCHED_REUSEPORT = 3;
 
 var cluster = new EventEmitter;
 module.exports = cluster;
@@ -90,6 +91,69 @@ SharedHandle.prototype.remove = function(worker) {
 };
 
 
+// SO_REUSEPORT. Every worker binds its own socket to the same address and
+// port and the kernel balances connections (or datagrams) over them. The
+// master holds a bound placeholder socket until the first worker is listening
+// so that a request for port 0 resolves to the same port in every worker.
+function ReusePortHandle(key, address, port, addressType, backlog, fd) {
+  this.key = key;
+  this.workers = [];
+  this.handle = null;
+  this.port = port;
+  this.errno = 0;
+
+  var rval = createReusePortHandle(address, port, addressType, fd);
+  if (util.isNumber(rval)) {
+    this.errno = rval;
+    return;
+  }
+
+  var out = {};
+  var err = rval.getsockname(out);
+  if (err) {
+    rval.close();
+    this.errno = err;
+    return;
+  }
+
+  this.handle = rval;
+  this.port = out.port;
+}
+
+ReusePortHandle.prototype.add = function(worker, send) {
+  assert(this.workers.indexOf(worker) === -1);
+  this.workers.push(worker);
+  send(this.errno, { reuseport: true, port: this.port }, null);
+};
+
+ReusePortHandle.prototype.remove = function(worker) {
+  var index = this.workers.indexOf(worker);
+  if (index === -1) return false;
+  this.workers.splice(index, 1);
+  if (this.workers.length !== 0) return false;
+  this.release();
+  return true;
+};
+
+// A bound UDP socket is part of the SO_REUSEPORT group and gets its share of
+// the datagrams, so don't hang on to the placeholder longer than necessary.
+ReusePortHandle.prototype.release = function() {
+  if (this.handle) this.handle.close();
+  this.handle = null;
+};
+
+// Returns a handle bound with SO_REUSEPORT or a negative errno.
+function createReusePortHandle(address, port, addressType, fd) {
+  var flags;
+  if (addressType === 'udp4' || addressType === 'udp6') {
+    flags = process.binding('udp_wrap').UV_UDP_REUSEPORT;
+    return dgram._createSocketHandle(address, port, addressType, fd, flags);
+  }
+  flags = process.binding('tcp_wrap').UV_TCP_REUSEPORT;
+  return net._createServerHandle(address, port, addressType, fd, flags);
+}
+
+
 // Start a round-robin server. Master accepts connections and distributes
 // them over the workers.
 function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
@@ -225,7 +289,8 @@ function masterInit() {
   // XXX(bnoordhuis) Fold cluster.schedulingPolicy into cluster.settings?
   var schedulingPolicy = {
     'none': SCHED_NONE,
-    'rr': SCHED_RR
+    'rr': SCHED_RR,
+    'reuseport': SCHED_REUSEPORT
   }[process.env.NODE_CLUSTER_SCHED_POLICY];
 
   if (util.isUndefined(schedulingPolicy)) {
@@ -237,6 +302,7 @@ function masterInit() {
   cluster.schedulingPolicy = schedulingPolicy;
   cluster.SCHED_NONE = SCHED_NONE;  // Leave it to the operating system.
   cluster.SCHED_RR = SCHED_RR;      // Master distributes connections.
+  cluster.SCHED_REUSEPORT = SCHED_REUSEPORT;  // Kernel balances SO_REUSEPORT.
 
   // Keyed on address:port:etc. When a worker dies, we walk over the handles
   // and remove() the worker from each one. remove() may do a linear scan
@@ -258,7 +324,9 @@ function masterInit() {
       settings.execArgv = settings.execArgv.concat(['--logfile=v8-%p.log']);
     }
     schedulingPolicy = cluster.schedulingPolicy;  // Freeze policy.
-    assert(schedulingPolicy === SCHED_NONE || schedulingPolicy === SCHED_RR,
+    assert(schedulingPolicy === SCHED_NONE ||
+           schedulingPolicy === SCHED_RR ||
+           schedulingPolicy === SCHED_REUSEPORT,
            'Bad cluster.schedulingPolicy: ' + schedulingPolicy);
     cluster.settings = settings;
 
@@ -285,6 +353,7 @@ function masterInit() {
     worker.process = fork(settings.exec, settings.args, {
       env: workerEnv,
       silent: settings.silent,
+      serialization: settings.serialization,
       execArgv: createWorkerExecArgv(settings.execArgv, worker)
     });
     worker.process.once('exit', function(exitCode, signalCode) {
@@ -389,6 +458,12 @@ function masterInit() {
           message.addressType === 'udp6') {
         constructor = SharedHandle;
       }
+      // Pipes and inherited file descriptors can't be rebound by the workers.
+      if (schedulingPolicy === SCHED_REUSEPORT &&
+          util.isNumber(message.port) && message.port >= 0 &&
+          !(message.fd >= 0)) {
+        constructor = ReusePortHandle;
+      }
       handles[key] = handle = new constructor(key,
                                               message.address,
                                               message.port,
@@ -418,12 +493,15 @@ function masterInit() {
       port: message.port,
       fd: message.fd
     };
+    // SO_REUSEPORT. The worker holds the port now, drop the placeholder.
+    var handle = handles[message.key];
+    if (handle instanceof ReusePortHandle) handle.release();
     worker.state = 'listening';
     worker.emit('listening', info);
     cluster.emit('listening', worker, info);
   }
 
-  // Round-robin only. Server in worker is closing, remove from list.
+  // Round-robin and SO_REUSEPORT. Server in worker is closing, remove it.
   function close(worker, message) {
     var key = message.key;
     var handle = handles[key];
@@ -478,7 +556,9 @@ function workerInit() {
     send(message, function(reply, handle) {
       if (obj._setServerData) obj._setServerData(reply.data);
 
-      if (handle)
+      if (reply.reuseport)
+        reuseport(reply, message, cb);  // Per-worker SO_REUSEPORT socket.
+      else if (handle)
         shared(reply, handle, cb);  // Shared listen socket.
       else
         rr(reply, cb);              // Round-robin.
@@ -507,6 +587,36 @@ function workerInit() {
     cb(message.errno, handle);
   }
 
+  // SO_REUSEPORT. Master reserved the port, worker binds its own socket.
+  function reuseport(message, query, cb) {
+    if (message.errno)
+      return cb(message.errno, null);
+
+    var key = message.key;
+    var handle = createReusePortHandle(query.address,
+                                       message.port,
+                                       query.addressType,
+                                       query.fd);
+    if (util.isNumber(handle)) {
+      send({ act: 'close', key: key });
+      return cb(handle, null);
+    }
+
+    var close = handle.close;
+    handle.close = function() {
+      if (!util.isUndefined(key)) {
+        send({ act: 'close', key: key });
+        delete handles[key];
+        key = undefined;
+      }
+      return close.apply(this, arguments);
+    };
+    assert(util.isUndefined(handles[key]));
+    handles[key] = handle;
+    query.key = key;  // Lets the master release its placeholder on 'listening'.
+    cb(0, handle);
+  }
+
   // Round-robin. Master distributes handles across workers.
   function rr(message, cb) {
     if (message.errno)
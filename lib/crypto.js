@@ -286,6 +286,15 @@ Cipher.prototype.update = function(data, inputEncoding, outputEncoding) {
 };
 
 
+// Encrypts `data` into `output` at `offset` and returns the number of bytes
+// written. Without `output` stream modes encrypt `data` in place.
+Cipher.prototype.updateInto = function(data, output, offset) {
+  if (util.isUndefined(output) || util.isNull(output))
+    output = data;
+  return this._binding.updateInto(data, output, offset || 0);
+};
+
+
 Cipher.prototype.final = function(outputEncoding) {
   outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
   var ret = this._binding.final();
@@ -322,6 +331,7 @@ util.inherits(Cipheriv, LazyTransform);
 Cipheriv.prototype._transform = Cipher.prototype._transform;
 Cipheriv.prototype._flush = Cipher.prototype._flush;
 Cipheriv.prototype.update = Cipher.prototype.update;
+Cipheriv.prototype.updateInto = Cipher.prototype.updateInto;
 Cipheriv.prototype.final = Cipher.prototype.final;
 Cipheriv.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
 
@@ -353,6 +363,7 @@ util.inherits(Decipher, LazyTransform);
 Decipher.prototype._transform = Cipher.prototype._transform;
 Decipher.prototype._flush = Cipher.prototype._flush;
 Decipher.prototype.update = Cipher.prototype.update;
+Decipher.prototype.updateInto = Cipher.prototype.updateInto;
 Decipher.prototype.final = Cipher.prototype.final;
 Decipher.prototype.finaltol = Cipher.prototype.final;
 Decipher.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
@@ -376,6 +387,7 @@ util.inherits(Decipheriv, LazyTransform);
 Decipheriv.prototype._transform = Cipher.prototype._transform;
 Decipheriv.prototype._flush = Cipher.prototype._flush;
 Decipheriv.prototype.update = Cipher.prototype.update;
+Decipheriv.prototype.updateInto = Cipher.prototype.updateInto;
 Decipheriv.prototype.final = Cipher.prototype.final;
 Decipheriv.prototype.finaltol = Cipher.prototype.final;
 Decipheriv.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
@@ -384,6 +396,47 @@ Decipheriv.prototype.setAuthTag = Cipheriv.prototype.setAuthTag;
 
 
 
+exports.createPrivateKey = function(options) {
+  if (!options)
+    throw new Error('No key provided');
+
+  var key = options.key || options;
+  var passphrase = options.passphrase || null;
+  return new KeyObject('private', key, passphrase);
+};
+
+
+exports.createPublicKey = function(key) {
+  if (!key)
+    throw new Error('No key provided');
+
+  return new KeyObject('public', key);
+};
+
+
+exports.KeyObject = KeyObject;
+function KeyObject(type, key, passphrase) {
+  if (type !== 'private' && type !== 'public')
+    throw new TypeError('Bad key type');
+
+  this._handle = new binding.KeyObject();
+  this._handle.init(toBuf(key), type === 'private', passphrase);
+  this.type = type;
+  this.asymmetricKeyType = this._handle.getKeyType();
+  this.size = this._handle.getKeySize();
+}
+
+
+// Returns what the native sign and verify functions accept as a key: the
+// parsed handle of a KeyObject or a buffer holding the PEM encoded key.
+function keyHandle(key) {
+  if (key instanceof KeyObject)
+    return key._handle;
+  return toBuf(key);
+}
+
+
+
 exports.createSign = exports.Sign = Sign;
 function Sign(algorithm, options) {
   if (!(this instanceof Sign))
@@ -409,7 +462,7 @@ Sign.prototype.sign = function(options, encoding) {
 
   var key = options.key || options;
   var passphrase = options.passphrase || null;
-  var ret = this._binding.sign(toBuf(key), null, passphrase);
+  var ret = this._binding.sign(keyHandle(key), null, passphrase);
 
   encoding = encoding || exports.DEFAULT_ENCODING;
   if (encoding && encoding !== 'buffer')
@@ -438,7 +491,34 @@ Verify.prototype.update = Sign.prototype.update;
 
 Verify.prototype.verify = function(object, signature, sigEncoding) {
   sigEncoding = sigEncoding || exports.DEFAULT_ENCODING;
-  return this._binding.verify(toBuf(object), toBuf(signature, sigEncoding));
+  return this._binding.verify(keyHandle(object),
+                              toBuf(signature, sigEncoding));
+};
+
+
+
+exports.sign = function(algorithm, data, options, encoding) {
+  if (!options)
+    throw new Error('No key provided to sign');
+
+  var key = options.key || options;
+  var passphrase = options.passphrase || null;
+  var ret = binding.sign(algorithm, toBuf(data), keyHandle(key), passphrase);
+
+  encoding = encoding || exports.DEFAULT_ENCODING;
+  if (encoding && encoding !== 'buffer')
+    ret = ret.toString(encoding);
+
+  return ret;
+};
+
+
+exports.verify = function(algorithm, data, object, signature, sigEncoding) {
+  sigEncoding = sigEncoding || exports.DEFAULT_ENCODING;
+  return binding.verify(algorithm,
+                        toBuf(data),
+                        keyHandle(object),
+                        toBuf(signature, sigEncoding));
 };
 
 
@@ -588,6 +668,53 @@ DiffieHellman.prototype.setPrivateKey = function(key, encoding) {
 
 
 
+exports.createECDH = function createECDH(curve) {
+  return new ECDH(curve);
+};
+
+function ECDH(curve) {
+  if (!util.isString(curve))
+    throw new TypeError('curve should be a string');
+
+  this._binding = new binding.ECDH(curve);
+}
+
+ECDH.prototype.computeSecret = DiffieHellman.prototype.computeSecret;
+ECDH.prototype.setPrivateKey = DiffieHellman.prototype.setPrivateKey;
+ECDH.prototype.setPublicKey = DiffieHellman.prototype.setPublicKey;
+ECDH.prototype.getPrivateKey = DiffieHellman.prototype.getPrivateKey;
+
+ECDH.prototype.generateKeys = function generateKeys(encoding, format) {
+  this._binding.generateKeys();
+
+  return this.getPublicKey(encoding, format);
+};
+
+ECDH.prototype.getPublicKey = function getPublicKey(encoding, format) {
+  var f;
+  if (format) {
+    if (format === 'compressed')
+      f = constants.POINT_CONVERSION_COMPRESSED;
+    else if (format === 'hybrid')
+      f = constants.POINT_CONVERSION_HYBRID;
+    // Default
+    else if (format === 'uncompressed')
+      f = constants.POINT_CONVERSION_UNCOMPRESSED;
+    else
+      throw new TypeError('Bad format: ' + format);
+  } else {
+    f = constants.POINT_CONVERSION_UNCOMPRESSED;
+  }
+  var key = this._binding.getPublicKey(f);
+
+  encoding = encoding || exports.DEFAULT_ENCODING;
+  if (encoding && encoding !== 'buffer')
+    key = key.toString(encoding);
+  return key;
+};
+
+
+
 exports.pbkdf2 = function(password,
                           salt,
                           iterations,
@@ -626,7 +753,7 @@ function pbkdf2(password, salt, iterations, keylen, digest, callback) {
         ret = ret.toString(encoding);
       callback(er, ret);
     }
-    binding.PBKDF2(password, salt, iterations, keylen, digest, next);
+    return binding.PBKDF2(password, salt, iterations, keylen, digest, next);
   } else {
     var ret = binding.PBKDF2(password, salt, iterations, keylen, digest);
     return ret.toString(encoding);
@@ -634,6 +761,158 @@ function pbkdf2(password, salt, iterations, keylen, digest, callback) {
 }
 
 
+var kScryptDefaults = { N: 16384, r: 8, p: 1, maxmem: 32 * 1024 * 1024 };
+
+exports.scrypt = function(password, salt, keylen, options, callback) {
+  if (util.isFunction(options)) {
+    callback = options;
+    options = undefined;
+  }
+
+  if (!util.isFunction(callback))
+    throw new Error('No callback provided to scrypt');
+
+  return scrypt(password, salt, keylen, options, callback);
+};
+
+
+exports.scryptSync = function(password, salt, keylen, options) {
+  return scrypt(password, salt, keylen, options);
+};
+
+
+function scrypt(password, salt, keylen, options, callback) {
+  options = options || {};
+  var N = util.isUndefined(options.N) ? kScryptDefaults.N : options.N;
+  var r = util.isUndefined(options.r) ? kScryptDefaults.r : options.r;
+  var p = util.isUndefined(options.p) ? kScryptDefaults.p : options.p;
+  var maxmem = util.isUndefined(options.maxmem) ? kScryptDefaults.maxmem
+                                                : options.maxmem;
+
+  if (!util.isNumber(maxmem) || maxmem < 0)
+    throw new TypeError('Bad maxmem');
+
+  password = toBuf(password);
+  salt = toBuf(salt);
+
+  var encoding = exports.DEFAULT_ENCODING;
+  if (callback) {
+    function next(er, ret) {
+      if (ret && encoding !== 'buffer')
+        ret = ret.toString(encoding);
+      callback(er, ret);
+    }
+    return binding.scrypt(password, salt, keylen, N, r, p, maxmem, next);
+  }
+
+  var ret = binding.scrypt(password, salt, keylen, N, r, p, maxmem);
+  if (encoding !== 'buffer')
+    ret = ret.toString(encoding);
+  return ret;
+}
+
+
+// Inputs larger than this are digested on the thread pool one chunk at a
+// time, a large buffer then doesn't hold a pool thread for its whole duration.
+var kHashChunkSize = 4 * 1024 * 1024;
+
+exports.hashAsync = function(algorithm, data, options, callback) {
+  if (util.isFunction(options)) {
+    callback = options;
+    options = undefined;
+  }
+  return hashAsync(algorithm, undefined, data, options, callback);
+};
+
+
+exports.hmacAsync = function(algorithm, key, data, options, callback) {
+  if (util.isFunction(options)) {
+    callback = options;
+    options = undefined;
+  }
+  return hashAsync(algorithm, toBuf(key), data, options, callback);
+};
+
+
+function hashAsync(algorithm, key, data, options, callback) {
+  if (!util.isFunction(callback))
+    throw new Error('No callback provided');
+
+  options = options || {};
+  var chunkSize = kHashChunkSize;
+  if (!util.isUndefined(options.chunkSize))
+    chunkSize = options.chunkSize;
+  var encoding = options.encoding || exports.DEFAULT_ENCODING;
+
+  function next(er, ret) {
+    if (ret && encoding !== 'buffer')
+      ret = ret.toString(encoding);
+    callback(er, ret);
+  }
+  binding.hashAsync(algorithm, toBuf(data), chunkSize, next, key);
+}
+
+
+// Digests many inputs in one native call. `inputs` is an array of buffers
+// or strings, or one buffer cut up by `options.offsets`.
+exports.hashBatch = function(algorithm, inputs, options, callback) {
+  if (util.isFunction(options)) {
+    callback = options;
+    options = undefined;
+  }
+
+  options = options || {};
+  var encoding = options.encoding || exports.DEFAULT_ENCODING;
+  var offsets = null;
+  var count;
+
+  if (util.isArray(inputs)) {
+    inputs = inputs.map(function(input) {
+      return toBuf(input);
+    });
+    count = inputs.length;
+  } else if (util.isBuffer(inputs)) {
+    offsets = options.offsets;
+    if (!offsets || !util.isNumber(offsets.length))
+      throw new TypeError('offsets are required with a single buffer');
+    count = Math.max(offsets.length - 1, 0);
+  } else {
+    throw new TypeError('inputs must be an array or a buffer');
+  }
+
+  function split(digests) {
+    var size = count > 0 ? digests.length / count : 0;
+    var ret = new Array(count);
+    for (var i = 0; i < count; i++) {
+      var digest = digests.slice(i * size, (i + 1) * size);
+      ret[i] = encoding === 'buffer' ? digest : digest.toString(encoding);
+    }
+    return ret;
+  }
+
+  if (!callback)
+    return split(binding.hashBatch(algorithm, inputs, offsets));
+
+  if (!util.isFunction(callback))
+    throw new TypeError('callback must be a function');
+
+  if (count === 0) {
+    // Still validates the algorithm
+    binding.hashBatch(algorithm, inputs, offsets);
+    process.nextTick(function() {
+      callback(null, []);
+    });
+    return;
+  }
+
+  binding.hashBatch(algorithm, inputs, offsets, function(er, digests) {
+    if (er)
+      return callback(er);
+    callback(null, split(digests));
+  });
+};
+
+
 exports.Certificate = Certificate;
 
 function Certificate() {
@@ -674,11 +953,35 @@ exports.setEngine = function setEngine(id, flags) {
   return binding.setEngine(id, flags);
 };
 
-exports.randomBytes = randomBytes;
-exports.pseudoRandomBytes = pseudoRandomBytes;
+// Small asynchronous requests are served from bytes generated ahead of time
+// on the thread pool, instead of queueing one pool job each. The pool is
+// created on first use so that merely loading crypto doesn't start the
+// thread pool or draw entropy.
+var randomPool = null;
+
+function pooled(fn) {
+  return function(size, callback) {
+    if (util.isFunction(callback)) {
+      if (randomPool === null)
+        randomPool = new binding.RandomPool();
+      var buf = randomPool.take(size);
+      if (buf) {
+        process.nextTick(function() {
+          callback(null, buf);
+        });
+        return;
+      }
+    }
+    return fn(size, callback);
+  };
+}
+
+exports.randomBytes = pooled(randomBytes);
+// Strong random bytes are fine where pseudo random ones are asked for
+exports.pseudoRandomBytes = pooled(pseudoRandomBytes);
 
-exports.rng = randomBytes;
-exports.prng = pseudoRandomBytes;
+exports.rng = exports.randomBytes;
+exports.prng = exports.pseudoRandomBytes;
 
 
 exports.getCiphers = function() {
@@ -24,6 +24,7 @@ var util = require('util');
 var events = require('events');
 
 var UDP = process.binding('udp_wrap').UDP;
+var uv = process.binding('uv');
 
 var BIND_STATE_UNBOUND = 0;
 var BIND_STATE_BINDING = 1;
@@ -75,14 +76,14 @@ function newHandle(type) {
 }
 
 
-exports._createSocketHandle = function(address, port, addressType, fd) {
+exports._createSocketHandle = function(address, port, addressType, fd, flags) {
   // Opening an existing fd is not supported for UDP handles.
   assert(!util.isNumber(fd) || fd < 0);
 
   var handle = newHandle(addressType);
 
   if (port || address) {
-    var err = handle.bind(address, port || 0, 0);
+    var err = handle.bind(address, port || 0, flags | 0);
     if (err) {
       handle.close();
       return err;
@@ -101,6 +102,8 @@ function Socket(type, listener) {
 
   this._handle = handle;
   this._receiving = false;
+  this._batchReceive = false;
+  this._batchDelivery = false;
   this._bindState = BIND_STATE_UNBOUND;
   this.type = type;
   this.fd = null; // compatibility hack
@@ -119,6 +122,12 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onbatch = onBatch;
+  // The handle may have been replaced by one from the cluster master.
+  if (socket._batchReceive)
+    socket._handle.setRecvmmsg(1);
+  if (socket._batchDelivery)
+    socket._handle.setBatchDelivery(true);
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -353,6 +362,30 @@ Socket.prototype.setBroadcast = function(arg) {
 };
 
 
+// Silently ignored where recvmmsg() isn't available, the socket keeps
+// reading one datagram at a time.
+Socket.prototype.setBatchReceive = function(arg) {
+  this._healthCheck();
+  this._batchReceive = !!arg;
+
+  var err = this._handle.setRecvmmsg(arg ? 1 : 0);
+  if (err && err !== uv.UV_ENOSYS) {
+    throw errnoException(err, 'setBatchReceive');
+  }
+};
+
+
+// Emit 'batch' events instead of a 'message' per datagram. Implies batched
+// receives, see setBatchReceive().
+Socket.prototype.setBatchDelivery = function(arg) {
+  this._healthCheck();
+  this._batchDelivery = !!arg;
+  this._handle.setBatchDelivery(this._batchDelivery);
+  if (this._batchDelivery)
+    this.setBatchReceive(true);
+};
+
+
 Socket.prototype.setTTL = function(arg) {
   if (!util.isNumber(arg)) {
     throw new TypeError('Argument must be a number');
@@ -447,6 +480,12 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+function onBatch(count, handle, buf, entries, addresses) {
+  var self = handle.owner;
+  self.emit('batch', buf, entries, addresses);
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
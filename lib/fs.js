@@ -38,6 +38,8 @@ var Readable = Stream.Readable;
 var Writable = Stream.Writable;
 
 var kMinPoolSpace = 128;
+var kSendfileChunk = 0x40000000;  // 1 GB, the binding takes an uint32.
+var kSendfileSpill = 16 * 1024;
 var kMaxLength = require('smalloc').kMaxLength;
 
 var O_APPEND = constants.O_APPEND || 0;
@@ -465,6 +467,16 @@ fs.readSync = function(fd, buffer, offset, length, position) {
   return [str, r];
 };
 
+fs.sendfile = function(outFd, inFd, offset, length, callback) {
+  binding.sendfile(outFd, inFd, offset, length, function(err, bytesSent) {
+    callback && callback(err, bytesSent || 0);
+  });
+};
+
+fs.sendfileSync = function(outFd, inFd, offset, length) {
+  return binding.sendfile(outFd, inFd, offset, length);
+};
+
 // usage:
 //  fs.write(fd, buffer, offset, length[, position], callback);
 // OR
@@ -1489,7 +1501,7 @@ ReadStream.prototype._read = function(n) {
       this._read(n);
     });
 
-  if (this.destroyed)
+  if (this.destroyed || this._sendfile)
     return;
 
   if (!pool || pool.length - pool.used < kMinPoolSpace) {
@@ -1539,6 +1551,220 @@ ReadStream.prototype._read = function(n) {
 };
 
 
+// Piping into a plain TCP or pipe socket lets the kernel copy the file
+// with sendfile() rather than reading it into JS buffers first.
+ReadStream.prototype.pipe = function(dest, options) {
+  if (!canSendfile(this, dest))
+    return Readable.prototype.pipe.call(this, dest, options);
+
+  // The transfer writes to its own duplicate of the socket's fd. When the
+  // socket is destroyed while a request is in the thread pool, its fd number
+  // can be reused by a new connection; the duplicate still refers to this one.
+  var outFd;
+  try {
+    outFd = binding.dup(dest._handle.fd);
+  } catch (er) {
+    return Readable.prototype.pipe.call(this, dest, options);
+  }
+
+  this._sendfile = true;
+  dest.emit('pipe', this);
+  sendfileToSocket(this, dest, outFd, !options || options.end !== false);
+  return dest;
+};
+
+function canSendfile(src, dest) {
+  if (isWindows)
+    return false;
+
+  // The whole file has to go out as raw bytes, untouched by JS. A stream
+  // on a caller supplied fd without `start` reads from the current file
+  // position, which sendfile() can't do.
+  var state = src._readableState;
+  if (state.flowing ||
+      state.reading ||
+      state.ended ||
+      state.length > 0 ||
+      state.pipesCount > 0 ||
+      state.decoder ||
+      src.listeners('data').length > 0 ||
+      util.isNumber(src.fd) && util.isUndefined(src.pos)) {
+    return false;
+  }
+
+  // TLS sockets encrypt in user space, their handle has no fd.
+  var net = require('net');
+  return dest instanceof net.Socket &&
+         !dest._connecting &&
+         !dest.destroyed &&
+         dest.writable &&
+         dest._handle &&
+         util.isNumber(dest._handle.fd) &&
+         dest._handle.fd >= 0;
+}
+
+function sendfileToSocket(src, dest, outFd, end) {
+  var timers = require('timers');
+  var write = dest.write;
+  var endWrite = dest.end;
+  var queue = [];
+  var stopped = false;
+  var busy = false;
+  var pos, last;
+
+  dest.once('close', stop);
+
+  // Let anything already queued on the socket go out first.
+  write.call(dest, new Buffer(0), start);
+
+  // Anything written to the socket from now on would end up in the middle
+  // of the file. Hold it back until the file has been sent.
+  dest.write = function() {
+    queue.push({ method: write, args: arguments });
+    this._writableState.needDrain = true;
+    return false;
+  };
+  dest.end = function() {
+    queue.push({ method: endWrite, args: arguments });
+  };
+
+  function start() {
+    if (!util.isNumber(src.fd))
+      return src.once('open', start);
+
+    pos = util.isUndefined(src.pos) ? 0 : src.pos;
+    last = util.isUndefined(src.end) ? Infinity : src.end;
+    send();
+  }
+
+  function send() {
+    if (stopped)
+      return;
+
+    if (dest.destroyed)
+      return stop();
+
+    var length = Math.min(last - pos + 1, kSendfileChunk);
+    if (length <= 0)
+      return finish();
+
+    busy = true;
+    fs.sendfile(outFd, src.fd, pos, length, onsend);
+  }
+
+  function onsend(er, bytesSent) {
+    busy = false;
+    if (stopped)
+      return release();
+
+    if (dest.destroyed)
+      return stop();
+
+    // The socket is non-blocking. Push a small chunk through the regular
+    // write path, its callback tells us when there is room again.
+    if (er && er.code === 'EAGAIN')
+      return spill();
+
+    if (er)
+      return fail(er);
+
+    if (bytesSent === 0)
+      return finish();
+
+    advance(bytesSent);
+    dest._bytesDispatched += bytesSent;
+    timers._unrefActive(dest);
+    send();
+  }
+
+  function spill() {
+    var length = Math.min(last - pos + 1, kSendfileSpill);
+    var buffer = new Buffer(length);
+    busy = true;
+    fs.read(src.fd, buffer, 0, length, pos, function(er, bytesRead) {
+      busy = false;
+      if (stopped)
+        return release();
+      if (dest.destroyed)
+        return stop();
+      if (er)
+        return fail(er);
+      if (bytesRead === 0)
+        return finish();
+      advance(bytesRead);
+      write.call(dest, buffer.slice(0, bytesRead), send);
+    });
+  }
+
+  function advance(bytes) {
+    pos += bytes;
+    if (!util.isUndefined(src.pos))
+      src.pos = pos;
+  }
+
+  function finish() {
+    stopped = true;
+    dest.removeListener('close', stop);
+    closeOut();
+    flush();
+    var state = src._readableState;
+    state.ended = true;
+    state.endEmitted = true;
+    src.readable = false;
+    src.emit('end');
+    if (end)
+      dest.end();
+  }
+
+  function fail(er) {
+    stopped = true;
+    dest.removeListener('close', stop);
+    release();
+    flush();
+    // Write errors belong to the socket, read errors to the file.
+    if (er.code === 'EPIPE' || er.code === 'ECONNRESET')
+      dest.destroy(er);
+    else
+      src.emit('error', er);
+  }
+
+  // The socket went away. Don't close the files under a pending request.
+  function stop() {
+    if (stopped)
+      return;
+    stopped = true;
+    dest.removeListener('close', stop);
+    flush();
+    if (!busy)
+      release();
+  }
+
+  function release() {
+    closeOut();
+    if (src.autoClose)
+      src.destroy();
+  }
+
+  function closeOut() {
+    if (outFd === -1)
+      return;
+    fs.close(outFd, function() {});
+    outFd = -1;
+  }
+
+  // Hand the held back writes to the socket, in order.
+  function flush() {
+    delete dest.write;
+    delete dest.end;
+    var pending = queue;
+    queue = [];
+    pending.forEach(function(op) {
+      op.method.apply(dest, op.args);
+    });
+  }
+}
+
+
 ReadStream.prototype.destroy = function() {
   if (this.destroyed)
     return;
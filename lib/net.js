@@ -1052,7 +1052,7 @@ function _listen(handle, backlog) {
 }
 
 var createServerHandle = exports._createServerHandle =
-    function(address, port, addressType, fd) {
+    function(address, port, addressType, fd, flags) {
   var err = 0;
   // assign handle in listen, and clean up if bind or listen fails
   var handle;
@@ -1085,9 +1085,9 @@ var createServerHandle = exports._createServerHandle =
   if (address || port) {
     debug('bind to ' + address);
     if (addressType === 6) {
-      err = handle.bind6(address, port);
+      err = handle.bind6(address, port, flags | 0);
     } else {
-      err = handle.bind(address, port);
+      err = handle.bind(address, port, flags | 0);
     }
   }
 
@@ -156,6 +156,11 @@ function listOnTimeout() {
 var unenroll = exports.unenroll = function(item) {
   L.remove(item);
 
+  if (item._unrefTimer) {
+    item._unrefTimer.close();
+    item._unrefTimer = null;
+  }
+
   var list = lists[item._idleTimeout];
   // if empty then stop the watcher
   debug('unenroll');
@@ -171,9 +176,9 @@ var unenroll = exports.unenroll = function(item) {
 
 // Does not start the time, just sets up the members needed.
 exports.enroll = function(item, msecs) {
-  // if this item was already in a list somewhere
-  // then we should unenroll it from that
-  if (item._idleNext) unenroll(item);
+  // if this item was already in a list somewhere, or has its own timer
+  // (see _unrefActive), then we should unenroll it from that
+  if (item._idleNext || item._unrefTimer) unenroll(item);
 
   // Ensure that msecs fits into signed int32
   if (msecs > 0x7fffffff) {
@@ -508,6 +513,34 @@ function unrefTimeout() {
 }
 
 
+// With --timer-wheel, libuv inserts and cancels timers in constant time.
+// Instead of keeping a sorted list that has to be walked on every reset,
+// each item then gets its own unref'd timer that is simply restarted.
+function unrefItemTimeout() {
+  var item = this._item;
+
+  debug('unref item timer fired');
+
+  this.close();
+  item._unrefTimer = null;
+
+  var domain = item.domain;
+
+  if (!item._onTimeout) return;
+  if (domain && domain._disposed) return;
+  var hasQueue = !!item._asyncQueue;
+
+  if (hasQueue)
+    loadAsyncQueue(item);
+  if (domain) domain.enter();
+  item._onTimeout();
+  if (domain)
+    domain.exit();
+  if (hasQueue)
+    unloadAsyncQueue(item);
+}
+
+
 exports._unrefActive = function(item) {
   var msecs = item._idleTimeout;
   if (!msecs || msecs < 0) return;
@@ -515,6 +548,19 @@ exports._unrefActive = function(item) {
 
   L.remove(item);
 
+  if (process._timerWheel) {
+    var timer = item._unrefTimer;
+    if (!timer) {
+      timer = item._unrefTimer = new Timer();
+      timer.unref();
+      timer._item = item;
+      timer[kOnTimeout] = unrefItemTimeout;
+    }
+    item._idleStart = Timer.now();
+    timer.start(msecs, 0);
+    return;
+  }
+
   if (!unrefList) {
     debug('unrefList initialized');
     unrefList = {};
@@ -49,6 +49,14 @@ exports.getCiphers = function() {
   return Object.getOwnPropertyNames(ctx).sort();
 };
 
+// Remove the shared memory segment behind the `sharedSessionCache` server
+// option. Returns false if there was none.
+exports.unlinkSharedSessionCache = function(name) {
+  if (!util.isString(name) || /\//.test(name))
+    throw new TypeError('name must be a string without slashes');
+  return process.binding('crypto').unlinkSharedSessionCache(name);
+};
+
 // Convert protocols array into valid OpenSSL protocols list
 // ("\x06spdy/2\x08http/1.1\x08http/1.0")
 exports.convertNPNProtocols = function convertNPNProtocols(NPNProtocols, out) {
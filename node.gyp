@@ -87,6 +87,7 @@
       'sources': [
         'src/fs_event_wrap.cc',
         'src/cares_wrap.cc',
+        'src/chunk_freelist.cc',
         'src/handle_wrap.cc',
         'src/node.cc',
         'src/node_buffer.cc',
@@ -103,9 +104,11 @@
         'src/node_zlib.cc',
         'src/pipe_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/smalloc.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
+        'src/string_bytes_simd.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
         'src/timer_wrap.cc',
@@ -118,6 +121,7 @@
         'src/async-wrap-inl.h',
         'src/base-object.h',
         'src/base-object-inl.h',
+        'src/chunk_freelist.h',
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
@@ -135,12 +139,14 @@
         'src/node_wrap.h',
         'src/pipe_wrap.h',
         'src/queue.h',
+        'src/slab_allocator.h',
         'src/smalloc.h',
         'src/tty_wrap.h',
         'src/tcp_wrap.h',
         'src/udp_wrap.h',
         'src/req_wrap.h',
         'src/string_bytes.h',
+        'src/string_bytes_simd.h',
         'src/stream_wrap.h',
         'src/tree.h',
         'src/util.h',
@@ -167,9 +173,11 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_session_cache.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/node_crypto_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
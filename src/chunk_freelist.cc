@@ -0,0 +1,111 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "chunk_freelist.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdlib.h>  // malloc(), free()
+
+namespace node {
+
+ChunkFreeList::ChunkFreeList(size_t limit) : limit_(limit), cached_(0) {
+  for (int i = 0; i < kSizeCount; i++) {
+    lists_[i].size = 0;
+    lists_[i].head = NULL;
+  }
+}
+
+
+ChunkFreeList::~ChunkFreeList() {
+  for (int i = 0; i < kSizeCount; i++) {
+    Chunk* chunk = lists_[i].head;
+    while (chunk != NULL) {
+      Chunk* next = chunk->next;
+      free(chunk);
+      chunk = next;
+    }
+    lists_[i].head = NULL;
+  }
+  cached_ = 0;
+}
+
+
+ChunkFreeList::List* ChunkFreeList::ListFor(size_t size, bool create) {
+  for (int i = 0; i < kSizeCount; i++) {
+    if (lists_[i].size == size)
+      return &lists_[i];
+  }
+
+  if (!create)
+    return NULL;
+
+  // Claim a slot that was never used, or one that has run empty
+  for (int i = 0; i < kSizeCount; i++) {
+    if (lists_[i].head == NULL) {
+      lists_[i].size = size;
+      return &lists_[i];
+    }
+  }
+
+  return NULL;
+}
+
+
+char* ChunkFreeList::Allocate(size_t size) {
+  assert(size >= sizeof(Chunk));
+
+  List* list = ListFor(size, false);
+  if (list != NULL && list->head != NULL) {
+    Chunk* chunk = list->head;
+    list->head = chunk->next;
+    cached_ -= size;
+    return reinterpret_cast<char*>(chunk);
+  }
+
+  char* data = static_cast<char*>(malloc(size));
+  if (data == NULL)
+    FatalError("node::ChunkFreeList::Allocate(size_t)", "Out Of Memory");
+  return data;
+}
+
+
+void ChunkFreeList::Release(char* data, size_t size) {
+  if (data == NULL)
+    return;
+
+  List* list = NULL;
+  if (cached_ + size <= limit_)
+    list = ListFor(size, true);
+
+  if (list == NULL) {
+    free(data);
+    return;
+  }
+
+  Chunk* chunk = reinterpret_cast<Chunk*>(data);
+  chunk->next = list->head;
+  list->head = chunk;
+  cached_ += size;
+}
+
+}  // namespace node
@@ -0,0 +1,77 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_CHUNK_FREELIST_H_
+#define SRC_CHUNK_FREELIST_H_
+
+#include "util.h"
+
+#include <stddef.h>
+
+namespace node {
+
+// Keeps freed fixed-size chunks around so that the next user of the same size
+// gets one without going through malloc(). Meant for short-lived connections
+// that repeatedly buffer a few kilobytes, e.g. NodeBIO's TLS record buffers.
+//
+// A handful of distinct sizes are cached, each on its own singly linked list
+// threaded through the free chunks themselves. Chunks of other sizes, and
+// chunks released while `limit` bytes are already cached, are freed.
+//
+// Not thread-safe, chunks must only be allocated and released on the event
+// loop thread.
+class ChunkFreeList {
+ public:
+  static const size_t kDefaultLimit = 1024 * 1024;
+
+  explicit ChunkFreeList(size_t limit = kDefaultLimit);
+  ~ChunkFreeList();
+
+  // Return a chunk of `size` bytes. Never returns NULL, aborts on OOM.
+  char* Allocate(size_t size);
+
+  // Take back a chunk returned by Allocate(), `size` must match.
+  void Release(char* data, size_t size);
+
+ private:
+  static const int kSizeCount = 4;
+
+  struct Chunk {
+    Chunk* next;
+  };
+
+  struct List {
+    size_t size;
+    Chunk* head;
+  };
+
+  List* ListFor(size_t size, bool create);
+
+  const size_t limit_;
+  size_t cached_;
+  List lists_[kSizeCount];
+
+  DISALLOW_COPY_AND_ASSIGN(ChunkFreeList);
+};
+
+}  // namespace node
+
+#endif  // SRC_CHUNK_FREELIST_H_
@@ -316,6 +316,14 @@ inline Environment::TickInfo* Environment::tick_info() {
   return &tick_info_;
 }
 
+inline SlabAllocator* Environment::slab_allocator() {
+  return &slab_allocator_;
+}
+
+inline ChunkFreeList* Environment::chunk_freelist() {
+  return &chunk_freelist_;
+}
+
 inline bool Environment::using_smalloc_alloc_cb() const {
   return using_smalloc_alloc_cb_;
 }
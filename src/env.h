@@ -23,6 +23,8 @@
 #define SRC_ENV_H_
 
 #include "ares.h"
+#include "chunk_freelist.h"
+#include "slab_allocator.h"
 #include "tree.h"
 #include "util.h"
 #include "uv.h"
@@ -49,6 +51,41 @@ namespace node {
 #define NODE_CONTEXT_EMBEDDER_DATA_INDEX 32
 #endif
 
+// Well-known HTTP header names. The http_parser binding hands these out
+// instead of creating a new string when a header name matches exactly.
+#define PER_ISOLATE_HTTP_HEADER_STRINGS(V)                                    \
+  V(http_accept_string, "Accept")                                             \
+  V(http_accept_charset_string, "Accept-Charset")                             \
+  V(http_accept_encoding_string, "Accept-Encoding")                           \
+  V(http_accept_language_string, "Accept-Language")                           \
+  V(http_authorization_string, "Authorization")                               \
+  V(http_cache_control_string, "Cache-Control")                               \
+  V(http_connection_string, "Connection")                                     \
+  V(http_content_encoding_string, "Content-Encoding")                         \
+  V(http_content_length_string, "Content-Length")                             \
+  V(http_content_type_string, "Content-Type")                                 \
+  V(http_cookie_string, "Cookie")                                             \
+  V(http_date_string, "Date")                                                 \
+  V(http_etag_string, "ETag")                                                 \
+  V(http_expires_string, "Expires")                                           \
+  V(http_host_string, "Host")                                                 \
+  V(http_if_modified_since_string, "If-Modified-Since")                       \
+  V(http_if_none_match_string, "If-None-Match")                               \
+  V(http_last_modified_string, "Last-Modified")                               \
+  V(http_location_string, "Location")                                         \
+  V(http_origin_string, "Origin")                                             \
+  V(http_pragma_string, "Pragma")                                             \
+  V(http_referer_string, "Referer")                                           \
+  V(http_server_string, "Server")                                             \
+  V(http_set_cookie_string, "Set-Cookie")                                     \
+  V(http_transfer_encoding_string, "Transfer-Encoding")                       \
+  V(http_user_agent_string, "User-Agent")                                     \
+  V(http_vary_string, "Vary")                                                 \
+  V(http_via_string, "Via")                                                   \
+  V(http_x_forwarded_for_string, "X-Forwarded-For")                           \
+  V(http_x_forwarded_proto_string, "X-Forwarded-Proto")                       \
+  V(http_x_requested_with_string, "X-Requested-With")                         \
+
 // Strings are per-isolate primitives but Environment proxies them
 // for the sake of convenience.
 #define PER_ISOLATE_STRING_PROPERTIES(V)                                      \
@@ -104,6 +141,7 @@ namespace node {
   V(fsevent_string, "FSEvent")                                                \
   V(gid_string, "gid")                                                        \
   V(handle_string, "handle")                                                  \
+  V(header_table_string, "headerTable")                                       \
   V(headers_string, "headers")                                                \
   V(heap_size_limit_string, "heap_size_limit")                                \
   V(heap_total_string, "heapTotal")                                           \
@@ -120,6 +158,7 @@ namespace node {
   V(ipv6_string, "IPv6")                                                      \
   V(issuer_string, "issuer")                                                  \
   V(kill_signal_string, "killSignal")                                         \
+  V(length_string, "length")                                                  \
   V(mac_string, "mac")                                                        \
   V(mark_sweep_compact_string, "mark-sweep-compact")                          \
   V(max_buffer_string, "maxBuffer")                                           \
@@ -137,6 +176,7 @@ namespace node {
   V(nlink_string, "nlink")                                                    \
   V(nsname_string, "nsname")                                                  \
   V(offset_string, "offset")                                                  \
+  V(onbatch_string, "onbatch")                                                \
   V(onchange_string, "onchange")                                              \
   V(onclienthello_string, "onclienthello")                                    \
   V(oncomplete_string, "oncomplete")                                          \
@@ -210,6 +250,7 @@ namespace node {
   V(tls_sni_string, "tls_sni")                                                \
   V(tls_string, "tls")                                                        \
   V(tls_ticket_string, "tlsTicket")                                           \
+  V(to_json_string, "toJSON")                                                 \
   V(total_heap_size_executable_string, "total_heap_size_executable")          \
   V(total_heap_size_string, "total_heap_size")                                \
   V(total_physical_size_string, "total_physical_size")                        \
@@ -234,6 +275,7 @@ namespace node {
   V(write_queue_size_string, "writeQueueSize")                                \
   V(x_forwarded_string, "x-forwarded-for")                                    \
   V(zero_return_string, "ZERO_RETURN")                                        \
+  PER_ISOLATE_HTTP_HEADER_STRINGS(V)                                          \
 
 #define ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)                           \
   V(async_listener_run_function, v8::Function)                                \
@@ -244,6 +286,8 @@ namespace node {
   V(context, v8::Context)                                                     \
   V(domain_array, v8::Array)                                                  \
   V(gc_info_callback_function, v8::Function)                                  \
+  V(kdf_request_constructor_function, v8::Function)                           \
+  V(key_object_constructor_template, v8::FunctionTemplate)                    \
   V(module_load_list_array, v8::Array)                                        \
   V(pipe_constructor_template, v8::FunctionTemplate)                          \
   V(process_object, v8::Object)                                               \
@@ -382,6 +426,9 @@ class Environment {
   inline ares_channel* cares_channel_ptr();
   inline ares_task_list* cares_task_list();
 
+  inline SlabAllocator* slab_allocator();
+  inline ChunkFreeList* chunk_freelist();
+
   inline bool using_smalloc_alloc_cb() const;
   inline void set_using_smalloc_alloc_cb(bool value);
 
@@ -446,6 +493,8 @@ class Environment {
   uv_timer_t cares_timer_handle_;
   ares_channel cares_channel_;
   ares_task_list cares_task_list_;
+  SlabAllocator slab_allocator_;
+  ChunkFreeList chunk_freelist_;
   bool using_smalloc_alloc_cb_;
   bool using_domains_;
   QUEUE gc_tracker_queue_;
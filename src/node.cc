@@ -125,6 +125,7 @@ static bool print_eval = false;
 static bool force_repl = false;
 static bool trace_deprecation = false;
 static bool throw_deprecation = false;
+static bool timer_wheel = false;
 static const char* eval_string = NULL;
 static bool use_debug_agent = false;
 static bool debug_wait_connect = false;
@@ -2658,6 +2659,11 @@ void SetupProcessObject(Environment* env,
     READONLY_PROPERTY(process, "traceDeprecation", True(env->isolate()));
   }
 
+  // --timer-wheel
+  if (timer_wheel) {
+    READONLY_PROPERTY(process, "_timerWheel", True(env->isolate()));
+  }
+
   size_t exec_path_len = 2 * PATH_MAX;
   char* exec_path = new char[exec_path_len];
   Local<String> exec_path_value;
@@ -2873,6 +2879,8 @@ static void PrintHelp() {
          "                       does not appear to be a terminal\n"
          "  --no-deprecation     silence deprecation warnings\n"
          "  --trace-deprecation  show stack traces on deprecations\n"
+         "  --timer-wheel        use a timer wheel instead of a binary heap\n"
+         "                       for timers, faster with many idle timeouts\n"
          "  --v8-options         print v8 command line options\n"
          "  --max-stack-size=val set max v8 stack size (bytes)\n"
          "\n"
@@ -2973,6 +2981,8 @@ static void ParseArgs(int* argc,
       trace_deprecation = true;
     } else if (strcmp(arg, "--throw-deprecation") == 0) {
       throw_deprecation = true;
+    } else if (strcmp(arg, "--timer-wheel") == 0) {
+      timer_wheel = true;
     } else if (strcmp(arg, "--v8-options") == 0) {
       new_v8_argv[new_v8_argc] = "--help";
       new_v8_argc += 1;
@@ -3331,6 +3341,12 @@ void Init(int* argc,
     exit(9);
   }
 
+  // The timer backend can only be switched while no timers are running,
+  // which is still the case at this point.  Not all platforms support it.
+  if (timer_wheel && uv_loop_set_timer_wheel(uv_default_loop(), 1) != 0) {
+    timer_wheel = false;
+  }
+
   if (debug_wait_connect) {
     const char expose_debug_as[] = "--expose_debug_as=v8debug";
     V8::SetFlagsFromString(expose_debug_as, sizeof(expose_debug_as) - 1);
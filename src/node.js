@@ -683,6 +683,9 @@
       // Make sure it's not accidentally inherited by child processes.
       delete process.env.NODE_CHANNEL_FD;
 
+      var serialization = process.env.NODE_CHANNEL_SERIALIZATION;
+      delete process.env.NODE_CHANNEL_SERIALIZATION;
+
       var cp = NativeModule.require('child_process');
 
       // Load tcp_wrap to avoid situation where we might immediately receive
@@ -690,7 +693,7 @@
       // FIXME is this really necessary?
       process.binding('tcp_wrap');
 
-      cp._forkChild(fd);
+      cp._forkChild(fd, serialization);
       assert(process.send);
     }
   };
@@ -946,6 +946,12 @@ void DefineOpenSSLConstants(Handle<Object> target) {
     NODE_DEFINE_CONSTANT(target, DH_NOT_SUITABLE_GENERATOR);
 #endif
 
+#ifndef OPENSSL_NO_EC
+    NODE_DEFINE_CONSTANT(target, POINT_CONVERSION_COMPRESSED);
+    NODE_DEFINE_CONSTANT(target, POINT_CONVERSION_UNCOMPRESSED);
+    NODE_DEFINE_CONSTANT(target, POINT_CONVERSION_HYBRID);
+#endif  // !OPENSSL_NO_EC
+
 #ifdef OPENSSL_NPN_NEGOTIATED
 #define NPN_ENABLED 1
     NODE_DEFINE_CONSTANT(target, NPN_ENABLED);
@@ -1002,6 +1008,10 @@ void DefineSystemConstants(Handle<Object> target) {
   NODE_DEFINE_CONSTANT(target, O_DIRECTORY);
 #endif
 
+#ifdef O_NONBLOCK
+  NODE_DEFINE_CONSTANT(target, O_NONBLOCK);
+#endif
+
 #ifdef O_EXCL
   NODE_DEFINE_CONSTANT(target, O_EXCL);
 #endif
@@ -24,6 +24,7 @@
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
 #include "node_crypto_groups.h"
+#include "node_crypto_session_cache.h"
 #include "tls_wrap.h"  // TLSCallbacks
 
 #include "async-wrap.h"
@@ -86,6 +87,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::Persistent;
 using v8::PropertyAttribute;
@@ -247,6 +249,15 @@ void SecureContext::Initialize(Environment* env, Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "loadPKCS12", SecureContext::LoadPKCS12);
   NODE_SET_PROTOTYPE_METHOD(t, "getTicketKeys", SecureContext::GetTicketKeys);
   NODE_SET_PROTOTYPE_METHOD(t, "setTicketKeys", SecureContext::SetTicketKeys);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "setSessionCache",
+                            SecureContext::SetSessionCache);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "setSharedSessionCache",
+                            SecureContext::SetSharedSessionCache);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "getSessionCacheStats",
+                            SecureContext::GetSessionCacheStats);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SecureContext"),
               t->GetFunction());
@@ -856,6 +867,97 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Turns on OpenSSL's internal server session cache, holding up to `size`
+// sessions for the context's session timeout. Resumptions that hit it are
+// handled without a round trip to JS. A size of zero turns it off again.
+void SecureContext::SetSessionCache(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(args.GetIsolate());
+  SecureContext* sc = Unwrap<SecureContext>(args.This());
+
+  if (args.Length() != 1 || !args[0]->IsUint32())
+    return sc->env()->ThrowTypeError("Bad parameter");
+
+  uint32_t size = args[0]->Uint32Value();
+  if (size == 0) {
+    SSL_CTX_set_session_cache_mode(sc->ctx_,
+                                   SSL_SESS_CACHE_SERVER |
+                                   SSL_SESS_CACHE_NO_INTERNAL |
+                                   SSL_SESS_CACHE_NO_AUTO_CLEAR);
+    return;
+  }
+
+  // Let OpenSSL flush expired sessions now and then.
+  SSL_CTX_set_session_cache_mode(sc->ctx_, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size(sc->ctx_, size);
+}
+
+
+// Backs the context's server sessions with the shared memory segment
+// `name`, which other processes can open too. Looked up after the internal
+// cache and before the `resumeSession` event.
+void SecureContext::SetSharedSessionCache(
+    const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(args.GetIsolate());
+  SecureContext* sc = Unwrap<SecureContext>(args.This());
+  Environment* env = sc->env();
+
+  if (args.Length() != 2 || !args[0]->IsString() || !args[1]->IsUint32())
+    return env->ThrowTypeError("Bad parameter");
+
+  const String::Utf8Value name(args[0]);
+  int err;
+  const char* syscall;
+  SharedSessionCache* cache =
+      SharedSessionCache::Open(*name, args[1]->Uint32Value(), &err, &syscall);
+  if (cache == NULL)
+    return env->ThrowErrnoException(err, syscall, NULL, *name);
+
+  if (!SharedSessionCache::Attach(sc->ctx_, cache)) {
+    delete cache;
+    return env->ThrowError("SSL_CTX_set_ex_data failed");
+  }
+}
+
+
+void SecureContext::GetSessionCacheStats(
+    const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(args.GetIsolate());
+  SecureContext* sc = Unwrap<SecureContext>(args.This());
+  Isolate* isolate = args.GetIsolate();
+  SSL_CTX* ctx = sc->ctx_;
+
+  Local<Object> stats = Object::New();
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "size"),
+             Number::New(isolate, SSL_CTX_sess_number(ctx)));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "hits"),
+             Number::New(isolate, SSL_CTX_sess_hits(ctx)));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "misses"),
+             Number::New(isolate, SSL_CTX_sess_misses(ctx)));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "timeouts"),
+             Number::New(isolate, SSL_CTX_sess_timeouts(ctx)));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "cacheFull"),
+             Number::New(isolate, SSL_CTX_sess_cache_full(ctx)));
+
+  SharedSessionCache* cache = SharedSessionCache::FromContext(ctx);
+  if (cache != NULL) {
+    Local<Object> shared = Object::New();
+    shared->Set(FIXED_ONE_BYTE_STRING(isolate, "capacity"),
+                Number::New(isolate, cache->capacity()));
+    shared->Set(FIXED_ONE_BYTE_STRING(isolate, "hits"),
+                Number::New(isolate, cache->hits()));
+    shared->Set(FIXED_ONE_BYTE_STRING(isolate, "misses"),
+                Number::New(isolate, cache->misses()));
+    shared->Set(FIXED_ONE_BYTE_STRING(isolate, "stores"),
+                Number::New(isolate, cache->stores()));
+    shared->Set(FIXED_ONE_BYTE_STRING(isolate, "evictions"),
+                Number::New(isolate, cache->evictions()));
+    stats->Set(FIXED_ONE_BYTE_STRING(isolate, "shared"), shared);
+  }
+
+  args.GetReturnValue().Set(stats);
+}
+
+
 template <class Base>
 void SSLWrap<Base>::AddMethods(Environment* env, Handle<FunctionTemplate> t) {
   HandleScope scope(env->isolate());
@@ -915,6 +1017,12 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   SSL_SESSION* sess = w->next_sess_;
   w->next_sess_ = NULL;
 
+  if (sess == NULL) {
+    SharedSessionCache* cache = SharedSessionCache::FromContext(s->session_ctx);
+    if (cache != NULL)
+      sess = cache->Lookup(key, len);
+  }
+
   return sess;
 }
 
@@ -922,13 +1030,19 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
 template <class Base>
 int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->ssl_env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
+
+  // May run on the thread pool, don't touch V8 before this point
+  SharedSessionCache* cache = SharedSessionCache::FromContext(s->session_ctx);
+  if (cache != NULL)
+    cache->Store(sess);
 
   if (!w->session_callbacks_)
     return 0;
 
+  Environment* env = w->ssl_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
   // Check if session is small enough to be stored
   int size = i2d_SSL_SESSION(sess, NULL);
   if (size > SecureContext::kMaxSessionSize)
@@ -988,6 +1102,8 @@ void SSLWrap<Base>::GetPeerCertificate(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
   Environment* env = w->ssl_env();
 
   ClearErrorOnReturn clear_error_on_return;
@@ -1137,6 +1253,8 @@ void SSLWrap<Base>::GetSession(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   SSL_SESSION* sess = SSL_get_session(w->ssl_);
   if (sess == NULL)
@@ -1159,6 +1277,8 @@ void SSLWrap<Base>::SetSession(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   if (args.Length() < 1 ||
       (!args[0]->IsString() && !Buffer::HasInstance(args[0]))) {
@@ -1229,6 +1349,8 @@ template <class Base>
 void SSLWrap<Base>::IsSessionReused(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
   bool yes = SSL_session_reused(w->ssl_);
   args.GetReturnValue().Set(yes);
 }
@@ -1247,6 +1369,8 @@ void SSLWrap<Base>::Renegotiate(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence unused variable warning.
@@ -1261,6 +1385,8 @@ void SSLWrap<Base>::Shutdown(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   int rv = SSL_shutdown(w->ssl_);
   args.GetReturnValue().Set(rv);
@@ -1272,6 +1398,8 @@ void SSLWrap<Base>::GetTLSTicket(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
   Environment* env = w->ssl_env();
 
   SSL_SESSION* sess = SSL_get_session(w->ssl_);
@@ -1304,6 +1432,8 @@ void SSLWrap<Base>::SetMaxSendFragment(
   CHECK(args.Length() >= 1 && args[0]->IsNumber());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   int rv = SSL_set_max_send_fragment(w->ssl_, args[0]->Int32Value());
   args.GetReturnValue().Set(rv);
@@ -1315,6 +1445,8 @@ template <class Base>
 void SSLWrap<Base>::IsInitFinished(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
   bool yes = SSL_is_init_finished(w->ssl_);
   args.GetReturnValue().Set(yes);
 }
@@ -1325,6 +1457,8 @@ void SSLWrap<Base>::VerifyError(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   // XXX(bnoordhuis) The UNABLE_TO_GET_ISSUER_CERT error when there is no
   // peer certificate is questionable but it's compatible with what was
@@ -1390,6 +1524,8 @@ void SSLWrap<Base>::GetCurrentCipher(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
   Environment* env = w->ssl_env();
 
   OPENSSL_CONST SSL_CIPHER* c = SSL_get_current_cipher(w->ssl_);
@@ -1412,21 +1548,24 @@ int SSLWrap<Base>::AdvertiseNextProtoCallback(SSL* s,
                                               const unsigned char** data,
                                               unsigned int* len,
                                               void* arg) {
-  Base* w = static_cast<Base*>(arg);
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
+  // `arg` is the last connection created with this context, not this one
+  Base* w = static_cast<Base*>(SSL_get_app_data(s));
 
   if (w->npn_protos_.IsEmpty()) {
     // No initialization - no NPN protocols
     *data = reinterpret_cast<const unsigned char*>("");
     *len = 0;
-  } else {
-    Local<Object> obj = PersistentToLocal(env->isolate(), w->npn_protos_);
-    *data = reinterpret_cast<const unsigned char*>(Buffer::Data(obj));
-    *len = Buffer::Length(obj);
+    return SSL_TLSEXT_ERR_OK;
   }
 
+  Environment* env = w->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Object> obj = PersistentToLocal(env->isolate(), w->npn_protos_);
+  *data = reinterpret_cast<const unsigned char*>(Buffer::Data(obj));
+  *len = Buffer::Length(obj);
+
   return SSL_TLSEXT_ERR_OK;
 }
 
@@ -1492,6 +1631,8 @@ void SSLWrap<Base>::GetNegotiatedProto(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.This());
+  if (w->ThrowIfSSLOffloaded())
+    return;
 
   if (w->is_client()) {
     if (w->selected_npn_proto_.IsEmpty() == false) {
@@ -1827,6 +1968,8 @@ void Connection::New(const FunctionCallbackInfo<Value>& args) {
   conn->ssl_ = SSL_new(sc->ctx_);
   conn->bio_read_ = NodeBIO::New();
   conn->bio_write_ = NodeBIO::New();
+  NodeBIO::FromBIO(conn->bio_read_)->AssignEnvironment(env);
+  NodeBIO::FromBIO(conn->bio_write_)->AssignEnvironment(env);
 
   SSL_set_app_data(conn->ssl_, conn);
 
@@ -2190,6 +2333,7 @@ void CipherBase::Initialize(Environment* env, Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "init", Init);
   NODE_SET_PROTOTYPE_METHOD(t, "initiv", InitIv);
   NODE_SET_PROTOTYPE_METHOD(t, "update", Update);
+  NODE_SET_PROTOTYPE_METHOD(t, "updateInto", UpdateInto);
   NODE_SET_PROTOTYPE_METHOD(t, "final", Final);
   NODE_SET_PROTOTYPE_METHOD(t, "setAutoPadding", SetAutoPadding);
   NODE_SET_PROTOTYPE_METHOD(t, "getAuthTag", GetAuthTag);
@@ -2393,6 +2537,20 @@ bool CipherBase::Update(const char* data,
   if (!initialised_)
     return 0;
 
+  *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
+  *out = new unsigned char[*out_len];
+  return UpdateInto(data, len, *out, out_len);
+}
+
+
+// `out` must have room for `len` plus one block
+bool CipherBase::UpdateInto(const char* data,
+                            int len,
+                            unsigned char* out,
+                            int* out_len) {
+  if (!initialised_)
+    return 0;
+
   // on first update:
   if (kind_ == kDecipher && IsAuthenticatedMode() && auth_tag_ != NULL) {
     EVP_CIPHER_CTX_ctrl(&ctx_,
@@ -2403,10 +2561,8 @@ bool CipherBase::Update(const char* data,
     auth_tag_ = NULL;
   }
 
-  *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
-  *out = new unsigned char[*out_len];
   return EVP_CipherUpdate(&ctx_,
-                          *out,
+                          out,
                           out_len,
                           reinterpret_cast<const unsigned char*>(data),
                           len);
@@ -2443,6 +2599,21 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   } else {
     char* buf = Buffer::Data(args[0]);
     size_t buflen = Buffer::Length(args[0]);
+
+    // Stream modes (CTR, GCM, ...) return exactly what they are given,
+    // encrypt straight into the result instead of copying it over.
+    if (cipher->initialised_ &&
+        EVP_CIPHER_CTX_block_size(&cipher->ctx_) == 1) {
+      Local<Object> result = Buffer::New(env, buflen);
+      unsigned char* data =
+          reinterpret_cast<unsigned char*>(Buffer::Data(result));
+      if (!cipher->UpdateInto(buf, buflen, data, &out_len))
+        return ThrowCryptoTypeError(env, ERR_get_error());
+      if (out_len != static_cast<int>(buflen))
+        result = Buffer::New(env, reinterpret_cast<char*>(data), out_len);
+      return args.GetReturnValue().Set(result);
+    }
+
     r = cipher->Update(buf, buflen, &out, &out_len);
   }
 
@@ -2459,6 +2630,58 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void CipherBase::UpdateInto(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+
+  CipherBase* cipher = Unwrap<CipherBase>(args.This());
+
+  ASSERT_IS_BUFFER(args[0]);
+  ASSERT_IS_BUFFER(args[1]);
+  if (!args[2]->IsUint32())
+    return env->ThrowTypeError("Bad offset");
+
+  if (!cipher->initialised_)
+    return env->ThrowError("Not initialized");
+
+  const char* in = Buffer::Data(args[0]);
+  size_t in_len = Buffer::Length(args[0]);
+  char* out = Buffer::Data(args[1]);
+  size_t out_len = Buffer::Length(args[1]);
+  size_t offset = args[2]->Uint32Value();
+
+  if (offset > out_len)
+    return env->ThrowRangeError("offset is out of bounds");
+  out += offset;
+  out_len -= offset;
+
+  // Block modes may emit a block held back from the previous call
+  int block_size = EVP_CIPHER_CTX_block_size(&cipher->ctx_);
+  size_t needed = in_len;
+  if (block_size > 1)
+    needed += block_size;
+  if (out_len < needed)
+    return env->ThrowRangeError("Output buffer is too small");
+
+  // Block modes write their output shifted against the input, only stream
+  // modes can work in place.
+  if (out < in + in_len && in < out + needed) {
+    if (out != in || block_size != 1)
+      return env->ThrowError("Only stream cipher modes can update in place");
+  }
+
+  int written = 0;
+  if (!cipher->UpdateInto(in,
+                          in_len,
+                          reinterpret_cast<unsigned char*>(out),
+                          &written)) {
+    return ThrowCryptoTypeError(env, ERR_get_error());
+  }
+
+  args.GetReturnValue().Set(written);
+}
+
+
 bool CipherBase::SetAutoPadding(bool auto_padding) {
   if (!initialised_)
     return false;
@@ -2782,6 +3005,178 @@ void Hash::HashDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Returns a new reference, NULL on error.
+static EVP_PKEY* ParsePrivateKey(const char* key_pem,
+                                 int key_pem_len,
+                                 const char* passphrase) {
+  BIO* bp = BIO_new(BIO_s_mem());
+  if (bp == NULL)
+    return NULL;
+
+  EVP_PKEY* pkey = NULL;
+  if (BIO_write(bp, key_pem, key_pem_len)) {
+    pkey = PEM_read_bio_PrivateKey(bp,
+                                   NULL,
+                                   CryptoPemCallback,
+                                   const_cast<char*>(passphrase));
+  }
+
+  BIO_free_all(bp);
+  return pkey;
+}
+
+
+// Accepts PKCS#8 and RSA public keys as well as X.509 certificates.
+// Returns a new reference, NULL on error.
+static EVP_PKEY* ParsePublicKey(const char* key_pem, int key_pem_len) {
+  BIO* bp = BIO_new(BIO_s_mem());
+  if (bp == NULL)
+    return NULL;
+
+  EVP_PKEY* pkey = NULL;
+  if (!BIO_write(bp, key_pem, key_pem_len))
+    goto exit;
+
+  // Check if this is a PKCS#8 or RSA public key before trying as X.509.
+  if (key_pem_len >= PUBLIC_KEY_PFX_LEN &&
+      strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
+    pkey = PEM_read_bio_PUBKEY(bp, NULL, CryptoPemCallback, NULL);
+  } else if (key_pem_len >= PUBRSA_KEY_PFX_LEN &&
+             strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
+    RSA* rsa = PEM_read_bio_RSAPublicKey(bp, NULL, CryptoPemCallback, NULL);
+    if (rsa) {
+      pkey = EVP_PKEY_new();
+      if (pkey)
+        EVP_PKEY_set1_RSA(pkey, rsa);
+      RSA_free(rsa);
+    }
+  } else {
+    // X.509 fallback
+    X509* x509 = PEM_read_bio_X509(bp, NULL, CryptoPemCallback, NULL);
+    if (x509 != NULL) {
+      pkey = X509_get_pubkey(x509);
+      X509_free(x509);
+    }
+  }
+
+ exit:
+  BIO_free_all(bp);
+  return pkey;
+}
+
+
+void KeyObject::Initialize(Environment* env, Handle<Object> target) {
+  Local<FunctionTemplate> t = FunctionTemplate::New(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(t, "init", Init);
+  NODE_SET_PROTOTYPE_METHOD(t, "getKeyType", GetKeyType);
+  NODE_SET_PROTOTYPE_METHOD(t, "getKeySize", GetKeySize);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "KeyObject"),
+              t->GetFunction());
+  env->set_key_object_constructor_template(t);
+}
+
+
+void KeyObject::New(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  new KeyObject(env, args.This());
+}
+
+
+bool KeyObject::Init(const char* key_pem,
+                     int key_pem_len,
+                     bool is_private,
+                     const char* passphrase) {
+  EVP_PKEY* pkey;
+  if (is_private)
+    pkey = ParsePrivateKey(key_pem, key_pem_len, passphrase);
+  else
+    pkey = ParsePublicKey(key_pem, key_pem_len);
+  if (pkey == NULL)
+    return false;
+
+  if (pkey_ != NULL)
+    EVP_PKEY_free(pkey_);
+  pkey_ = pkey;
+  is_private_ = is_private;
+  return true;
+}
+
+
+void KeyObject::Init(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  KeyObject* key = Unwrap<KeyObject>(args.This());
+
+  ASSERT_IS_BUFFER(args[0]);
+  bool is_private = args[1]->BooleanValue();
+  String::Utf8Value passphrase(args[2]);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  bool ok = key->Init(Buffer::Data(args[0]),
+                      Buffer::Length(args[0]),
+                      is_private,
+                      args[2]->IsString() ? *passphrase : NULL);
+  if (!ok) {
+    unsigned long err = ERR_get_error();
+    if (err)
+      return ThrowCryptoError(env, err);
+    if (is_private)
+      return env->ThrowError("PEM_read_bio_PrivateKey failed");
+    return env->ThrowError("PEM_read_bio_PUBKEY failed");
+  }
+}
+
+
+void KeyObject::GetKeyType(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  KeyObject* key = Unwrap<KeyObject>(args.This());
+  if (key->pkey_ == NULL)
+    return env->ThrowError("Not initialised");
+
+  const char* type;
+  switch (EVP_PKEY_type(key->pkey_->type)) {
+    case EVP_PKEY_RSA:
+      type = "rsa";
+      break;
+    case EVP_PKEY_DSA:
+      type = "dsa";
+      break;
+#ifndef OPENSSL_NO_EC
+    case EVP_PKEY_EC:
+      type = "ec";
+      break;
+#endif  // !OPENSSL_NO_EC
+    default:
+      type = "unknown";
+      break;
+  }
+
+  args.GetReturnValue().Set(OneByteString(env->isolate(), type));
+}
+
+
+void KeyObject::GetKeySize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  KeyObject* key = Unwrap<KeyObject>(args.This());
+  if (key->pkey_ == NULL)
+    return env->ThrowError("Not initialised");
+
+  args.GetReturnValue().Set(EVP_PKEY_bits(key->pkey_));
+}
+
+
 void SignBase::CheckThrow(SignBase::Error error) {
   HandleScope scope(env()->isolate());
 
@@ -2922,36 +3317,29 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
   if (!initialised_)
     return kSignNotInitialised;
 
-  BIO* bp = NULL;
-  EVP_PKEY* pkey = NULL;
-  bool fatal = true;
-
-  bp = BIO_new(BIO_s_mem());
-  if (bp == NULL)
-    goto exit;
-
-  if (!BIO_write(bp, key_pem, key_pem_len))
-    goto exit;
+  EVP_PKEY* pkey = ParsePrivateKey(key_pem, key_pem_len, passphrase);
+  if (pkey == NULL) {
+    EVP_MD_CTX_cleanup(&mdctx_);
+    initialised_ = false;
+    return kSignPrivateKey;
+  }
 
-  pkey = PEM_read_bio_PrivateKey(bp,
-                                 NULL,
-                                 CryptoPemCallback,
-                                 const_cast<char*>(passphrase));
-  if (pkey == NULL)
-    goto exit;
+  Error err = SignFinal(pkey, sig, sig_len);
+  EVP_PKEY_free(pkey);
+  return err;
+}
 
-  if (EVP_SignFinal(&mdctx_, *sig, sig_len, pkey))
-    fatal = false;
 
-  initialised_ = false;
+SignBase::Error Sign::SignFinal(EVP_PKEY* pkey,
+                                unsigned char** sig,
+                                unsigned int *sig_len) {
+  if (!initialised_)
+    return kSignNotInitialised;
 
- exit:
-  if (pkey != NULL)
-    EVP_PKEY_free(pkey);
-  if (bp != NULL)
-    BIO_free_all(bp);
+  bool fatal = !EVP_SignFinal(&mdctx_, *sig, sig_len, pkey);
 
   EVP_MD_CTX_cleanup(&mdctx_);
+  initialised_ = false;
 
   if (fatal)
     return kSignPrivateKey;
@@ -2977,19 +3365,30 @@ void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
 
   String::Utf8Value passphrase(args[2]);
 
-  ASSERT_IS_BUFFER(args[0]);
-  size_t buf_len = Buffer::Length(args[0]);
-  char* buf = Buffer::Data(args[0]);
-
-  md_len = 8192;  // Maximum key size is 8192 bits
-  md_value = new unsigned char[md_len];
-
-  Error err = sign->SignFinal(
-      buf,
-      buf_len,
-      len >= 3 && !args[2]->IsNull() ? *passphrase : NULL,
-      &md_value,
-      &md_len);
+  Error err;
+  if (env->key_object_constructor_template()->HasInstance(args[0])) {
+    KeyObject* key = Unwrap<KeyObject>(args[0].As<Object>());
+    if (key->pkey() == NULL || !key->is_private())
+      return env->ThrowTypeError("Not a private key");
+
+    md_len = EVP_PKEY_size(key->pkey());
+    md_value = new unsigned char[md_len];
+    err = sign->SignFinal(key->pkey(), &md_value, &md_len);
+  } else {
+    ASSERT_IS_BUFFER(args[0]);
+    size_t buf_len = Buffer::Length(args[0]);
+    char* buf = Buffer::Data(args[0]);
+
+    md_len = 8192;  // Maximum key size is 8192 bits
+    md_value = new unsigned char[md_len];
+
+    err = sign->SignFinal(
+        buf,
+        buf_len,
+        len >= 3 && !args[2]->IsNull() ? *passphrase : NULL,
+        &md_value,
+        &md_len);
+  }
   if (err != kSignOk) {
     delete[] md_value;
     md_value = NULL;
@@ -3112,67 +3511,37 @@ SignBase::Error Verify::VerifyFinal(const char* key_pem,
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence compiler warning.
 
-  EVP_PKEY* pkey = NULL;
-  BIO* bp = NULL;
-  X509* x509 = NULL;
-  bool fatal = true;
-  int r = 0;
-
-  bp = BIO_new(BIO_s_mem());
-  if (bp == NULL)
-    goto exit;
+  EVP_PKEY* pkey = ParsePublicKey(key_pem, key_pem_len);
+  if (pkey == NULL) {
+    EVP_MD_CTX_cleanup(&mdctx_);
+    initialised_ = false;
+    return kSignPublicKey;
+  }
 
-  if (!BIO_write(bp, key_pem, key_pem_len))
-    goto exit;
+  Error err = VerifyFinal(pkey, sig, siglen, verify_result);
+  EVP_PKEY_free(pkey);
+  return err;
+}
 
-  // Check if this is a PKCS#8 or RSA public key before trying as X.509.
-  // Split this out into a separate function once we have more than one
-  // consumer of public keys.
-  if (strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
-    pkey = PEM_read_bio_PUBKEY(bp, NULL, CryptoPemCallback, NULL);
-    if (pkey == NULL)
-      goto exit;
-  } else if (strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
-    RSA* rsa = PEM_read_bio_RSAPublicKey(bp, NULL, CryptoPemCallback, NULL);
-    if (rsa) {
-      pkey = EVP_PKEY_new();
-      if (pkey)
-        EVP_PKEY_set1_RSA(pkey, rsa);
-      RSA_free(rsa);
-    }
-    if (pkey == NULL)
-      goto exit;
-  } else {
-    // X.509 fallback
-    x509 = PEM_read_bio_X509(bp, NULL, CryptoPemCallback, NULL);
-    if (x509 == NULL)
-      goto exit;
 
-    pkey = X509_get_pubkey(x509);
-    if (pkey == NULL)
-      goto exit;
-  }
+SignBase::Error Verify::VerifyFinal(EVP_PKEY* pkey,
+                                    const char* sig,
+                                    int siglen,
+                                    bool* verify_result) {
+  if (!initialised_)
+    return kSignNotInitialised;
 
-  fatal = false;
-  r = EVP_VerifyFinal(&mdctx_,
-                      reinterpret_cast<const unsigned char*>(sig),
-                      siglen,
-                      pkey);
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
 
- exit:
-  if (pkey != NULL)
-    EVP_PKEY_free(pkey);
-  if (bp != NULL)
-    BIO_free_all(bp);
-  if (x509 != NULL)
-    X509_free(x509);
+  int r = EVP_VerifyFinal(&mdctx_,
+                          reinterpret_cast<const unsigned char*>(sig),
+                          siglen,
+                          pkey);
 
   EVP_MD_CTX_cleanup(&mdctx_);
   initialised_ = false;
 
-  if (fatal)
-    return kSignPublicKey;
-
   *verify_result = r == 1;
   return kSignOk;
 }
@@ -3184,9 +3553,18 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
 
   Verify* verify = Unwrap<Verify>(args.This());
 
-  ASSERT_IS_BUFFER(args[0]);
-  char* kbuf = Buffer::Data(args[0]);
-  ssize_t klen = Buffer::Length(args[0]);
+  KeyObject* key = NULL;
+  char* kbuf = NULL;
+  ssize_t klen = 0;
+  if (env->key_object_constructor_template()->HasInstance(args[0])) {
+    key = Unwrap<KeyObject>(args[0].As<Object>());
+    if (key->pkey() == NULL)
+      return env->ThrowTypeError("Key not initialised");
+  } else {
+    ASSERT_IS_BUFFER(args[0]);
+    kbuf = Buffer::Data(args[0]);
+    klen = Buffer::Length(args[0]);
+  }
 
   ASSERT_IS_STRING_OR_BUFFER(args[1]);
   // BINARY works for both buffers and binary strings.
@@ -3212,7 +3590,11 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
   }
 
   bool verify_result;
-  Error err = verify->VerifyFinal(kbuf, klen, hbuf, hlen, &verify_result);
+  Error err;
+  if (key != NULL)
+    err = verify->VerifyFinal(key->pkey(), hbuf, hlen, &verify_result);
+  else
+    err = verify->VerifyFinal(kbuf, klen, hbuf, hlen, &verify_result);
   if (args[1]->IsString())
     delete[] hbuf;
   if (err != kSignOk)
@@ -3221,6 +3603,136 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// One-shot sign(algorithm, data, key[, passphrase]), skips the stream and
+// binding object setup of Sign for callers that have the whole message.
+// `key` is either a KeyObject or a PEM encoded buffer.
+void SignOneShot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Algorithm must be a string");
+  ASSERT_IS_BUFFER(args[1]);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (env->key_object_constructor_template()->HasInstance(args[2])) {
+    KeyObject* key = Unwrap<KeyObject>(args[2].As<Object>());
+    if (key->pkey() == NULL || !key->is_private())
+      return env->ThrowTypeError("Not a private key");
+    pkey = key->pkey();
+    CRYPTO_add(&pkey->references, 1, CRYPTO_LOCK_EVP_PKEY);
+  } else {
+    ASSERT_IS_BUFFER(args[2]);
+    String::Utf8Value passphrase(args[3]);
+    pkey = ParsePrivateKey(Buffer::Data(args[2]),
+                           Buffer::Length(args[2]),
+                           args[3]->IsString() ? *passphrase : NULL);
+    if (pkey == NULL) {
+      unsigned long err = ERR_get_error();
+      if (err)
+        return ThrowCryptoError(env, err);
+      return env->ThrowError("PEM_read_bio_PrivateKey failed");
+    }
+  }
+
+  const String::Utf8Value algorithm(args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*algorithm);
+  if (md == NULL) {
+    EVP_PKEY_free(pkey);
+    return env->ThrowError("Unknown message digest");
+  }
+
+  unsigned int sig_len = EVP_PKEY_size(pkey);
+  unsigned char* sig = new unsigned char[sig_len];
+
+  EVP_MD_CTX mdctx;
+  EVP_MD_CTX_init(&mdctx);
+  bool ok = EVP_SignInit_ex(&mdctx, md, NULL) &&
+            EVP_SignUpdate(&mdctx,
+                           Buffer::Data(args[1]),
+                           Buffer::Length(args[1])) &&
+            EVP_SignFinal(&mdctx, sig, &sig_len, pkey);
+  EVP_MD_CTX_cleanup(&mdctx);
+  EVP_PKEY_free(pkey);
+
+  if (!ok) {
+    delete[] sig;
+    unsigned long err = ERR_get_error();
+    if (err)
+      return ThrowCryptoError(env, err);
+    return env->ThrowError("EVP_SignFinal failed");
+  }
+
+  Local<Object> buf = Buffer::New(env,
+                                  reinterpret_cast<char*>(sig),
+                                  sig_len);
+  delete[] sig;
+  args.GetReturnValue().Set(buf);
+}
+
+
+// One-shot verify(algorithm, data, key, signature), the counterpart of
+// SignOneShot. `key` is either a KeyObject or a PEM encoded buffer.
+void VerifyOneShot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Algorithm must be a string");
+  ASSERT_IS_BUFFER(args[1]);
+  ASSERT_IS_BUFFER(args[3]);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (env->key_object_constructor_template()->HasInstance(args[2])) {
+    KeyObject* key = Unwrap<KeyObject>(args[2].As<Object>());
+    if (key->pkey() == NULL)
+      return env->ThrowTypeError("Key not initialised");
+    pkey = key->pkey();
+    CRYPTO_add(&pkey->references, 1, CRYPTO_LOCK_EVP_PKEY);
+  } else {
+    ASSERT_IS_BUFFER(args[2]);
+    pkey = ParsePublicKey(Buffer::Data(args[2]), Buffer::Length(args[2]));
+    if (pkey == NULL) {
+      unsigned long err = ERR_get_error();
+      if (err)
+        return ThrowCryptoError(env, err);
+      return env->ThrowError("PEM_read_bio_PUBKEY failed");
+    }
+  }
+
+  const String::Utf8Value algorithm(args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*algorithm);
+  if (md == NULL) {
+    EVP_PKEY_free(pkey);
+    return env->ThrowError("Unknown message digest");
+  }
+
+  EVP_MD_CTX mdctx;
+  EVP_MD_CTX_init(&mdctx);
+  int r = 0;
+  if (EVP_VerifyInit_ex(&mdctx, md, NULL) &&
+      EVP_VerifyUpdate(&mdctx,
+                       Buffer::Data(args[1]),
+                       Buffer::Length(args[1]))) {
+    r = EVP_VerifyFinal(
+        &mdctx,
+        reinterpret_cast<const unsigned char*>(Buffer::Data(args[3])),
+        Buffer::Length(args[3]),
+        pkey);
+  }
+  EVP_MD_CTX_cleanup(&mdctx);
+  EVP_PKEY_free(pkey);
+
+  args.GetReturnValue().Set(r == 1);
+}
+
+
 void DiffieHellman::Initialize(Environment* env, Handle<Object> target) {
   Local<FunctionTemplate> t = FunctionTemplate::New(New);
 
@@ -3621,7 +4133,329 @@ bool DiffieHellman::VerifyContext() {
 }
 
 
-class PBKDF2Request : public AsyncWrap {
+void ECDH::Initialize(Environment* env, Handle<Object> target) {
+  HandleScope scope(env->isolate());
+
+  Local<FunctionTemplate> t = FunctionTemplate::New(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(t, "generateKeys", GenerateKeys);
+  NODE_SET_PROTOTYPE_METHOD(t, "computeSecret", ComputeSecret);
+  NODE_SET_PROTOTYPE_METHOD(t, "getPublicKey", GetPublicKey);
+  NODE_SET_PROTOTYPE_METHOD(t, "getPrivateKey", GetPrivateKey);
+  NODE_SET_PROTOTYPE_METHOD(t, "setPublicKey", SetPublicKey);
+  NODE_SET_PROTOTYPE_METHOD(t, "setPrivateKey", SetPrivateKey);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ECDH"),
+              t->GetFunction());
+}
+
+
+void ECDH::New(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+
+  if (args.Length() < 1 || !args[0]->IsString())
+    return env->ThrowTypeError("Curve name should be a string");
+
+  String::Utf8Value curve(args[0]);
+
+  int nid = OBJ_sn2nid(*curve);
+  if (nid == NID_undef)
+    return env->ThrowTypeError("First argument should be a valid curve name");
+
+  EC_KEY* key = EC_KEY_new_by_curve_name(nid);
+  if (key == NULL)
+    return env->ThrowError("Failed to create EC_KEY using curve name");
+
+  new ECDH(env, args.This(), key);
+}
+
+
+void ECDH::GenerateKeys(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  ECDH* ecdh = Unwrap<ECDH>(args.This());
+
+  if (!EC_KEY_generate_key(ecdh->key_))
+    return env->ThrowError("Failed to generate EC_KEY");
+}
+
+
+EC_POINT* ECDH::BufferToPoint(char* data, size_t len) {
+  EC_POINT* pub;
+  int r;
+
+  pub = EC_POINT_new(group_);
+  if (pub == NULL) {
+    env()->ThrowError("Failed to allocate EC_POINT for a public key");
+    return NULL;
+  }
+
+  r = EC_POINT_oct2point(
+      group_,
+      pub,
+      reinterpret_cast<unsigned char*>(data),
+      len,
+      NULL);
+  if (!r) {
+    EC_POINT_free(pub);
+    env()->ThrowError("Failed to translate Buffer to a EC_POINT");
+    return NULL;
+  }
+
+  return pub;
+}
+
+
+void ECDH::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  ASSERT_IS_BUFFER(args[0]);
+
+  ECDH* ecdh = Unwrap<ECDH>(args.This());
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  if (EC_KEY_get0_private_key(ecdh->key_) == NULL)
+    return env->ThrowError("No private key - did you forget to generate one?");
+
+  EC_POINT* pub = ecdh->BufferToPoint(Buffer::Data(args[0]),
+                                      Buffer::Length(args[0]));
+  if (pub == NULL)
+    return;
+
+  // NOTE: field_size is in bits
+  int field_size = EC_GROUP_get_degree(ecdh->group_);
+  size_t out_len = (field_size + 7) / 8;
+  char* out = new char[out_len];
+
+  int r = ECDH_compute_key(out, out_len, pub, ecdh->key_, NULL);
+  EC_POINT_free(pub);
+  if (r <= 0) {
+    delete[] out;
+    return env->ThrowError("Failed to compute ECDH key");
+  }
+
+  args.GetReturnValue().Set(Encode(env->isolate(), out, out_len, BUFFER));
+  delete[] out;
+}
+
+
+void ECDH::GetPublicKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  // Conversion form
+  if (args.Length() < 1 || !args[0]->IsInt32())
+    return env->ThrowTypeError("Bad arguments");
+
+  ECDH* ecdh = Unwrap<ECDH>(args.This());
+
+  const EC_POINT* pub = EC_KEY_get0_public_key(ecdh->key_);
+  if (pub == NULL)
+    return env->ThrowError("No public key - did you forget to generate one?");
+
+  point_conversion_form_t form =
+      static_cast<point_conversion_form_t>(args[0]->Int32Value());
+  if (form != POINT_CONVERSION_COMPRESSED &&
+      form != POINT_CONVERSION_UNCOMPRESSED &&
+      form != POINT_CONVERSION_HYBRID) {
+    return env->ThrowTypeError("Bad point conversion form");
+  }
+
+  size_t size = EC_POINT_point2oct(ecdh->group_, pub, form, NULL, 0, NULL);
+  if (size == 0)
+    return env->ThrowError("Failed to get public key length");
+
+  unsigned char* out = new unsigned char[size];
+
+  size_t r = EC_POINT_point2oct(ecdh->group_, pub, form, out, size, NULL);
+  if (r != size) {
+    delete[] out;
+    return env->ThrowError("Failed to get public key");
+  }
+
+  args.GetReturnValue().Set(Encode(env->isolate(),
+                                   reinterpret_cast<char*>(out),
+                                   size,
+                                   BUFFER));
+  delete[] out;
+}
+
+
+void ECDH::GetPrivateKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  ECDH* ecdh = Unwrap<ECDH>(args.This());
+
+  const BIGNUM* b = EC_KEY_get0_private_key(ecdh->key_);
+  if (b == NULL)
+    return env->ThrowError("No private key - did you forget to generate one?");
+
+  // Pad to the size of the group order, like the keys OpenSSL generates
+  BIGNUM* order = BN_new();
+  if (order == NULL || !EC_GROUP_get_order(ecdh->group_, order, NULL)) {
+    BN_free(order);
+    return env->ThrowError("Failed to get curve order");
+  }
+  int size = BN_num_bytes(order);
+  BN_free(order);
+
+  int len = BN_num_bytes(b);
+  unsigned char* out = new unsigned char[size];
+  memset(out, 0, size - len);
+  BN_bn2bin(b, out + size - len);
+
+  args.GetReturnValue().Set(Encode(env->isolate(),
+                                   reinterpret_cast<char*>(out),
+                                   size,
+                                   BUFFER));
+  delete[] out;
+}
+
+
+void ECDH::SetPrivateKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  ECDH* ecdh = Unwrap<ECDH>(args.This());
+
+  ASSERT_IS_BUFFER(args[0]);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  BIGNUM* priv = BN_bin2bn(
+      reinterpret_cast<unsigned char*>(Buffer::Data(args[0])),
+      Buffer::Length(args[0]),
+      NULL);
+  if (priv == NULL)
+    return env->ThrowError("Failed to convert Buffer to BN");
+
+  // The key must be in [1, order - 1]
+  BIGNUM* order = BN_new();
+  bool valid = order != NULL &&
+               EC_GROUP_get_order(ecdh->group_, order, NULL) &&
+               !BN_is_zero(priv) &&
+               BN_cmp(priv, order) < 0;
+  BN_free(order);
+  if (!valid) {
+    BN_clear_free(priv);
+    return env->ThrowError("Private key is not valid for specified curve");
+  }
+
+  // Keep the public key in sync with the new private one
+  EC_POINT* pub = EC_POINT_new(ecdh->group_);
+  bool ok = pub != NULL &&
+            EC_POINT_mul(ecdh->group_, pub, priv, NULL, NULL, NULL) &&
+            EC_KEY_set_private_key(ecdh->key_, priv) &&
+            EC_KEY_set_public_key(ecdh->key_, pub);
+  EC_POINT_free(pub);
+  BN_clear_free(priv);
+
+  if (!ok)
+    return env->ThrowError("Failed to convert BN to a private key");
+}
+
+
+void ECDH::SetPublicKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  ECDH* ecdh = Unwrap<ECDH>(args.This());
+
+  ASSERT_IS_BUFFER(args[0]);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EC_POINT* pub = ecdh->BufferToPoint(Buffer::Data(args[0]),
+                                      Buffer::Length(args[0]));
+  if (pub == NULL)
+    return;
+
+  int r = EC_KEY_set_public_key(ecdh->key_, pub);
+  EC_POINT_free(pub);
+  if (!r)
+    return env->ThrowError("Failed to convert BN to a public key");
+}
+
+
+// Base of the key derivation requests. A derivation holds its pool thread for
+// as long as the caller asks it to, so it's queued as slow CPU work, which
+// may only take up part of the pool. The JS object's cancel() takes it off
+// the queue, or makes a running derivation stop at its next check.
+class KDFRequest : public AsyncWrap {
+ public:
+  KDFRequest(Environment* env, Local<Object> object)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        cancelled_(0) {
+    Wrap<KDFRequest>(object, this);
+  }
+
+  virtual ~KDFRequest() {
+    // cancel() may still be called on the JS object
+    object()->SetAlignedPointerInInternalField(0, NULL);
+    persistent().Dispose();
+  }
+
+  static void Initialize(Environment* env, Handle<Object> target);
+  static void Cancel(const FunctionCallbackInfo<Value>& args);
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  inline bool cancelled() const {
+    return cancelled_ != 0;
+  }
+
+  static KDFRequest* from_work_req(uv_work_t* work_req) {
+    return CONTAINER_OF(work_req, KDFRequest, work_req_);
+  }
+
+ private:
+  uv_work_t work_req_;
+  // Written on the loop thread, polled by the pool thread
+  volatile int cancelled_;
+};
+
+
+void KDFRequest::Initialize(Environment* env, Handle<Object> target) {
+  Local<FunctionTemplate> t = FunctionTemplate::New();
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "KDFRequest"));
+
+  NODE_SET_PROTOTYPE_METHOD(t, "cancel", Cancel);
+
+  env->set_kdf_request_constructor_function(t->GetFunction());
+}
+
+
+void KDFRequest::Cancel(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+
+  KDFRequest* req = Unwrap<KDFRequest>(args.This());
+
+  // Callback was already called
+  if (req == NULL)
+    return;
+
+  req->cancelled_ = 1;
+
+  // Fails if the derivation is already running, it then sees `cancelled_`
+  uv_cancel(reinterpret_cast<uv_req_t*>(req->work_req()));
+}
+
+
+class PBKDF2Request : public KDFRequest {
  public:
   PBKDF2Request(Environment* env,
                 Local<Object> object,
@@ -3632,7 +4466,7 @@ class PBKDF2Request : public AsyncWrap {
                 char* salt,
                 ssize_t iter,
                 ssize_t keylen)
-      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+      : KDFRequest(env, object),
         digest_(digest),
         error_(0),
         passlen_(passlen),
@@ -3646,14 +4480,6 @@ class PBKDF2Request : public AsyncWrap {
       FatalError("node::PBKDF2Request()", "Out of Memory");
   }
 
-  ~PBKDF2Request() {
-    persistent().Dispose();
-  }
-
-  uv_work_t* work_req() {
-    return &work_req_;
-  }
-
   inline const EVP_MD* digest() const {
     return digest_;
   }
@@ -3687,6 +4513,9 @@ class PBKDF2Request : public AsyncWrap {
   }
 
   inline void release() {
+    // A cancelled request never got to clear them
+    OPENSSL_cleanse(pass_, passlen_);
+    OPENSSL_cleanse(salt_, saltlen_);
     free(pass_);
     passlen_ = 0;
     free(salt_);
@@ -3703,9 +4532,6 @@ class PBKDF2Request : public AsyncWrap {
     error_ = err;
   }
 
-  // TODO(trevnorris): Make private and make work with CONTAINER_OF macro.
-  uv_work_t work_req_;
-
  private:
   const EVP_MD* digest_;
   int error_;
@@ -3719,29 +4545,94 @@ class PBKDF2Request : public AsyncWrap {
 };
 
 
+// Same as PKCS5_PBKDF2_HMAC() but gives up once the request is cancelled.
+// Returns 1 on success like its OpenSSL counterpart.
+static int PBKDF2Cancellable(PBKDF2Request* req) {
+  const EVP_MD* digest = req->digest();
+  const unsigned char* salt = reinterpret_cast<unsigned char*>(req->salt());
+  unsigned char* out = reinterpret_cast<unsigned char*>(req->key());
+  unsigned char digtmp[EVP_MAX_MD_SIZE];
+  unsigned char itmp[4];
+  int mdlen = EVP_MD_size(digest);
+  ssize_t tkeylen = req->keylen();
+  uint32_t block = 1;
+  HMAC_CTX hctx_tpl;
+  HMAC_CTX hctx;
+  int ok = 0;
+
+  if (mdlen <= 0)
+    return 0;
+
+  HMAC_CTX_init(&hctx_tpl);
+  if (!HMAC_Init_ex(&hctx_tpl, req->pass(), req->passlen(), digest, NULL))
+    goto done;
+
+  while (tkeylen > 0) {
+    int cplen = tkeylen > mdlen ? mdlen : static_cast<int>(tkeylen);
+
+    itmp[0] = (block >> 24) & 0xff;
+    itmp[1] = (block >> 16) & 0xff;
+    itmp[2] = (block >> 8) & 0xff;
+    itmp[3] = block & 0xff;
+
+    if (!HMAC_CTX_copy(&hctx, &hctx_tpl))
+      goto done;
+    if (!HMAC_Update(&hctx, salt, req->saltlen()) ||
+        !HMAC_Update(&hctx, itmp, sizeof(itmp)) ||
+        !HMAC_Final(&hctx, digtmp, NULL)) {
+      HMAC_CTX_cleanup(&hctx);
+      goto done;
+    }
+    HMAC_CTX_cleanup(&hctx);
+    memcpy(out, digtmp, cplen);
+
+    for (ssize_t j = 1; j < req->iter(); j++) {
+      if (req->cancelled())
+        goto done;
+      if (!HMAC_CTX_copy(&hctx, &hctx_tpl))
+        goto done;
+      if (!HMAC_Update(&hctx, digtmp, mdlen) ||
+          !HMAC_Final(&hctx, digtmp, NULL)) {
+        HMAC_CTX_cleanup(&hctx);
+        goto done;
+      }
+      HMAC_CTX_cleanup(&hctx);
+      for (int k = 0; k < cplen; k++)
+        out[k] ^= digtmp[k];
+    }
+
+    tkeylen -= cplen;
+    block++;
+    out += cplen;
+  }
+  ok = 1;
+
+ done:
+  HMAC_CTX_cleanup(&hctx_tpl);
+  OPENSSL_cleanse(digtmp, sizeof(digtmp));
+  return ok;
+}
+
+
 void EIO_PBKDF2(PBKDF2Request* req) {
-  req->set_error(PKCS5_PBKDF2_HMAC(
-    req->pass(),
-    req->passlen(),
-    reinterpret_cast<unsigned char*>(req->salt()),
-    req->saltlen(),
-    req->iter(),
-    req->digest(),
-    req->keylen(),
-    reinterpret_cast<unsigned char*>(req->key())));
+  req->set_error(PBKDF2Cancellable(req));
   memset(req->pass(), 0, req->passlen());
   memset(req->salt(), 0, req->saltlen());
 }
 
 
 void EIO_PBKDF2(uv_work_t* work_req) {
-  PBKDF2Request* req = CONTAINER_OF(work_req, PBKDF2Request, work_req_);
+  PBKDF2Request* req = static_cast<PBKDF2Request*>(
+      KDFRequest::from_work_req(work_req));
   EIO_PBKDF2(req);
 }
 
 
 void EIO_PBKDF2After(PBKDF2Request* req, Local<Value> argv[2]) {
-  if (req->error()) {
+  if (req->cancelled()) {
+    argv[0] = UVException(req->env()->isolate(), UV_ECANCELED, "pbkdf2");
+    argv[1] = Undefined(req->env()->isolate());
+  } else if (req->error()) {
     argv[0] = Undefined(req->env()->isolate());
     argv[1] = Encode(req->env()->isolate(), req->key(), req->keylen(), BUFFER);
     memset(req->key(), 0, req->keylen());
@@ -3753,8 +4644,9 @@ void EIO_PBKDF2After(PBKDF2Request* req, Local<Value> argv[2]) {
 
 
 void EIO_PBKDF2After(uv_work_t* work_req, int status) {
-  assert(status == 0);
-  PBKDF2Request* req = CONTAINER_OF(work_req, PBKDF2Request, work_req_);
+  assert(status == 0 || status == UV_ECANCELED);
+  PBKDF2Request* req = static_cast<PBKDF2Request*>(
+      KDFRequest::from_work_req(work_req));
   Environment* env = req->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -3851,7 +4743,7 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
     digest = EVP_sha1();
   }
 
-  obj = Object::New();
+  obj = env->kdf_request_constructor_function()->NewInstance();
   req = new PBKDF2Request(env,
                           obj,
                           digest,
@@ -3867,14 +4759,18 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
     // XXX(trevnorris): This will need to go with the rest of domains.
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  EIO_PBKDF2,
-                  EIO_PBKDF2After);
+    uv_queue_work_class(env->event_loop(),
+                        req->work_req(),
+                        UV_THREADPOOL_SLOW_CPU,
+                        EIO_PBKDF2,
+                        EIO_PBKDF2After);
+    args.GetReturnValue().Set(obj);
   } else {
     Local<Value> argv[2];
     EIO_PBKDF2(req);
     EIO_PBKDF2After(req, argv);
+    req->release();
+    delete req;
     if (argv[0]->IsObject())
       ThrowException(argv[0]);
     else
@@ -3888,12 +4784,375 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
   return env->ThrowTypeError(type_error);
 }
 
-
-// Only instantiate within a valid HandleScope.
-class RandomBytesRequest : public AsyncWrap {
+// scrypt as described in RFC 7914. The memory it needs, 128 * N * r bytes
+// for the lookup table, is what makes it expensive to attack with custom
+// hardware; it's allocated on the pool thread when the derivation starts.
+class ScryptRequest : public KDFRequest {
  public:
-  RandomBytesRequest(Environment* env, Local<Object> object, size_t size)
-      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+  ScryptRequest(Environment* env,
+                Local<Object> object,
+                char* pass,
+                size_t passlen,
+                char* salt,
+                size_t saltlen,
+                uint64_t N,
+                uint32_t r,
+                uint32_t p,
+                size_t keylen)
+      : KDFRequest(env, object),
+        pass_(pass),
+        passlen_(passlen),
+        salt_(salt),
+        saltlen_(saltlen),
+        N_(N),
+        r_(r),
+        p_(p),
+        key_(static_cast<unsigned char*>(malloc(keylen))),
+        keylen_(keylen),
+        error_(NULL) {
+    if (key_ == NULL && keylen != 0)
+      FatalError("node::ScryptRequest()", "Out of Memory");
+  }
+
+  ~ScryptRequest() {
+    OPENSSL_cleanse(pass_, passlen_);
+    OPENSSL_cleanse(salt_, saltlen_);
+    OPENSSL_cleanse(key_, keylen_);
+    free(pass_);
+    free(salt_);
+    free(key_);
+  }
+
+  // Memory used by a derivation with these parameters, or 0 if they're out of
+  // range. N must be a power of two.
+  static uint64_t MemoryNeeded(uint64_t N, uint32_t r, uint32_t p);
+
+  void Derive();
+  static void Work(uv_work_t* work_req);
+  static void After(uv_work_t* work_req, int status);
+  void After(Local<Value> argv[2]);
+
+ private:
+  static void Salsa20_8(uint32_t b[16]);
+  static void BlockMix(uint32_t* b, uint32_t* y, uint32_t r);
+  bool ROMix(uint32_t* x, uint32_t* v, uint32_t* y);
+
+  char* pass_;
+  size_t passlen_;
+  char* salt_;
+  size_t saltlen_;
+  uint64_t N_;
+  uint32_t r_;
+  uint32_t p_;
+  unsigned char* key_;
+  size_t keylen_;
+  const char* error_;
+};
+
+
+uint64_t ScryptRequest::MemoryNeeded(uint64_t N, uint32_t r, uint32_t p) {
+  // N is a power of two, larger than 1 and less than 2^(128 * r / 8). It's
+  // further kept below 2^32, far more than there's memory for anyway.
+  if (N < 2 || (N & (N - 1)) != 0 || N >= (static_cast<uint64_t>(1) << 32))
+    return 0;
+  if (r == 0 || p == 0)
+    return 0;
+  if (r == 1 && N >= (1 << 16))
+    return 0;
+  // p * r <= 2^30 - 1
+  if (static_cast<uint64_t>(r) * p >= (static_cast<uint64_t>(1) << 30))
+    return 0;
+
+  // Lookup table, B, and the X and Y blocks of ROMix()
+  uint64_t block = 128 * static_cast<uint64_t>(r);
+  return block * N + block * p + 2 * block;
+}
+
+
+static inline uint32_t Rotl32(uint32_t a, int b) {
+  return (a << b) | (a >> (32 - b));
+}
+
+
+void ScryptRequest::Salsa20_8(uint32_t b[16]) {
+  uint32_t x[16];
+  memcpy(x, b, sizeof(x));
+
+  for (int i = 0; i < 8; i += 2) {
+    // Columns
+    x[4] ^= Rotl32(x[0] + x[12], 7);
+    x[8] ^= Rotl32(x[4] + x[0], 9);
+    x[12] ^= Rotl32(x[8] + x[4], 13);
+    x[0] ^= Rotl32(x[12] + x[8], 18);
+    x[9] ^= Rotl32(x[5] + x[1], 7);
+    x[13] ^= Rotl32(x[9] + x[5], 9);
+    x[1] ^= Rotl32(x[13] + x[9], 13);
+    x[5] ^= Rotl32(x[1] + x[13], 18);
+    x[14] ^= Rotl32(x[10] + x[6], 7);
+    x[2] ^= Rotl32(x[14] + x[10], 9);
+    x[6] ^= Rotl32(x[2] + x[14], 13);
+    x[10] ^= Rotl32(x[6] + x[2], 18);
+    x[3] ^= Rotl32(x[15] + x[11], 7);
+    x[7] ^= Rotl32(x[3] + x[15], 9);
+    x[11] ^= Rotl32(x[7] + x[3], 13);
+    x[15] ^= Rotl32(x[11] + x[7], 18);
+
+    // Rows
+    x[1] ^= Rotl32(x[0] + x[3], 7);
+    x[2] ^= Rotl32(x[1] + x[0], 9);
+    x[3] ^= Rotl32(x[2] + x[1], 13);
+    x[0] ^= Rotl32(x[3] + x[2], 18);
+    x[6] ^= Rotl32(x[5] + x[4], 7);
+    x[7] ^= Rotl32(x[6] + x[5], 9);
+    x[4] ^= Rotl32(x[7] + x[6], 13);
+    x[5] ^= Rotl32(x[4] + x[7], 18);
+    x[11] ^= Rotl32(x[10] + x[9], 7);
+    x[8] ^= Rotl32(x[11] + x[10], 9);
+    x[9] ^= Rotl32(x[8] + x[11], 13);
+    x[10] ^= Rotl32(x[9] + x[8], 18);
+    x[12] ^= Rotl32(x[15] + x[14], 7);
+    x[13] ^= Rotl32(x[12] + x[15], 9);
+    x[14] ^= Rotl32(x[13] + x[12], 13);
+    x[15] ^= Rotl32(x[14] + x[13], 18);
+  }
+
+  for (int i = 0; i < 16; i++)
+    b[i] += x[i];
+}
+
+
+// `b` is 2 * r 64 byte blocks, `y` scratch space of the same size
+void ScryptRequest::BlockMix(uint32_t* b, uint32_t* y, uint32_t r) {
+  uint32_t x[16];
+  memcpy(x, b + (2 * r - 1) * 16, sizeof(x));
+
+  for (uint32_t i = 0; i < 2 * r; i++) {
+    for (int k = 0; k < 16; k++)
+      x[k] ^= b[i * 16 + k];
+    Salsa20_8(x);
+    memcpy(y + i * 16, x, sizeof(x));
+  }
+
+  // Even blocks go to the first half, odd ones to the second
+  for (uint32_t i = 0; i < r; i++) {
+    memcpy(b + i * 16, y + (2 * i) * 16, sizeof(x));
+    memcpy(b + (i + r) * 16, y + (2 * i + 1) * 16, sizeof(x));
+  }
+}
+
+
+bool ScryptRequest::ROMix(uint32_t* x, uint32_t* v, uint32_t* y) {
+  const size_t words = 32 * r_;
+
+  for (uint64_t i = 0; i < N_; i++) {
+    if (cancelled())
+      return false;
+    memcpy(v + i * words, x, words * sizeof(*x));
+    BlockMix(x, y, r_);
+  }
+
+  for (uint64_t i = 0; i < N_; i++) {
+    if (cancelled())
+      return false;
+    // Integerify(), N < 2^32 so the low word of the last block suffices
+    uint64_t j = x[(2 * r_ - 1) * 16] & (N_ - 1);
+    const uint32_t* vj = v + j * words;
+    for (size_t k = 0; k < words; k++)
+      x[k] ^= vj[k];
+    BlockMix(x, y, r_);
+  }
+
+  return true;
+}
+
+
+void ScryptRequest::Derive() {
+  const size_t words = 32 * r_;
+  const size_t blen = 128 * static_cast<size_t>(r_) * p_;
+  unsigned char* b = static_cast<unsigned char*>(malloc(blen));
+  uint32_t* x = static_cast<uint32_t*>(malloc(2 * words * sizeof(*x)));
+  uint32_t* v = static_cast<uint32_t*>(malloc(N_ * words * sizeof(*v)));
+  uint32_t* y = x + words;
+
+  if (b == NULL || x == NULL || v == NULL) {
+    error_ = "Not enough memory for scrypt";
+    goto done;
+  }
+
+  if (!PKCS5_PBKDF2_HMAC(pass_,
+                         passlen_,
+                         reinterpret_cast<unsigned char*>(salt_),
+                         saltlen_,
+                         1,
+                         EVP_sha256(),
+                         blen,
+                         b)) {
+    error_ = "scrypt failed";
+    goto done;
+  }
+
+  for (uint32_t i = 0; i < p_; i++) {
+    unsigned char* bi = b + i * 128 * static_cast<size_t>(r_);
+
+    for (size_t k = 0; k < words; k++) {
+      const unsigned char* w = bi + k * 4;
+      x[k] = w[0] | (w[1] << 8) | (w[2] << 16) |
+             (static_cast<uint32_t>(w[3]) << 24);
+    }
+
+    if (!ROMix(x, v, y))
+      goto done;
+
+    for (size_t k = 0; k < words; k++) {
+      unsigned char* w = bi + k * 4;
+      w[0] = x[k] & 0xff;
+      w[1] = (x[k] >> 8) & 0xff;
+      w[2] = (x[k] >> 16) & 0xff;
+      w[3] = (x[k] >> 24) & 0xff;
+    }
+  }
+
+  if (!PKCS5_PBKDF2_HMAC(pass_,
+                         passlen_,
+                         b,
+                         blen,
+                         1,
+                         EVP_sha256(),
+                         keylen_,
+                         key_)) {
+    error_ = "scrypt failed";
+  }
+
+ done:
+  if (b != NULL)
+    OPENSSL_cleanse(b, blen);
+  if (x != NULL)
+    OPENSSL_cleanse(x, 2 * words * sizeof(*x));
+  free(b);
+  free(x);
+  free(v);
+  OPENSSL_cleanse(pass_, passlen_);
+  OPENSSL_cleanse(salt_, saltlen_);
+  ERR_clear_error();
+}
+
+
+void ScryptRequest::Work(uv_work_t* work_req) {
+  ScryptRequest* req = static_cast<ScryptRequest*>(
+      KDFRequest::from_work_req(work_req));
+  req->Derive();
+}
+
+
+void ScryptRequest::After(Local<Value> argv[2]) {
+  Isolate* isolate = env()->isolate();
+  if (cancelled()) {
+    argv[0] = UVException(isolate, UV_ECANCELED, "scrypt");
+    argv[1] = Undefined(isolate);
+  } else if (error_ != NULL) {
+    argv[0] = Exception::Error(OneByteString(isolate, error_));
+    argv[1] = Undefined(isolate);
+  } else {
+    argv[0] = Undefined(isolate);
+    argv[1] = Encode(isolate,
+                     reinterpret_cast<const char*>(key_),
+                     keylen_,
+                     BUFFER);
+  }
+}
+
+
+void ScryptRequest::After(uv_work_t* work_req, int status) {
+  assert(status == 0 || status == UV_ECANCELED);
+  ScryptRequest* req = static_cast<ScryptRequest*>(
+      KDFRequest::from_work_req(work_req));
+  Environment* env = req->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[2];
+  req->After(argv);
+  req->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+  delete req;
+}
+
+
+// scrypt(password, salt, keylen, N, r, p, maxmem[, callback])
+void Scrypt(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  ASSERT_IS_BUFFER(args[0]);
+  ASSERT_IS_BUFFER(args[1]);
+
+  if (!args[2]->IsUint32())
+    return env->ThrowTypeError("Bad key length");
+  if (!args[3]->IsNumber() || !args[4]->IsUint32() || !args[5]->IsUint32())
+    return env->ThrowTypeError("Bad scrypt parameters");
+
+  double cost = args[3]->NumberValue();
+  uint64_t N = cost >= 0 && cost < 4294967296. ? cost : 0;
+  uint32_t r = args[4]->Uint32Value();
+  uint32_t p = args[5]->Uint32Value();
+  uint64_t needed = ScryptRequest::MemoryNeeded(N, r, p);
+  if (needed == 0 || N != cost)
+    return env->ThrowRangeError("Invalid scrypt parameters");
+  if (needed > args[6]->NumberValue())
+    return env->ThrowRangeError("scrypt parameters exceed maxmem");
+  // Derive() sizes its buffers with size_t, don't let them wrap around on
+  // 32 bits systems.
+  if (needed > static_cast<size_t>(-1))
+    return env->ThrowRangeError("scrypt parameters exceed address space");
+
+  size_t passlen = Buffer::Length(args[0]);
+  size_t saltlen = Buffer::Length(args[1]);
+  char* pass = static_cast<char*>(malloc(passlen));
+  char* salt = static_cast<char*>(malloc(saltlen));
+  if ((pass == NULL && passlen != 0) || (salt == NULL && saltlen != 0))
+    FatalError("node::Scrypt()", "Out of Memory");
+  memcpy(pass, Buffer::Data(args[0]), passlen);
+  memcpy(salt, Buffer::Data(args[1]), saltlen);
+
+  Local<Object> obj = env->kdf_request_constructor_function()->NewInstance();
+  ScryptRequest* req = new ScryptRequest(env,
+                                         obj,
+                                         pass,
+                                         passlen,
+                                         salt,
+                                         saltlen,
+                                         N,
+                                         r,
+                                         p,
+                                         args[2]->Uint32Value());
+
+  if (args[7]->IsFunction()) {
+    obj->Set(env->ondone_string(), args[7]);
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    uv_queue_work_class(env->event_loop(),
+                        req->work_req(),
+                        UV_THREADPOOL_SLOW_CPU,
+                        ScryptRequest::Work,
+                        ScryptRequest::After);
+    args.GetReturnValue().Set(obj);
+  } else {
+    Local<Value> argv[2];
+    req->Derive();
+    req->After(argv);
+    delete req;
+    if (argv[0]->IsObject())
+      ThrowException(argv[0]);
+    else
+      args.GetReturnValue().Set(argv[1]);
+  }
+}
+
+
+
+// Only instantiate within a valid HandleScope.
+class RandomBytesRequest : public AsyncWrap {
+ public:
+  RandomBytesRequest(Environment* env, Local<Object> object, size_t size)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
         error_(0),
         size_(size),
         data_(static_cast<char*>(malloc(size))) {
@@ -4050,6 +5309,581 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void RandomPool::Initialize(Environment* env, Handle<Object> target) {
+  Local<FunctionTemplate> t = FunctionTemplate::New(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(t, "take", Take);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "RandomPool"),
+              t->GetFunction());
+}
+
+
+void RandomPool::New(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  RandomPool* pool = new RandomPool(env, args.This());
+  pool->Refill();
+}
+
+
+// take(size)
+// Returns a buffer of `size` random bytes, or undefined when the request
+// has to go through randomBytes() instead.
+void RandomPool::Take(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+
+  RandomPool* pool = Unwrap<RandomPool>(args.This());
+
+  if (!args[0]->IsUint32())
+    return;
+
+  size_t size = args[0]->Uint32Value();
+  if (size > kMaxRequest)
+    return;
+
+  Local<Object> buf = Buffer::New(env, size);
+  if (pool->Take(Buffer::Data(buf), size))
+    args.GetReturnValue().Set(buf);
+}
+
+
+bool RandomPool::Take(char* out, size_t size) {
+  if (kBufferSize - offset_ < size) {
+    // Keep the loop thread off RAND_bytes(), let the caller fall back to
+    // the thread pool until the refill lands.
+    if (!spare_ready_) {
+      Refill();
+      return false;
+    }
+
+    unsigned char* tmp = active_;
+    active_ = spare_;
+    spare_ = tmp;
+    offset_ = 0;
+    spare_ready_ = false;
+    Refill();
+  }
+
+  memcpy(out, active_ + offset_, size);
+  // Nothing is handed out twice, and nothing lingers once handed out
+  OPENSSL_cleanse(active_ + offset_, size);
+  offset_ += size;
+  return true;
+}
+
+
+void RandomPool::Refill() {
+  if (refilling_ || spare_ready_)
+    return;
+  refilling_ = true;
+  refill_error_ = false;
+  uv_queue_work(env()->event_loop(), &work_req_, RefillWork, RefillAfter);
+}
+
+
+void RandomPool::RefillWork(uv_work_t* work_req) {
+  RandomPool* pool = CONTAINER_OF(work_req, RandomPool, work_req_);
+  if (RAND_bytes(pool->spare_, kBufferSize) != 1) {
+    pool->refill_error_ = true;
+    ERR_clear_error();
+  }
+}
+
+
+void RandomPool::RefillAfter(uv_work_t* work_req, int status) {
+  assert(status == 0);
+  RandomPool* pool = CONTAINER_OF(work_req, RandomPool, work_req_);
+  pool->refilling_ = false;
+  // On failure requests go through randomBytes(), which reports the error.
+  // The next request that finds the pool short tries again.
+  pool->spare_ready_ = !pool->refill_error_;
+}
+
+
+// One-shot hash or HMAC of a buffer, computed on the thread pool. Inputs
+// larger than `chunk_size` are fed to the digest one chunk per work item so
+// a single large upload doesn't occupy a pool thread for its whole duration.
+// The input buffer is kept alive by the request object but is not copied,
+// it must not be modified until the callback runs.
+class HashRequest : public AsyncWrap {
+ public:
+  HashRequest(Environment* env,
+              Local<Object> object,
+              const EVP_MD* md,
+              const char* data,
+              size_t size,
+              size_t chunk_size)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        hmac_(false),
+        error_(false),
+        data_(data),
+        size_(size),
+        offset_(0),
+        chunk_size_(chunk_size == 0 ? size : chunk_size),
+        md_len_(0) {
+    EVP_MD_CTX_init(&mdctx_);
+    HMAC_CTX_init(&hmac_ctx_);
+  }
+
+  ~HashRequest() {
+    EVP_MD_CTX_cleanup(&mdctx_);
+    HMAC_CTX_cleanup(&hmac_ctx_);
+    persistent().Dispose();
+  }
+
+  bool Init(const char* key, int key_len) {
+    if (key == NULL)
+      return EVP_DigestInit_ex(&mdctx_, md_, NULL) == 1;
+
+    hmac_ = true;
+    // HMAC_Init_ex() treats a NULL key as "reuse the previous key".
+    if (key_len == 0)
+      key = "";
+    return HMAC_Init_ex(&hmac_ctx_, key, key_len, md_, NULL) == 1;
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  // Runs on the thread pool: digests the next chunk, finalizes after the
+  // last one.
+  void Work() {
+    size_t len = size_ - offset_;
+    if (len > chunk_size_)
+      len = chunk_size_;
+
+    const unsigned char* p =
+        reinterpret_cast<const unsigned char*>(data_ + offset_);
+    int ok;
+    if (hmac_)
+      ok = HMAC_Update(&hmac_ctx_, p, len);
+    else
+      ok = EVP_DigestUpdate(&mdctx_, p, len);
+    offset_ += len;
+
+    if (ok && done()) {
+      if (hmac_)
+        ok = HMAC_Final(&hmac_ctx_, md_value_, &md_len_);
+      else
+        ok = EVP_DigestFinal_ex(&mdctx_, md_value_, &md_len_);
+    }
+
+    if (!ok) {
+      error_ = true;
+      offset_ = size_;
+    }
+  }
+
+  inline bool done() const {
+    return offset_ == size_;
+  }
+
+  inline bool error() const {
+    return error_;
+  }
+
+  inline const char* md_value() const {
+    return reinterpret_cast<const char*>(md_value_);
+  }
+
+  inline unsigned int md_len() const {
+    return md_len_;
+  }
+
+  static HashRequest* from_work_req(uv_work_t* work_req) {
+    return CONTAINER_OF(work_req, HashRequest, work_req_);
+  }
+
+ private:
+  uv_work_t work_req_;
+  const EVP_MD* md_;
+  EVP_MD_CTX mdctx_;
+  HMAC_CTX hmac_ctx_;
+  bool hmac_;
+  bool error_;
+  const char* data_;
+  size_t size_;
+  size_t offset_;
+  size_t chunk_size_;
+  unsigned char md_value_[EVP_MAX_MD_SIZE];
+  unsigned int md_len_;
+};
+
+
+void HashWork(uv_work_t* work_req) {
+  HashRequest* req = HashRequest::from_work_req(work_req);
+  req->Work();
+}
+
+
+void HashAfter(uv_work_t* work_req, int status) {
+  assert(status == 0);
+  HashRequest* req = HashRequest::from_work_req(work_req);
+  Environment* env = req->env();
+
+  // Give other pool work a chance to run between chunks.
+  if (!req->done()) {
+    uv_queue_work(env->event_loop(), req->work_req(), HashWork, HashAfter);
+    return;
+  }
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[2];
+  if (req->error()) {
+    argv[0] = Exception::Error(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "Digest failed"));
+    argv[1] = Null(env->isolate());
+  } else {
+    argv[0] = Null(env->isolate());
+    argv[1] = Buffer::New(env, req->md_value(), req->md_len());
+  }
+  req->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+  delete req;
+}
+
+
+// hashAsync(algorithm, data, chunkSize, callback[, key])
+// Computes an HMAC when `key` is a buffer.
+void HashAsync(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Algorithm must be a string");
+  ASSERT_IS_BUFFER(args[1]);
+  if (!args[2]->IsUint32())
+    return env->ThrowTypeError("Chunk size must be a number");
+  if (!args[3]->IsFunction())
+    return env->ThrowTypeError("Callback must be a function");
+  bool hmac = !args[4]->IsUndefined();
+  if (hmac)
+    ASSERT_IS_BUFFER(args[4]);
+
+  const String::Utf8Value algorithm(args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*algorithm);
+  if (md == NULL)
+    return env->ThrowError("Digest method not supported");
+
+  Local<Object> obj = Object::New();
+  obj->Set(env->buffer_string(), args[1]);
+  obj->Set(env->ondone_string(), args[3]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+
+  HashRequest* req = new HashRequest(env,
+                                     obj,
+                                     md,
+                                     Buffer::Data(args[1]),
+                                     Buffer::Length(args[1]),
+                                     args[2]->Uint32Value());
+  bool ok;
+  if (hmac)
+    ok = req->Init(Buffer::Data(args[4]), Buffer::Length(args[4]));
+  else
+    ok = req->Init(NULL, 0);
+  if (!ok) {
+    delete req;
+    unsigned long err = ERR_get_error();
+    if (err)
+      return ThrowCryptoError(env, err);
+    return env->ThrowError("Digest init failed");
+  }
+
+  uv_queue_work(env->event_loop(), req->work_req(), HashWork, HashAfter);
+  args.GetReturnValue().Set(obj);
+}
+
+
+// Digests items [first, last) of a batch into `out`, `md_len` bytes each.
+// Safe to call from the thread pool.
+static bool DigestBatch(const EVP_MD* md,
+                        const char* const* data,
+                        const size_t* size,
+                        unsigned char* out,
+                        size_t md_len,
+                        size_t first,
+                        size_t last) {
+  // One context for the whole run, EVP_DigestInit_ex() only allocates when
+  // the digest changes.
+  EVP_MD_CTX mdctx;
+  EVP_MD_CTX_init(&mdctx);
+
+  bool ok = true;
+  for (size_t i = first; ok && i < last; i++) {
+    ok = EVP_DigestInit_ex(&mdctx, md, NULL) == 1 &&
+         EVP_DigestUpdate(&mdctx, data[i], size[i]) == 1 &&
+         EVP_DigestFinal_ex(&mdctx, out + i * md_len, NULL) == 1;
+  }
+
+  EVP_MD_CTX_cleanup(&mdctx);
+  return ok;
+}
+
+
+class HashBatchRequest : public AsyncWrap {
+ public:
+  // Batches under this size per thread aren't worth splitting up
+  static const size_t kMinPieceSize = 64 * 1024;
+
+  struct Piece {
+    uv_work_t work_req;
+    HashBatchRequest* req;
+    size_t first;
+    size_t last;
+    bool error;
+  };
+
+  HashBatchRequest(Environment* env,
+                   Local<Object> object,
+                   const EVP_MD* md,
+                   const char** data,
+                   size_t* size,
+                   size_t count)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        md_len_(EVP_MD_size(md)),
+        data_(data),
+        size_(size),
+        count_(count),
+        out_(static_cast<char*>(malloc(count * md_len_))),
+        pieces_(NULL),
+        pending_(0),
+        error_(false) {
+  }
+
+  ~HashBatchRequest() {
+    delete[] data_;
+    delete[] size_;
+    delete[] pieces_;
+    free(out_);
+    persistent().Dispose();
+  }
+
+  // Splits the batch by input size and queues the pieces
+  void Queue(size_t pieces) {
+    size_t total = 0;
+    for (size_t i = 0; i < count_; i++)
+      total += size_[i];
+    size_t target = total / pieces + 1;
+
+    pieces_ = new Piece[pieces];
+    size_t first = 0;
+    for (size_t n = 0; n < pieces && first < count_; n++) {
+      size_t last = first;
+      size_t bytes = 0;
+      while (last < count_ && (bytes < target || n + 1 == pieces))
+        bytes += size_[last++];
+
+      Piece* piece = &pieces_[pending_++];
+      piece->req = this;
+      piece->first = first;
+      piece->last = last;
+      piece->error = false;
+      first = last;
+    }
+
+    for (size_t n = 0; n < pending_; n++) {
+      uv_queue_work(env()->event_loop(),
+                    &pieces_[n].work_req,
+                    Work,
+                    After);
+    }
+  }
+
+  static void Work(uv_work_t* work_req) {
+    Piece* piece = CONTAINER_OF(work_req, Piece, work_req);
+    HashBatchRequest* req = piece->req;
+    piece->error = !DigestBatch(req->md_,
+                                req->data_,
+                                req->size_,
+                                reinterpret_cast<unsigned char*>(req->out_),
+                                req->md_len_,
+                                piece->first,
+                                piece->last);
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    assert(status == 0);
+    Piece* piece = CONTAINER_OF(work_req, Piece, work_req);
+    HashBatchRequest* req = piece->req;
+    if (piece->error)
+      req->error_ = true;
+    if (--req->pending_ > 0)
+      return;
+
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[2];
+    if (req->error_) {
+      argv[0] = Exception::Error(
+          FIXED_ONE_BYTE_STRING(env->isolate(), "Digest failed"));
+      argv[1] = Null(env->isolate());
+    } else {
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::Use(env, req->out_, req->count_ * req->md_len_);
+      req->out_ = NULL;
+    }
+    req->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+    delete req;
+  }
+
+ private:
+  const EVP_MD* md_;
+  size_t md_len_;
+  const char** data_;
+  size_t* size_;
+  size_t count_;
+  char* out_;
+  Piece* pieces_;
+  size_t pending_;
+  bool error_;
+};
+
+
+// How many pool threads a batch of `total` bytes is spread over
+static size_t HashBatchPieces(size_t count, size_t total) {
+  size_t max = 4;
+  uv_threadpool_stats_t stats;
+  if (uv_threadpool_stats(&stats) == 0 &&
+      stats.classes[UV_THREADPOOL_CPU].limit > 0) {
+    max = stats.classes[UV_THREADPOOL_CPU].limit;
+  }
+
+  size_t pieces = total / HashBatchRequest::kMinPieceSize;
+  if (pieces > max)
+    pieces = max;
+  if (pieces > count)
+    pieces = count;
+  if (pieces == 0)
+    pieces = 1;
+  return pieces;
+}
+
+
+// hashBatch(algorithm, inputs, offsets[, callback])
+// `inputs` is an array of buffers, or a single buffer cut into items at
+// `offsets`: item i spans [offsets[i], offsets[i + 1]). Returns, or passes
+// to `callback`, one buffer holding all digests back to back.
+void HashBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Algorithm must be a string");
+  bool async = args[3]->IsFunction();
+  if (!async && !args[3]->IsUndefined())
+    return env->ThrowTypeError("Callback must be a function");
+
+  const String::Utf8Value algorithm(args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*algorithm);
+  if (md == NULL)
+    return env->ThrowError("Digest method not supported");
+
+  size_t count;
+  const char** data;
+  size_t* size;
+  size_t total = 0;
+  Local<Value> keep;
+
+  if (args[1]->IsArray()) {
+    Local<Array> inputs = args[1].As<Array>();
+    count = inputs->Length();
+    // The caller may change the array, hold on to the buffers themselves
+    Local<Array> copy = Array::New(count);
+    data = new const char*[count];
+    size = new size_t[count];
+    for (size_t i = 0; i < count; i++) {
+      Local<Value> input = inputs->Get(i);
+      if (!Buffer::HasInstance(input)) {
+        delete[] data;
+        delete[] size;
+        return env->ThrowTypeError("Inputs must be buffers");
+      }
+      copy->Set(i, input);
+      data[i] = Buffer::Data(input);
+      size[i] = Buffer::Length(input);
+      total += size[i];
+    }
+    keep = copy;
+  } else {
+    ASSERT_IS_BUFFER(args[1]);
+    if (!args[2]->IsObject())
+      return env->ThrowTypeError("Offsets must be an array");
+
+    Local<Object> offsets = args[2].As<Object>();
+    uint32_t length = offsets->Get(env->length_string())->Uint32Value();
+    if (length == 0)
+      return env->ThrowRangeError("Offsets must not be empty");
+
+    const char* base = Buffer::Data(args[1]);
+    size_t base_len = Buffer::Length(args[1]);
+    count = length - 1;
+    data = new const char*[count];
+    size = new size_t[count];
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> value = offsets->Get(i);
+      uint32_t off = value->Uint32Value();
+      if (!value->IsUint32() || off > base_len || (i > 0 && off < prev)) {
+        delete[] data;
+        delete[] size;
+        return env->ThrowRangeError("Bad offsets");
+      }
+      if (i > 0) {
+        data[i - 1] = base + prev;
+        size[i - 1] = off - prev;
+      }
+      prev = off;
+    }
+    total = prev - offsets->Get(0)->Uint32Value();
+    keep = args[1];
+  }
+
+  size_t md_len = EVP_MD_size(md);
+
+  if (!async) {
+    Local<Object> out = Buffer::New(env, count * md_len);
+    bool ok = DigestBatch(md,
+                          data,
+                          size,
+                          reinterpret_cast<unsigned char*>(Buffer::Data(out)),
+                          md_len,
+                          0,
+                          count);
+    delete[] data;
+    delete[] size;
+    if (!ok)
+      return env->ThrowError("Digest failed");
+    return args.GetReturnValue().Set(out);
+  }
+
+  if (count == 0) {
+    delete[] data;
+    delete[] size;
+    return env->ThrowRangeError("Nothing to digest");
+  }
+
+  Local<Object> obj = Object::New();
+  obj->Set(env->buffer_string(), keep);
+  obj->Set(env->ondone_string(), args[3]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+
+  HashBatchRequest* req =
+      new HashBatchRequest(env, obj, md, data, size, count);
+  req->Queue(HashBatchPieces(count, total));
+  args.GetReturnValue().Set(obj);
+}
+
+
 void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
   HandleScope scope(env->isolate());
@@ -4080,6 +5914,22 @@ void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Removes a shared session cache segment. Returns false if there was none.
+void UnlinkSharedSessionCache(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() != 1 || !args[0]->IsString())
+    return env->ThrowTypeError("Bad parameter");
+
+  const String::Utf8Value name(args[0]);
+  int err = SharedSessionCache::Unlink(*name);
+  if (err != 0 && err != ENOENT)
+    return env->ThrowErrnoException(err, "shm_unlink", NULL, *name);
+  args.GetReturnValue().Set(err == 0);
+}
+
+
 class CipherPushContext {
  public:
   explicit CipherPushContext(Environment* env) : arr(Array::New()), env_(env) {
@@ -4394,19 +6244,31 @@ void InitCrypto(Handle<Object> target,
   Connection::Initialize(env, target);
   CipherBase::Initialize(env, target);
   DiffieHellman::Initialize(env, target);
+  ECDH::Initialize(env, target);
   Hmac::Initialize(env, target);
   Hash::Initialize(env, target);
+  KeyObject::Initialize(env, target);
   Sign::Initialize(env, target);
   Verify::Initialize(env, target);
+  RandomPool::Initialize(env, target);
   Certificate::Initialize(env, target);
+  KDFRequest::Initialize(env, target);
 
 #ifndef OPENSSL_NO_ENGINE
   NODE_SET_METHOD(target, "setEngine", SetEngine);
 #endif  // !OPENSSL_NO_ENGINE
   NODE_SET_METHOD(target, "PBKDF2", PBKDF2);
+  NODE_SET_METHOD(target, "scrypt", Scrypt);
+  NODE_SET_METHOD(target, "hashAsync", HashAsync);
+  NODE_SET_METHOD(target, "hashBatch", HashBatch);
+  NODE_SET_METHOD(target, "sign", SignOneShot);
+  NODE_SET_METHOD(target, "verify", VerifyOneShot);
   NODE_SET_METHOD(target, "randomBytes", RandomBytes<false>);
   NODE_SET_METHOD(target, "pseudoRandomBytes", RandomBytes<true>);
   NODE_SET_METHOD(target, "getSSLCiphers", GetSSLCiphers);
+  NODE_SET_METHOD(target,
+                  "unlinkSharedSessionCache",
+                  UnlinkSharedSessionCache);
   NODE_SET_METHOD(target, "getCiphers", GetCiphers);
   NODE_SET_METHOD(target, "getHashes", GetHashes);
 }
@@ -50,6 +50,8 @@
 #include <openssl/hmac.h>
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
+#include <openssl/ec.h>
+#include <openssl/ecdh.h>
 
 #define EVP_F_EVP_DECRYPTFINAL 101
 
@@ -97,6 +99,11 @@ class SecureContext : public BaseObject {
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSessionCache(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSharedSessionCache(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetSessionCacheStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   SecureContext(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap),
@@ -138,7 +145,8 @@ class SSLWrap {
         kind_(kind),
         next_sess_(NULL),
         session_callbacks_(false),
-        new_session_wait_(false) {
+        new_session_wait_(false),
+        ssl_offloaded_(false) {
     ssl_ = SSL_new(sc->ctx_);
     assert(ssl_ != NULL);
   }
@@ -217,12 +225,22 @@ class SSLWrap {
     return env_;
   }
 
+  // The JS methods call this before touching `ssl_`, which belongs to the
+  // thread pool while it runs a handshake step. Throws and returns true then.
+  inline bool ThrowIfSSLOffloaded() const {
+    if (!ssl_offloaded_)
+      return false;
+    env_->ThrowError("SSL handshake in progress on the thread pool");
+    return true;
+  }
+
   Environment* const env_;
   Kind kind_;
   SSL_SESSION* next_sess_;
   SSL* ssl_;
   bool session_callbacks_;
   bool new_session_wait_;
+  bool ssl_offloaded_;
   ClientHelloParser hello_parser_;
 
 #ifdef OPENSSL_NPN_NEGOTIATED
@@ -350,6 +368,10 @@ class CipherBase : public BaseObject {
               const char* iv,
               int iv_len);
   bool Update(const char* data, int len, unsigned char** out, int* out_len);
+  bool UpdateInto(const char* data,
+                  int len,
+                  unsigned char* out,
+                  int* out_len);
   bool Final(unsigned char** out, int *out_len);
   bool SetAutoPadding(bool auto_padding);
 
@@ -361,6 +383,7 @@ class CipherBase : public BaseObject {
   static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InitIv(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateInto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -452,6 +475,49 @@ class Hash : public BaseObject {
   bool initialised_;
 };
 
+// A private or public key parsed once and shared by any number of Sign and
+// Verify operations, so hot paths don't pay for PEM and ASN.1 decoding on
+// every call.
+class KeyObject : public BaseObject {
+ public:
+  ~KeyObject() {
+    if (pkey_ != NULL)
+      EVP_PKEY_free(pkey_);
+  }
+
+  static void Initialize(Environment* env, v8::Handle<v8::Object> target);
+
+  bool Init(const char* key_pem,
+            int key_pem_len,
+            bool is_private,
+            const char* passphrase);
+
+  inline EVP_PKEY* pkey() const {
+    return pkey_;
+  }
+
+  inline bool is_private() const {
+    return is_private_;
+  }
+
+ protected:
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetKeyType(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetKeySize(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  KeyObject(Environment* env, v8::Local<v8::Object> wrap)
+      : BaseObject(env, wrap),
+        pkey_(NULL),
+        is_private_(false) {
+    MakeWeak<KeyObject>(this);
+  }
+
+ private:
+  EVP_PKEY* pkey_;
+  bool is_private_;
+};
+
 class SignBase : public BaseObject {
  public:
   typedef enum {
@@ -496,6 +562,7 @@ class Sign : public SignBase {
                   const char* passphrase,
                   unsigned char** sig,
                   unsigned int *sig_len);
+  Error SignFinal(EVP_PKEY* pkey, unsigned char** sig, unsigned int *sig_len);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -519,6 +586,10 @@ class Verify : public SignBase {
                     const char* sig,
                     int siglen,
                     bool* verify_result);
+  Error VerifyFinal(EVP_PKEY* pkey,
+                    const char* sig,
+                    int siglen,
+                    bool* verify_result);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -577,6 +648,90 @@ class DiffieHellman : public BaseObject {
   DH* dh;
 };
 
+class ECDH : public BaseObject {
+ public:
+  ~ECDH() {
+    if (key_ != NULL)
+      EC_KEY_free(key_);
+    key_ = NULL;
+    group_ = NULL;
+  }
+
+  static void Initialize(Environment* env, v8::Handle<v8::Object> target);
+
+ protected:
+  ECDH(Environment* env, v8::Local<v8::Object> wrap, EC_KEY* key)
+      : BaseObject(env, wrap),
+        key_(key),
+        group_(EC_KEY_get0_group(key_)) {
+    MakeWeak<ECDH>(this);
+    assert(group_ != NULL);
+  }
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GenerateKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ComputeSecret(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetPrivateKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetPrivateKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetPublicKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetPublicKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  EC_POINT* BufferToPoint(char* data, size_t len);
+
+  EC_KEY* key_;
+  const EC_GROUP* group_;
+};
+
+// Strong random bytes, filled ahead of time on the thread pool, for small
+// asynchronous randomBytes() requests. One buffer is served from while the
+// other is refilled, so there's at most one pool job in flight no matter how
+// many requests come in.
+class RandomPool : public BaseObject {
+ public:
+  ~RandomPool() {
+    OPENSSL_cleanse(active_, kBufferSize);
+    OPENSSL_cleanse(spare_, kBufferSize);
+    delete[] active_;
+    delete[] spare_;
+  }
+
+  static void Initialize(Environment* env, v8::Handle<v8::Object> target);
+
+  // Requests larger than this aren't served from the pool
+  static const size_t kMaxRequest = 256;
+  static const size_t kBufferSize = 32 * 1024;
+
+ protected:
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Take(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Not weak: the pool lives as long as the crypto module that made it, and
+  // a refill may be running on the thread pool.
+  RandomPool(Environment* env, v8::Local<v8::Object> wrap)
+      : BaseObject(env, wrap),
+        active_(new unsigned char[kBufferSize]),
+        spare_(new unsigned char[kBufferSize]),
+        offset_(kBufferSize),
+        spare_ready_(false),
+        refilling_(false),
+        refill_error_(false) {
+  }
+
+  bool Take(char* out, size_t size);
+  void Refill();
+  static void RefillWork(uv_work_t* work_req);
+  static void RefillAfter(uv_work_t* work_req, int status);
+
+ private:
+  unsigned char* active_;
+  unsigned char* spare_;
+  size_t offset_;  // Bytes of active_ handed out so far
+  bool spare_ready_;
+  bool refilling_;
+  bool refill_error_;
+  uv_work_t work_req_;
+};
+
 class Certificate : public AsyncWrap {
  public:
   static void Initialize(Environment* env, v8::Handle<v8::Object> target);
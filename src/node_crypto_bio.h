@@ -27,22 +27,38 @@
 
 namespace node {
 
+// Forward declaration
+class Environment;
+
 class NodeBIO {
  public:
-  NodeBIO() : length_(0), read_head_(&head_), write_head_(&head_) {
-    // Loop head
-    head_.next_ = &head_;
+  NodeBIO() : env_(NULL),
+              initial_(kInitialBufferLength),
+              length_(0),
+              read_head_(NULL),
+              write_head_(NULL) {
   }
 
   ~NodeBIO();
 
   static BIO* New();
 
+  // Recycle buffers through `env`'s chunk freelist. Pass NULL while the BIO
+  // is used off the event loop thread.
+  inline void AssignEnvironment(Environment* env) {
+    env_ = env;
+  }
+
+  // Size of the first buffer, later buffers grow from there as data piles up
+  inline void set_initial(size_t initial) {
+    initial_ = initial;
+  }
+
   // Move read head to next buffer if needed
   void TryMoveReadHead();
 
   // Allocate new buffer for write if needed
-  void TryAllocateForWrite();
+  void TryAllocateForWrite(size_t hint);
 
   // Read `len` bytes maximum into `out`, return actual number of read bytes
   size_t Read(char* out, size_t size);
@@ -86,6 +102,15 @@ class NodeBIO {
     return static_cast<NodeBIO*>(bio->ptr);
   }
 
+  // Buffers start small, short exchanges like a PEM file or a single record
+  // don't need more. Each buffer added to a full ring is four times the size
+  // of the previous one, up to kThroughputBufferLength.
+  static const size_t kInitialBufferLength = 1024;
+
+  // NOTE: Size is maximum TLS frame length, this is required if we want
+  // to fit whole ClientHello into one Buffer of NodeBIO.
+  static const size_t kThroughputBufferLength = 16 * 1024 + 5;
+
  private:
   static int New(BIO* bio);
   static int Free(BIO* bio);
@@ -95,24 +120,24 @@ class NodeBIO {
   static int Gets(BIO* bio, char* out, int size);
   static long Ctrl(BIO* bio, int cmd, long num, void* ptr);
 
-  // NOTE: Size is maximum TLS frame length, this is required if we want
-  // to fit whole ClientHello into one Buffer of NodeBIO.
-  static const size_t kBufferLength = 16 * 1024 + 5;
   static const BIO_METHOD method;
 
+  // Allocated in one go with its data, which directly follows the header.
   class Buffer {
    public:
-    Buffer() : read_pos_(0), write_pos_(0), next_(NULL) {
-    }
-
     size_t read_pos_;
     size_t write_pos_;
+    size_t len_;
     Buffer* next_;
-    char data_[kBufferLength];
+    char* data_;
   };
 
+  Buffer* NewBuffer(size_t len);
+  void DeleteBuffer(Buffer* buffer);
+
+  Environment* env_;
+  size_t initial_;
   size_t length_;
-  Buffer head_;
   Buffer* read_head_;
   Buffer* write_head_;
 };
@@ -0,0 +1,628 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "node_crypto_session_cache.h"
+#include "node.h"  // STATIC_ASSERT
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+namespace node {
+namespace crypto {
+
+int SharedSessionCache::ex_index_ = -1;
+
+
+bool SharedSessionCache::Attach(SSL_CTX* ctx, SharedSessionCache* cache) {
+  if (ex_index_ == -1) {
+    ex_index_ = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, FreeCallback);
+    if (ex_index_ == -1)
+      return false;
+  }
+  delete FromContext(ctx);
+  return SSL_CTX_set_ex_data(ctx, ex_index_, cache) == 1;
+}
+
+
+SharedSessionCache* SharedSessionCache::FromContext(SSL_CTX* ctx) {
+  if (ex_index_ == -1)
+    return NULL;
+  return static_cast<SharedSessionCache*>(SSL_CTX_get_ex_data(ctx, ex_index_));
+}
+
+
+void SharedSessionCache::FreeCallback(void* parent,
+                                      void* ptr,
+                                      CRYPTO_EX_DATA* ad,
+                                      int idx,
+                                      long argl,  // NOLINT(runtime/int)
+                                      void* argp) {
+  delete static_cast<SharedSessionCache*>(ptr);
+}
+
+#ifndef _WIN32
+
+static const uint32_t kMagic = 0x6e545343;
+static const uint32_t kVersion = 2;
+static const unsigned int kMaxOwners = 64;
+
+struct SharedSessionCache::Header {
+  volatile uint32_t magic;
+  uint32_t version;
+  uint32_t sets;
+  uint32_t ways;
+  // Bumped on every access, orders the slots of a set by recency.
+  uint64_t clock;
+  // Pids of the processes that have the segment open, one entry per open.
+  // Zero marks a free entry.
+  int32_t owners[kMaxOwners];
+  pthread_mutex_t mutex;
+};
+
+struct SharedSessionCache::Slot {
+  uint64_t last_used;
+  // Absolute expiry time in seconds, zero for a free slot.
+  int64_t expires;
+  uint32_t der_len;
+  uint32_t id_len;
+  unsigned char id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+  unsigned char der[kSlotSize - 24 - SSL_MAX_SSL_SESSION_ID_LENGTH];
+};
+
+// Slots start on a cache line boundary.
+static const size_t kHeaderSize = 512;
+
+// Caches that are still open, detached at exit.
+static QUEUE open_caches = { &open_caches, &open_caches };
+
+
+static inline void AtomicIncrement(uint64_t* counter) {
+  __sync_fetch_and_add(counter, 1);
+}
+
+
+static inline uint64_t AtomicLoad(const uint64_t* counter) {
+  return __sync_fetch_and_add(const_cast<uint64_t*>(counter), 0);
+}
+
+
+static bool SegmentPath(const char* name, char* path, size_t len) {
+  if (*name == '\0' || strchr(name, '/') != NULL)
+    return false;
+  return snprintf(path, len, "/node-tls-%s", name) < static_cast<int>(len);
+}
+
+
+static bool IsAlive(pid_t pid) {
+  return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+
+// Forgets owners that exited without detaching. Returns the number of
+// owners left. Called with the lock held.
+static unsigned int PruneOwners(int32_t* owners) {
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < kMaxOwners; i++) {
+    if (owners[i] == 0)
+      continue;
+    if (IsAlive(owners[i]))
+      count++;
+    else
+      owners[i] = 0;
+  }
+  return count;
+}
+
+
+static bool AddOwner(int32_t* owners, pid_t pid) {
+  for (unsigned int i = 0; i < kMaxOwners; i++) {
+    if (owners[i] == 0) {
+      owners[i] = pid;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+static void RemoveOwner(int32_t* owners, pid_t pid) {
+  for (unsigned int i = 0; i < kMaxOwners; i++) {
+    if (owners[i] == pid) {
+      owners[i] = 0;
+      return;
+    }
+  }
+}
+
+
+SharedSessionCache* SharedSessionCache::Open(const char* name,
+                                             size_t entries,
+                                             int* err,
+                                             const char** syscall) {
+  STATIC_ASSERT(sizeof(Header) <= kHeaderSize);
+
+  char path[sizeof(path_)];
+  if (!SegmentPath(name, path, sizeof(path))) {
+    *err = EINVAL;
+    *syscall = "shm_open";
+    return NULL;
+  }
+
+  size_t sets = (entries + kWays - 1) / kWays;
+  if (sets == 0)
+    sets = 1;
+
+  bool stale;
+  SharedSessionCache* cache = TryOpen(path, sets, &stale, err, syscall);
+  if (cache == NULL && stale) {
+    // Don't hand out sessions of processes that are gone and don't try to
+    // make sense of a layout that isn't ours, start over.
+    shm_unlink(path);
+    cache = TryOpen(path, sets, &stale, err, syscall);
+    if (cache == NULL && stale) {
+      *err = EBUSY;
+      *syscall = "shm_open";
+    }
+  }
+  return cache;
+}
+
+
+SharedSessionCache* SharedSessionCache::TryOpen(const char* path,
+                                                size_t sets,
+                                                bool* stale,
+                                                int* err,
+                                                const char** syscall) {
+  size_t size = kHeaderSize + sets * kWays * sizeof(Slot);
+  *stale = false;
+
+  bool created = true;
+  int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd == -1 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(path, O_RDWR, 0600);
+  }
+  if (fd == -1) {
+    *err = errno;
+    *syscall = "shm_open";
+    return NULL;
+  }
+
+  struct stat s;
+  if (created) {
+    if (ftruncate(fd, size)) {
+      *err = errno;
+      *syscall = "ftruncate";
+      close(fd);
+      shm_unlink(path);
+      return NULL;
+    }
+  } else {
+    // Another process created the segment, give it a moment to size it.
+    for (int i = 0; i < 1000; i++) {
+      if (fstat(fd, &s)) {
+        *err = errno;
+        *syscall = "fstat";
+        close(fd);
+        return NULL;
+      }
+      if (s.st_size != 0)
+        break;
+      usleep(1000);
+    }
+    if (static_cast<size_t>(s.st_size) != size) {
+      close(fd);
+      *stale = true;
+      return NULL;
+    }
+  }
+
+  if (fstat(fd, &s)) {
+    *err = errno;
+    *syscall = "fstat";
+    close(fd);
+    if (created)
+      shm_unlink(path);
+    return NULL;
+  }
+
+  void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    *err = errno;
+    *syscall = "mmap";
+    if (created)
+      shm_unlink(path);
+    return NULL;
+  }
+
+  Header* header = static_cast<Header*>(base);
+  SharedSessionCache* cache = new SharedSessionCache(path, base, size);
+  cache->dev_ = s.st_dev;
+  cache->ino_ = s.st_ino;
+
+  if (created) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+    // Don't let a worker that dies while holding the lock wedge the others.
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif  // __linux__
+    pthread_mutex_init(&header->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    header->version = kVersion;
+    header->sets = sets;
+    header->ways = kWays;
+    header->clock = 0;
+    // Register before publishing the header so nobody takes the segment for
+    // an abandoned one.
+    header->owners[0] = getpid();
+    __sync_synchronize();
+    header->magic = kMagic;
+  } else {
+    for (int i = 0; i < 1000 && header->magic != kMagic; i++)
+      usleep(1000);
+    __sync_synchronize();
+
+    if (header->magic != kMagic ||
+        header->version != kVersion ||
+        header->ways != kWays ||
+        header->sets != sets) {
+      cache->detached_ = true;
+      delete cache;
+      *stale = true;
+      return NULL;
+    }
+
+    bool owned = false;
+    if (cache->Lock()) {
+      if (PruneOwners(header->owners) != 0)
+        owned = AddOwner(header->owners, getpid());
+      else
+        *stale = true;
+      cache->Unlock();
+    }
+    if (!owned) {
+      cache->detached_ = true;
+      delete cache;
+      if (!*stale) {
+        *err = EUSERS;
+        *syscall = "shm_open";
+      }
+      return NULL;
+    }
+  }
+
+  if (QUEUE_EMPTY(&open_caches))
+    atexit(DetachAll);
+  QUEUE_INSERT_TAIL(&open_caches, &cache->member_);
+  return cache;
+}
+
+
+int SharedSessionCache::Unlink(const char* name) {
+  char path[sizeof(path_)];
+  if (!SegmentPath(name, path, sizeof(path)))
+    return EINVAL;
+  if (shm_unlink(path))
+    return errno;
+  return 0;
+}
+
+
+SharedSessionCache::SharedSessionCache(const char* path,
+                                       void* base,
+                                       size_t size)
+    : dev_(0),
+      ino_(0),
+      detached_(false),
+      base_(base),
+      size_(size),
+      header_(static_cast<Header*>(base)),
+      slots_(reinterpret_cast<Slot*>(static_cast<char*>(base) + kHeaderSize)),
+      hits_(0),
+      misses_(0),
+      stores_(0),
+      evictions_(0) {
+  snprintf(path_, sizeof(path_), "%s", path);
+  QUEUE_INIT(&member_);
+}
+
+
+SharedSessionCache::~SharedSessionCache() {
+  Detach();
+  munmap(base_, size_);
+}
+
+
+void SharedSessionCache::Detach() {
+  if (detached_)
+    return;
+  detached_ = true;
+  QUEUE_REMOVE(&member_);
+  QUEUE_INIT(&member_);
+
+  bool last = false;
+  if (Lock()) {
+    RemoveOwner(header_->owners, getpid());
+    last = PruneOwners(header_->owners) == 0;
+    Unlock();
+  }
+  if (!last)
+    return;
+
+  // Only unlink the name if it still refers to our segment, it may have
+  // been unlinked and reused by a process that wanted a different layout.
+  int fd = shm_open(path_, O_RDONLY, 0);
+  if (fd == -1)
+    return;
+  struct stat s;
+  if (fstat(fd, &s) == 0 &&
+      static_cast<uint64_t>(s.st_dev) == dev_ &&
+      static_cast<uint64_t>(s.st_ino) == ino_) {
+    shm_unlink(path_);
+  }
+  close(fd);
+}
+
+
+void SharedSessionCache::DetachAll() {
+  while (!QUEUE_EMPTY(&open_caches)) {
+    QUEUE* q = QUEUE_HEAD(&open_caches);
+    QUEUE_DATA(q, SharedSessionCache, member_)->Detach();
+  }
+}
+
+
+size_t SharedSessionCache::capacity() const {
+  return header_->sets * kWays;
+}
+
+
+uint64_t SharedSessionCache::hits() const {
+  return AtomicLoad(&hits_);
+}
+
+
+uint64_t SharedSessionCache::misses() const {
+  return AtomicLoad(&misses_);
+}
+
+
+uint64_t SharedSessionCache::stores() const {
+  return AtomicLoad(&stores_);
+}
+
+
+uint64_t SharedSessionCache::evictions() const {
+  return AtomicLoad(&evictions_);
+}
+
+
+bool SharedSessionCache::Lock() {
+  int r = pthread_mutex_lock(&header_->mutex);
+#ifdef __linux__
+  if (r == EOWNERDEAD) {
+    // The previous owner died, possibly half way through writing a slot.
+    memset(slots_, 0, capacity() * sizeof(*slots_));
+    pthread_mutex_consistent(&header_->mutex);
+    r = 0;
+  }
+#endif  // __linux__
+  return r == 0;
+}
+
+
+void SharedSessionCache::Unlock() {
+  pthread_mutex_unlock(&header_->mutex);
+}
+
+
+SharedSessionCache::Slot* SharedSessionCache::SetOf(const unsigned char* id,
+                                                    unsigned int id_len) {
+  // FNV-1a, session ids are random but lookups use whatever the client sent.
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < id_len; i++) {
+    hash ^= id[i];
+    hash *= 16777619u;
+  }
+  return slots_ + (hash % header_->sets) * kWays;
+}
+
+
+SharedSessionCache::Slot* SharedSessionCache::FindSlot(
+    const unsigned char* id,
+    unsigned int id_len) {
+  Slot* set = SetOf(id, id_len);
+  for (unsigned int i = 0; i < kWays; i++) {
+    Slot* slot = set + i;
+    if (slot->expires != 0 &&
+        slot->id_len == id_len &&
+        memcmp(slot->id, id, id_len) == 0) {
+      return slot;
+    }
+  }
+  return NULL;
+}
+
+
+bool SharedSessionCache::Store(SSL_SESSION* sess) {
+  unsigned int id_len = sess->session_id_length;
+  if (id_len == 0 || id_len > sizeof(slots_->id))
+    return false;
+
+  int der_len = i2d_SSL_SESSION(sess, NULL);
+  if (der_len <= 0 || static_cast<size_t>(der_len) > sizeof(slots_->der))
+    return false;
+
+  int64_t now = time(NULL);
+  int64_t expires = SSL_SESSION_get_time(sess) + SSL_SESSION_get_timeout(sess);
+  if (expires <= now)
+    return false;
+
+  if (!Lock())
+    return false;
+
+  // Reuse the slot of the same session, else a free or expired slot, else
+  // evict the least recently used one.
+  Slot* victim = FindSlot(sess->session_id, id_len);
+  if (victim == NULL) {
+    Slot* set = SetOf(sess->session_id, id_len);
+    for (unsigned int i = 0; i < kWays; i++) {
+      Slot* slot = set + i;
+      if (slot->expires < now) {
+        victim = slot;
+        break;
+      }
+      if (victim == NULL || slot->last_used < victim->last_used)
+        victim = slot;
+    }
+    if (victim->expires >= now)
+      AtomicIncrement(&evictions_);
+  }
+
+  unsigned char* p = victim->der;
+  i2d_SSL_SESSION(sess, &p);
+  victim->der_len = der_len;
+  memcpy(victim->id, sess->session_id, id_len);
+  victim->id_len = id_len;
+  victim->expires = expires;
+  victim->last_used = ++header_->clock;
+
+  Unlock();
+  AtomicIncrement(&stores_);
+  return true;
+}
+
+
+SSL_SESSION* SharedSessionCache::Lookup(const unsigned char* id,
+                                        unsigned int id_len) {
+  unsigned char der[sizeof(slots_->der)];
+  unsigned int der_len = 0;
+
+  if (id_len != 0 && id_len <= sizeof(slots_->id) && Lock()) {
+    Slot* slot = FindSlot(id, id_len);
+    if (slot != NULL) {
+      if (slot->expires < time(NULL)) {
+        slot->expires = 0;
+      } else {
+        der_len = slot->der_len;
+        memcpy(der, slot->der, der_len);
+        slot->last_used = ++header_->clock;
+      }
+    }
+    Unlock();
+  }
+
+  // Decode outside of the lock.
+  SSL_SESSION* sess = NULL;
+  if (der_len != 0) {
+    const unsigned char* p = der;
+    sess = d2i_SSL_SESSION(NULL, &p, der_len);
+  }
+
+  if (sess == NULL)
+    AtomicIncrement(&misses_);
+  else
+    AtomicIncrement(&hits_);
+  return sess;
+}
+
+
+#else  // _WIN32
+
+SharedSessionCache* SharedSessionCache::Open(const char* name,
+                                             size_t entries,
+                                             int* err,
+                                             const char** syscall) {
+  *err = ENOSYS;
+  *syscall = "shm_open";
+  return NULL;
+}
+
+
+int SharedSessionCache::Unlink(const char* name) {
+  return ENOSYS;
+}
+
+
+SharedSessionCache::~SharedSessionCache() {
+}
+
+
+void SharedSessionCache::Detach() {
+}
+
+
+size_t SharedSessionCache::capacity() const {
+  return 0;
+}
+
+
+uint64_t SharedSessionCache::hits() const {
+  return 0;
+}
+
+
+uint64_t SharedSessionCache::misses() const {
+  return 0;
+}
+
+
+uint64_t SharedSessionCache::stores() const {
+  return 0;
+}
+
+
+uint64_t SharedSessionCache::evictions() const {
+  return 0;
+}
+
+
+bool SharedSessionCache::Store(SSL_SESSION* sess) {
+  return false;
+}
+
+
+SSL_SESSION* SharedSessionCache::Lookup(const unsigned char* id,
+                                        unsigned int id_len) {
+  return NULL;
+}
+
+#endif  // _WIN32
+
+}  // namespace crypto
+}  // namespace node
@@ -0,0 +1,129 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#include "queue.h"
+#include "openssl/ssl.h"
+
+#include <stddef.h>  // size_t
+#include <stdint.h>
+
+namespace node {
+namespace crypto {
+
+// Server session cache kept in a named shared memory segment, so processes
+// on the same host (cluster workers, typically) can resume each other's
+// sessions. The segment is a fixed size, set associative table: a session
+// id hashes to a set of kWays slots and a full set evicts its least recently
+// used slot. Sessions that don't fit into a slot are not cached.
+//
+// The segment holds session master secrets. It is only accessible to the
+// user that created it and is removed when the last process that has it
+// open detaches, or explicitly with Unlink().
+class SharedSessionCache {
+ public:
+  // Opens the segment `name`, creating it with room for about `entries`
+  // sessions if it doesn't exist yet. A segment that is left over from
+  // processes that are gone or that was laid out for a different size or
+  // version is replaced. Returns NULL and sets `*err` to an errno value on
+  // failure, `*syscall` names the call that failed.
+  static SharedSessionCache* Open(const char* name,
+                                  size_t entries,
+                                  int* err,
+                                  const char** syscall);
+  // Removes the segment `name`. Processes that have it open keep using
+  // their mapping, new ones get a fresh segment. Returns 0 or an errno value.
+  static int Unlink(const char* name);
+  ~SharedSessionCache();
+
+  // Drops this process' claim on the segment and unlinks the segment if no
+  // other process has it open. Called by the destructor and at exit.
+  void Detach();
+
+  // The context owns the cache from then on, it is freed with the context.
+  // On failure the caller still owns `cache`.
+  static bool Attach(SSL_CTX* ctx, SharedSessionCache* cache);
+  static SharedSessionCache* FromContext(SSL_CTX* ctx);
+
+  bool Store(SSL_SESSION* sess);
+  // Returns a new reference, NULL on a miss.
+  SSL_SESSION* Lookup(const unsigned char* id, unsigned int id_len);
+
+  // With asyncHandshake, Store() and Lookup() run on the thread pool. The
+  // counters are updated and read atomically.
+  uint64_t hits() const;
+  uint64_t misses() const;
+  uint64_t stores() const;
+  uint64_t evictions() const;
+  size_t capacity() const;
+
+  static const unsigned int kWays = 8;
+  static const size_t kSlotSize = 2048;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  SharedSessionCache(const char* path, void* base, size_t size);
+
+  static SharedSessionCache* TryOpen(const char* path,
+                                     size_t sets,
+                                     bool* stale,
+                                     int* err,
+                                     const char** syscall);
+  static void DetachAll();
+
+  static void FreeCallback(void* parent,
+                           void* ptr,
+                           CRYPTO_EX_DATA* ad,
+                           int idx,
+                           long argl,  // NOLINT(runtime/int)
+                           void* argp);
+  static int ex_index_;
+
+  bool Lock();
+  void Unlock();
+  Slot* FindSlot(const unsigned char* id, unsigned int id_len);
+  Slot* SetOf(const unsigned char* id, unsigned int id_len);
+
+  char path_[256];
+  // Identifies the segment, its name may have been taken over since.
+  uint64_t dev_;
+  uint64_t ino_;
+  bool detached_;
+  QUEUE member_;
+  void* base_;
+  size_t size_;
+  Header* header_;
+  Slot* slots_;
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t stores_;
+  uint64_t evictions_;
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
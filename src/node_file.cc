@@ -40,6 +40,8 @@
 
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
+#else
+# include <unistd.h>
 #endif
 
 namespace node {
@@ -203,6 +205,10 @@ static void After(uv_fs_t *req) {
         argv[1] = Integer::New(req->result, env->isolate());
         break;
 
+      case UV_FS_SENDFILE:
+        argv[1] = Integer::New(req->result, env->isolate());
+        break;
+
       case UV_FS_READDIR:
         {
           char *namebuf = static_cast<char*>(req->ptr);
@@ -913,6 +919,90 @@ static void Read(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+/*
+ * Wrapper for sendfile(2).
+ *
+ * 0 out_fd    integer. file descriptor to write to
+ * 1 in_fd     integer. file descriptor to read from
+ * 2 offset    integer. position in in_fd to start reading from
+ * 3 length    integer. number of bytes to copy
+ * 4 callback  optional
+ *
+ */
+static void SendFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() < 4 || !args[0]->IsInt32() || !args[1]->IsInt32()) {
+    return THROW_BAD_ARGS;
+  }
+
+  int out_fd = args[0]->Int32Value();
+  int in_fd = args[1]->Int32Value();
+
+  int64_t offset = GET_OFFSET(args[2]);
+  if (offset < 0)
+    return env->ThrowTypeError("offset must be a non-negative number");
+
+  if (!args[3]->IsUint32())
+    return env->ThrowTypeError("length must be a non-negative integer");
+  size_t length = args[3]->Uint32Value();
+
+  if (args[4]->IsFunction()) {
+    ASYNC_CALL(sendfile, args[4], out_fd, in_fd, offset, length)
+  } else {
+    SYNC_CALL(sendfile, 0, out_fd, in_fd, offset, length)
+    args.GetReturnValue().Set(SYNC_RESULT);
+  }
+}
+
+
+// Duplicates a file descriptor. Not part of the public API, the sendfile pipe
+// fast path uses it to own the socket's fd for the duration of a transfer.
+static void Dup(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() < 1 || !args[0]->IsInt32()) {
+    return THROW_BAD_ARGS;
+  }
+
+  // The copy must not leak into child processes, they would keep the
+  // connection open after we close it.
+#ifdef _WIN32
+  int fd = _dup(args[0]->Int32Value());
+  if (fd == -1)
+    return env->ThrowErrnoException(errno, "dup");
+  HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+  if (!SetHandleInformation(handle, HANDLE_FLAG_INHERIT, 0)) {
+    _close(fd);
+    return env->ThrowErrnoException(EBADF, "dup");
+  }
+#else
+  int fd = -1;
+#ifdef F_DUPFD_CLOEXEC
+  fd = fcntl(args[0]->Int32Value(), F_DUPFD_CLOEXEC, 0);
+  if (fd == -1 && errno != EINVAL)
+    return env->ThrowErrnoException(errno, "dup");
+#endif
+  if (fd == -1) {
+    // No F_DUPFD_CLOEXEC, set the flag after the fact.
+    fd = dup(args[0]->Int32Value());
+    if (fd == -1)
+      return env->ThrowErrnoException(errno, "dup");
+    int flags = fcntl(fd, F_GETFD);
+    if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+      int err = errno;
+      close(fd);
+      return env->ThrowErrnoException(err, "dup");
+    }
+  }
+#endif
+
+  args.GetReturnValue().Set(fd);
+}
+
+
 /* fs.chmod(path, mode);
  * Wrapper for chmod(1) / EIO_CHMOD
  */
@@ -1094,6 +1184,8 @@ void InitFs(Handle<Object> target,
   NODE_SET_METHOD(target, "close", Close);
   NODE_SET_METHOD(target, "open", Open);
   NODE_SET_METHOD(target, "read", Read);
+  NODE_SET_METHOD(target, "sendfile", SendFile);
+  NODE_SET_METHOD(target, "dup", Dup);
   NODE_SET_METHOD(target, "fdatasync", Fdatasync);
   NODE_SET_METHOD(target, "fsync", Fsync);
   NODE_SET_METHOD(target, "rename", Rename);
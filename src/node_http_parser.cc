@@ -22,6 +22,7 @@
 #include "node.h"
 #include "node_buffer.h"
 #include "node_http_parser.h"
+#include "smalloc.h"
 
 #include "base-object.h"
 #include "base-object-inl.h"
@@ -68,6 +69,7 @@ using v8::Object;
 using v8::String;
 using v8::Uint32;
 using v8::Value;
+using v8::kExternalUnsignedIntArray;
 
 const uint32_t kOnHeaders = 0;
 const uint32_t kOnHeadersComplete = 1;
@@ -91,59 +93,164 @@ const uint32_t kOnMessageComplete = 3;
   int name##_(const char* at, size_t length)
 
 
-// helper class for the Parser
-struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
+// Bump allocator for header data that has to outlive the buffer it arrived
+// in, i.e. fragments that are not contiguous in memory and strings that are
+// still pending at the end of http_parser_execute(). Everything it hands out
+// lives until the next Reset(), which the parser does at the start of every
+// message, so a message costs at most a few chunk allocations no matter how
+// fragmented its headers are.
+class HeaderArena {
+ public:
+  HeaderArena() : head_(NULL) {
+  }
+
+
+  ~HeaderArena() {
+    while (head_ != NULL) {
+      Chunk* next = head_->next;
+      free(head_);
+      head_ = next;
+    }
+  }
+
+
+  char* Allocate(size_t size) {
+    // Oversized strings get twice the room they need, so a string that keeps
+    // growing (see StringPtr::Update()) moves a logarithmic number of times
+    // and the chunks it leaves behind add up to a small multiple of its size.
+    if (head_ == NULL || head_->size - head_->used < size)
+      NewChunk(size > kChunkSize ? 2 * size : kChunkSize);
+    char* data = ChunkData(head_) + head_->used;
+    head_->used += size;
+    return data;
+  }
+
+
+  // Grow the latest allocation from old_size to new_size bytes if there is
+  // room left in its chunk. Returns false if the caller has to move it.
+  bool Extend(const char* data, size_t old_size, size_t new_size) {
+    if (head_ == NULL || data + old_size != ChunkData(head_) + head_->used)
+      return false;
+    if (head_->size - head_->used < new_size - old_size)
+      return false;
+    head_->used += new_size - old_size;
+    return true;
   }
 
 
-  ~StringPtr() {
+  // Release everything but the most recent regular-sized chunk.
+  void Reset() {
+    Chunk* keep = NULL;
+    while (head_ != NULL) {
+      Chunk* next = head_->next;
+      if (keep == NULL && head_->size == kChunkSize)
+        keep = head_;
+      else
+        free(head_);
+      head_ = next;
+    }
+    if (keep != NULL) {
+      keep->next = NULL;
+      keep->used = 0;
+    }
+    head_ = keep;
+  }
+
+ private:
+  static const size_t kChunkSize = 4096;
+
+  struct Chunk {
+    Chunk* next;
+    size_t size;
+    size_t used;
+  };
+
+
+  static char* ChunkData(Chunk* chunk) {
+    return reinterpret_cast<char*>(chunk + 1);
+  }
+
+
+  void NewChunk(size_t size) {
+    Chunk* chunk = static_cast<Chunk*>(malloc(sizeof(*chunk) + size));
+    if (chunk == NULL)
+      FatalError("node::HeaderArena::NewChunk(size_t)", "Out Of Memory");
+    chunk->next = head_;
+    chunk->size = size;
+    chunk->used = 0;
+    head_ = chunk;
+  }
+
+
+  Chunk* head_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeaderArena);
+};
+
+
+// Return the interned string for a well-known header name or an empty handle.
+static Local<String> KnownHeaderName(Environment* env,
+                                     const char* str,
+                                     size_t size) {
+#define V(PropertyName, StringValue)                                          \
+  if (size == sizeof(StringValue) - 1 &&                                      \
+      memcmp(str, StringValue, sizeof(StringValue) - 1) == 0) {               \
+    return env->PropertyName();                                               \
+  }
+  PER_ISOLATE_HTTP_HEADER_STRINGS(V)
+#undef V
+  return Local<String>();
+}
+
+
+// helper class for the Parser
+struct StringPtr {
+  StringPtr() {
     Reset();
   }
 
 
-  // If str_ does not point to a heap string yet, this function makes it do
+  // If str_ does not point to arena memory yet, this function makes it do
   // so. This is called at the end of each http_parser_execute() so as not
   // to leak references. See issue #2438 and test-http-parser-bad-ref.js.
-  void Save() {
-    if (!on_heap_ && size_ > 0) {
-      char* s = new char[size_];
+  void Save(HeaderArena* arena) {
+    if (!in_arena_ && size_ > 0) {
+      char* s = arena->Allocate(size_);
       memcpy(s, str_, size_);
       str_ = s;
-      on_heap_ = true;
+      in_arena_ = true;
     }
   }
 
 
   void Reset() {
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
-    }
-
     str_ = NULL;
+    in_arena_ = false;
     size_ = 0;
   }
 
 
-  void Update(const char* str, size_t size) {
-    if (str_ == NULL)
+  void Update(HeaderArena* arena, const char* str, size_t size) {
+    if (str_ == NULL) {
       str_ = str;
-    else if (on_heap_ || str_ + size_ != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO(bnoordhuis) Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
+    } else if (in_arena_) {
+      // Append in place when this is the arena's most recent string,
+      // which is the common case of a header split across segments.
+      if (arena->Extend(str_, size_, size_ + size)) {
+        memcpy(const_cast<char*>(str_) + size_, str, size);
+      } else {
+        char* s = arena->Allocate(size_ + size);
+        memcpy(s, str_, size_);
+        memcpy(s + size_, str, size);
+        str_ = s;
+      }
+    } else if (str_ + size_ != str) {
+      // Non-consecutive input, make a copy in the arena.
+      char* s = arena->Allocate(size_ + size);
       memcpy(s, str_, size_);
       memcpy(s + size_, str, size);
-
-      if (on_heap_)
-        delete[] str_;
-      else
-        on_heap_ = true;
-
       str_ = s;
+      in_arena_ = true;
     }
     size_ += size;
   }
@@ -157,8 +264,14 @@ struct StringPtr {
   }
 
 
+  Local<String> ToHeaderName(Environment* env) const {
+    Local<String> name = KnownHeaderName(env, str_, size_);
+    return name.IsEmpty() ? ToString(env) : name;
+  }
+
+
   const char* str_;
-  bool on_heap_;
+  bool in_arena_;
   size_t size_;
 };
 
@@ -167,6 +280,10 @@ class Parser : public BaseObject {
  public:
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
       : BaseObject(env, wrap),
+        fields_(fields_storage_),
+        values_(values_storage_),
+        headers_capacity_(kInitialHeaders),
+        flat_headers_(false),
         current_buffer_len_(0),
         current_buffer_data_(NULL) {
     MakeWeak<Parser>(this);
@@ -175,25 +292,31 @@ class Parser : public BaseObject {
 
 
   ~Parser() {
+    if (fields_ != fields_storage_) {
+      delete[] fields_;
+      delete[] values_;
+    }
   }
 
 
   HTTP_CB(on_message_begin) {
     num_fields_ = num_values_ = 0;
+    have_flushed_ = false;
     url_.Reset();
     status_message_.Reset();
+    arena_.Reset();
     return 0;
   }
 
 
   HTTP_DATA_CB(on_url) {
-    url_.Update(at, length);
+    url_.Update(&arena_, at, length);
     return 0;
   }
 
 
   HTTP_DATA_CB(on_status) {
-    status_message_.Update(at, length);
+    status_message_.Update(&arena_, at, length);
     return 0;
   }
 
@@ -201,20 +324,25 @@ class Parser : public BaseObject {
   HTTP_DATA_CB(on_header_field) {
     if (num_fields_ == num_values_) {
       // start of new field name
-      num_fields_++;
-      if (num_fields_ == ARRAY_SIZE(fields_)) {
-        // ran out of space - flush to javascript land
-        Flush();
-        num_fields_ = 1;
-        num_values_ = 0;
+      if (num_fields_ == headers_capacity_) {
+        if (headers_capacity_ < kMaxHeaders) {
+          GrowHeaders();
+        } else {
+          // Hand the full table to JS, which applies maxHeaderPairs.
+          Flush();
+          num_fields_ = num_values_ = 0;
+          if (got_exception_)
+            return -1;
+        }
       }
+      num_fields_++;
       fields_[num_fields_ - 1].Reset();
     }
 
-    assert(num_fields_ < static_cast<int>(ARRAY_SIZE(fields_)));
+    assert(num_fields_ <= headers_capacity_);
     assert(num_fields_ == num_values_ + 1);
 
-    fields_[num_fields_ - 1].Update(at, length);
+    fields_[num_fields_ - 1].Update(&arena_, at, length);
 
     return 0;
   }
@@ -227,10 +355,10 @@ class Parser : public BaseObject {
       values_[num_values_ - 1].Reset();
     }
 
-    assert(num_values_ < static_cast<int>(ARRAY_SIZE(values_)));
+    assert(num_values_ <= headers_capacity_);
     assert(num_values_ == num_fields_);
 
-    values_[num_values_ - 1].Update(at, length);
+    values_[num_values_ - 1].Update(&arena_, at, length);
 
     return 0;
   }
@@ -246,11 +374,15 @@ class Parser : public BaseObject {
     Local<Object> message_info = Object::New();
 
     if (have_flushed_) {
-      // Slow case, flush remaining headers.
+      // Slow case, the message has more than kMaxHeaders headers and the
+      // first ones went to JS through kOnHeaders. Flush the rest.
       Flush();
     } else {
       // Fast case, pass headers and URL to JS land.
-      message_info->Set(env()->headers_string(), CreateHeaders());
+      Local<Value> table;
+      message_info->Set(env()->headers_string(), CreateHeaders(&table));
+      if (flat_headers_)
+        message_info->Set(env()->header_table_string(), table);
       if (parser_.type == HTTP_REQUEST)
         message_info->Set(env()->url_string(), url_.ToString(env()));
     }
@@ -357,15 +489,15 @@ class Parser : public BaseObject {
 
 
   void Save() {
-    url_.Save();
-    status_message_.Save();
+    url_.Save(&arena_);
+    status_message_.Save(&arena_);
 
     for (int i = 0; i < num_fields_; i++) {
-      fields_[i].Save();
+      fields_[i].Save(&arena_);
     }
 
     for (int i = 0; i < num_values_; i++) {
-      values_[i].Save();
+      values_[i].Save(&arena_);
     }
   }
 
@@ -469,6 +601,18 @@ class Parser : public BaseObject {
   }
 
 
+  // parser.setFlatHeaders(flag) - when set, headers are handed to JS as one
+  // Buffer plus an offset table instead of an array of strings.
+  static void SetFlatHeaders(const FunctionCallbackInfo<Value>& args) {
+    HandleScope handle_scope(args.GetIsolate());
+    Environment* env = Environment::GetCurrent(args.GetIsolate());
+    Parser* parser = Unwrap<Parser>(args.This());
+    // Should always be called from the same context.
+    assert(env == parser->env());
+    parser->flat_headers_ = args[0]->IsTrue();
+  }
+
+
   template <bool should_pause>
   static void Pause(const FunctionCallbackInfo<Value>& args) {
     HandleScope handle_scope(args.GetIsolate());
@@ -482,13 +626,23 @@ class Parser : public BaseObject {
 
  private:
 
-  Local<Array> CreateHeaders() {
+  // Returns an array of alternating header names and values or, in flat
+  // mode, a Buffer with all names and values back to back. In the latter
+  // case `table` is set to an object with external uint32 data that holds
+  // a (name offset, name length, value offset, value length) quad for every
+  // header.
+  Local<Value> CreateHeaders(Local<Value>* table) {
+    if (flat_headers_)
+      return CreateFlatHeaders(table);
+
+    *table = Undefined(env()->isolate());
+
     // num_values_ is either -1 or the entry # of the last header
     // so num_values_ == 0 means there's a single header
     Local<Array> headers = Array::New(2 * num_values_);
 
     for (int i = 0; i < num_values_; ++i) {
-      headers->Set(2 * i, fields_[i].ToString(env()));
+      headers->Set(2 * i, fields_[i].ToHeaderName(env()));
       headers->Set(2 * i + 1, values_[i].ToString(env()));
     }
 
@@ -496,6 +650,66 @@ class Parser : public BaseObject {
   }
 
 
+  Local<Value> CreateFlatHeaders(Local<Value>* table) {
+    size_t size = 0;
+    for (int i = 0; i < num_values_; ++i)
+      size += fields_[i].size_ + values_[i].size_;
+
+    Local<Object> headers = Buffer::New(env(), size);
+    Local<Object> offsets = Object::New();
+    uint32_t count = 4 * num_values_;
+    smalloc::Alloc(env(),
+                   offsets,
+                   count * sizeof(uint32_t),
+                   kExternalUnsignedIntArray);
+    offsets->Set(env()->length_string(),
+                 Uint32::NewFromUnsigned(count, env()->isolate()));
+
+    char* data = Buffer::Data(headers);
+    uint32_t* quads = static_cast<uint32_t*>(
+        offsets->GetIndexedPropertiesExternalArrayData());
+    uint32_t offset = 0;
+
+    for (int i = 0; i < num_values_; ++i) {
+      const StringPtr* parts[] = { &fields_[i], &values_[i] };
+      for (size_t k = 0; k < ARRAY_SIZE(parts); ++k) {
+        if (parts[k]->size_ > 0)
+          memcpy(data + offset, parts[k]->str_, parts[k]->size_);
+        *quads++ = offset;
+        *quads++ = parts[k]->size_;
+        offset += parts[k]->size_;
+      }
+    }
+
+    *table = offsets;
+    return headers;
+  }
+
+
+  // Headers are collected until on_headers_complete so that they reach JS in
+  // a single call. The arrays grow up to kMaxHeaders entries, messages with
+  // more headers than that are flushed to JS in batches.
+  void GrowHeaders() {
+    int capacity = 2 * headers_capacity_;
+    StringPtr* fields = new StringPtr[capacity];
+    StringPtr* values = new StringPtr[capacity];
+
+    for (int i = 0; i < num_fields_; ++i)
+      fields[i] = fields_[i];
+    for (int i = 0; i < num_values_; ++i)
+      values[i] = values_[i];
+
+    if (fields_ != fields_storage_) {
+      delete[] fields_;
+      delete[] values_;
+    }
+
+    fields_ = fields;
+    values_ = values;
+    headers_capacity_ = capacity;
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
@@ -506,9 +720,12 @@ class Parser : public BaseObject {
     if (!cb->IsFunction())
       return;
 
-    Local<Value> argv[2] = {
-      CreateHeaders(),
-      url_.ToString(env())
+    Local<Value> table;
+    Local<Value> headers = CreateHeaders(&table);
+    Local<Value> argv[3] = {
+      headers,
+      url_.ToString(env()),
+      table
     };
 
     Local<Value> r = cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
@@ -525,6 +742,7 @@ class Parser : public BaseObject {
     http_parser_init(&parser_, type);
     url_.Reset();
     status_message_.Reset();
+    arena_.Reset();
     num_fields_ = 0;
     num_values_ = 0;
     have_flushed_ = false;
@@ -533,14 +751,21 @@ class Parser : public BaseObject {
 
 
   http_parser parser_;
-  StringPtr fields_[32];  // header fields
-  StringPtr values_[32];  // header values
+  HeaderArena arena_;  // backing store for non-contiguous header data
+  static const int kInitialHeaders = 32;
+  static const int kMaxHeaders = 1024;
+  StringPtr fields_storage_[kInitialHeaders];
+  StringPtr values_storage_[kInitialHeaders];
+  StringPtr* fields_;  // header fields
+  StringPtr* values_;  // header values
+  int headers_capacity_;
   StringPtr url_;
   StringPtr status_message_;
   int num_fields_;
   int num_values_;
   bool have_flushed_;
   bool got_exception_;
+  bool flat_headers_;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
@@ -592,6 +817,7 @@ void InitHttpParser(Handle<Object> target,
   NODE_SET_PROTOTYPE_METHOD(t, "execute", Parser::Execute);
   NODE_SET_PROTOTYPE_METHOD(t, "finish", Parser::Finish);
   NODE_SET_PROTOTYPE_METHOD(t, "reinitialize", Parser::Reinitialize);
+  NODE_SET_PROTOTYPE_METHOD(t, "setFlatHeaders", Parser::SetFlatHeaders);
   NODE_SET_PROTOTYPE_METHOD(t, "pause", Parser::Pause<true>);
   NODE_SET_PROTOTYPE_METHOD(t, "resume", Parser::Pause<false>);
 
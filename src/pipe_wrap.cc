@@ -102,6 +102,8 @@ void PipeWrap::Initialize(Handle<Object> target,
                             "writeAsciiString",
                             StreamWrap::WriteAsciiString);
   NODE_SET_PROTOTYPE_METHOD(t, "writeUtf8String", StreamWrap::WriteUtf8String);
+  NODE_SET_PROTOTYPE_METHOD(t, "writeMessage", StreamWrap::WriteMessage);
+  NODE_SET_PROTOTYPE_METHOD(t, "readMessages", StreamWrap::ReadMessages);
   NODE_SET_PROTOTYPE_METHOD(t, "writeUcs2String", StreamWrap::WriteUcs2String);
 
   NODE_SET_PROTOTYPE_METHOD(t, "bind", Bind);
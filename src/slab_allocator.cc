@@ -0,0 +1,157 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "slab_allocator.h"
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memcpy()
+
+namespace node {
+
+using v8::Local;
+using v8::Object;
+
+// Every reservation is prefixed with a pointer to its slab so Shrink() and
+// Release() can find it again; keep reservations pointer aligned.
+static const size_t kHeaderSize = sizeof(void*);
+
+
+static inline size_t RoundUp(size_t size) {
+  return (size + kHeaderSize - 1) & ~(kHeaderSize - 1);
+}
+
+
+// Slab data starts right after the (rounded up) Slab header.
+template <typename T>
+static inline char* SlabData(T* slab) {
+  return reinterpret_cast<char*>(slab) + RoundUp(sizeof(*slab));
+}
+
+
+SlabAllocator::SlabAllocator(size_t slab_size)
+    : slab_size_(slab_size),
+      current_(NULL),
+      last_(NULL) {
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  if (current_ != NULL)
+    Unref(current_);
+  current_ = NULL;
+  last_ = NULL;
+}
+
+
+void SlabAllocator::NewSlab(size_t size) {
+  Slab* slab = static_cast<Slab*>(malloc(RoundUp(sizeof(*slab)) + size));
+  if (slab == NULL)
+    FatalError("node::SlabAllocator::NewSlab(size_t)", "Out Of Memory");
+
+  slab->refs = 1;  // The allocator's own reference.
+  slab->size = size;
+  slab->offset = 0;
+
+  if (current_ != NULL)
+    Unref(current_);
+  current_ = slab;
+  last_ = NULL;
+}
+
+
+char* SlabAllocator::Allocate(size_t size) {
+  size_t needed = kHeaderSize + RoundUp(size);
+
+  if (current_ == NULL || current_->size - current_->offset < needed)
+    NewSlab(needed > slab_size_ ? needed : slab_size_);
+
+  char* header = SlabData(current_) + current_->offset;
+  memcpy(header, &current_, sizeof(current_));
+
+  current_->offset += needed;
+  current_->refs += 1;
+  last_ = header + kHeaderSize;
+
+  return last_;
+}
+
+
+Local<Object> SlabAllocator::Shrink(Environment* env, char* data, size_t size) {
+  if (size < slab_size_ / kMaxRetainRatio) {
+    Local<Object> buffer = Buffer::New(env, data, size);
+    Release(data);
+    return buffer;
+  }
+
+  Slab* slab = SlabOf(data);
+
+  if (data == last_) {
+    assert(slab == current_);
+    current_->offset = data - SlabData(current_) + RoundUp(size);
+    last_ = NULL;
+  }
+
+  // The Buffer inherits the reference taken by Allocate().
+  return Buffer::New(env, data, size, FreeCallback, slab);
+}
+
+
+void SlabAllocator::Release(char* data) {
+  if (data == NULL)
+    return;
+
+  Slab* slab = SlabOf(data);
+
+  if (data == last_) {
+    assert(slab == current_);
+    current_->offset = data - kHeaderSize - SlabData(current_);
+    last_ = NULL;
+  }
+
+  Unref(slab);
+}
+
+
+void SlabAllocator::FreeCallback(char* data, void* hint) {
+  Unref(static_cast<Slab*>(hint));
+}
+
+
+SlabAllocator::Slab* SlabAllocator::SlabOf(char* data) {
+  Slab* slab;
+  memcpy(&slab, data - kHeaderSize, sizeof(slab));
+  return slab;
+}
+
+
+void SlabAllocator::Unref(Slab* slab) {
+  assert(slab->refs > 0);
+  if (--slab->refs == 0)
+    free(slab);
+}
+
+}  // namespace node
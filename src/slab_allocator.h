@@ -0,0 +1,92 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "util.h"
+#include "v8.h"
+
+#include <stddef.h>
+
+namespace node {
+
+// Forward declaration
+class Environment;
+
+// Carves read buffers out of large, reference counted slabs so that a read
+// costs a pointer bump instead of a malloc() + realloc() pair.
+//
+// Usage follows the libuv alloc_cb/read_cb protocol: Allocate() reserves the
+// suggested size, then either Shrink() turns the bytes actually read into a
+// Buffer or Release() hands the reservation back. Every Buffer holds a
+// reference to its slab; a slab is freed once the allocator has moved on to
+// a new slab and the last Buffer pointing into it has been collected.
+//
+// A Buffer that JS holds on to keeps its whole slab alive. Reads smaller
+// than 1/kMaxRetainRatio of a slab are therefore copied into a buffer of
+// their own and their reservation is handed back, so a retained Buffer
+// never pins more than kMaxRetainRatio times its own size.
+//
+// Not thread-safe, slabs must only be touched from the event loop thread.
+class SlabAllocator {
+ public:
+  static const size_t kDefaultSlabSize = 256 * 1024;
+  static const size_t kMaxRetainRatio = 8;
+
+  explicit SlabAllocator(size_t slab_size = kDefaultSlabSize);
+  ~SlabAllocator();
+
+  // Reserve `size` bytes. A new slab is started when the current one can't
+  // satisfy the request. Never returns NULL, aborts on OOM.
+  char* Allocate(size_t size);
+
+  // Wrap the first `size` bytes of a reservation in a Buffer. The unused
+  // tail is given back to the slab if `data` is the latest reservation.
+  // Small reads are copied out and the whole reservation is given back.
+  v8::Local<v8::Object> Shrink(Environment* env, char* data, size_t size);
+
+  // Give back a reservation that won't be exposed to JS, e.g. on EOF.
+  void Release(char* data);
+
+ private:
+  // Allocated in one go with its data, which directly follows the header.
+  struct Slab {
+    size_t refs;
+    size_t size;
+    size_t offset;
+  };
+
+  static void FreeCallback(char* data, void* hint);
+  static inline Slab* SlabOf(char* data);
+  static inline void Unref(Slab* slab);
+  void NewSlab(size_t size);
+
+  const size_t slab_size_;
+  Slab* current_;
+  char* last_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -40,17 +40,36 @@
 namespace node {
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::Boolean;
+using v8::BooleanObject;
 using v8::Context;
+using v8::False;
+using v8::Float32Array;
+using v8::Float64Array;
+using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::Handle;
 using v8::HandleScope;
+using v8::Int16Array;
+using v8::Int32Array;
+using v8::Int8Array;
 using v8::Integer;
 using v8::Local;
+using v8::Null;
 using v8::Number;
+using v8::NumberObject;
 using v8::Object;
 using v8::PropertyCallbackInfo;
 using v8::String;
+using v8::StringObject;
 using v8::True;
+using v8::TypedArray;
+using v8::Uint16Array;
+using v8::Uint32Array;
+using v8::Uint8Array;
+using v8::Uint8ClampedArray;
 using v8::Undefined;
 using v8::Value;
 
@@ -501,6 +520,601 @@ void StreamWrap::WriteUcs2String(const FunctionCallbackInfo<Value>& args) {
   WriteStringImpl<UCS2>(args);
 }
 
+
+// Binary IPC messages, see the `serialization` option of child_process.fork().
+// A message is a uint32 payload size followed by one encoded value. Values
+// follow the rules of JSON.stringify() except that Buffers and typed arrays
+// are copied verbatim. Both ends of the channel live on the same machine so
+// everything is in native byte order.
+enum MessageTag {
+  kMessageUndefined,
+  kMessageNull,
+  kMessageTrue,
+  kMessageFalse,
+  kMessageInt32,
+  kMessageDouble,
+  kMessageString,
+  kMessageBuffer,
+  kMessageTypedArray,
+  kMessageArray,
+  kMessageObject
+};
+
+enum MessageArrayType {
+  kMessageInt8Array,
+  kMessageUint8Array,
+  kMessageUint8ClampedArray,
+  kMessageInt16Array,
+  kMessageUint16Array,
+  kMessageInt32Array,
+  kMessageUint32Array,
+  kMessageFloat32Array,
+  kMessageFloat64Array
+};
+
+static const size_t kMessageArrayElementSize[] = { 1, 1, 1, 2, 2, 4, 4, 4, 8 };
+static const size_t kMessageHeaderSize = sizeof(uint32_t);
+static const int kMessageMaxDepth = 1024;
+
+
+class MessageEncoder {
+ public:
+  explicit MessageEncoder(Environment* env)
+      : env_(env),
+        data_(stack_storage_),
+        length_(0),
+        capacity_(sizeof(stack_storage_)) {
+  }
+
+  ~MessageEncoder() {
+    if (data_ != stack_storage_)
+      free(data_);
+  }
+
+  // Returns false when an exception is pending.
+  bool Encode(Handle<Value> value) {
+    length_ = 0;
+    Reserve(kMessageHeaderSize);
+    length_ = kMessageHeaderSize;
+    value = ToJSONValue(value);
+    if (value.IsEmpty() || !EncodeValue(value, 0))
+      return false;
+    uint32_t size = static_cast<uint32_t>(length_ - kMessageHeaderSize);
+    memcpy(data_, &size, sizeof(size));
+    return true;
+  }
+
+  inline char* data() const {
+    return data_;
+  }
+
+  inline size_t length() const {
+    return length_;
+  }
+
+ private:
+  // Values that JSON.stringify() drops from objects and turns into null
+  // in arrays.
+  static bool IsSkipped(Handle<Value> value) {
+    return value->IsUndefined() || value->IsFunction() || value->IsSymbol();
+  }
+
+  static bool IsTypedArray(Handle<Value> value, uint8_t* type) {
+    if (!value->IsTypedArray())
+      return false;
+    if (value->IsInt8Array())
+      *type = kMessageInt8Array;
+    else if (value->IsUint8Array())
+      *type = kMessageUint8Array;
+    else if (value->IsUint8ClampedArray())
+      *type = kMessageUint8ClampedArray;
+    else if (value->IsInt16Array())
+      *type = kMessageInt16Array;
+    else if (value->IsUint16Array())
+      *type = kMessageUint16Array;
+    else if (value->IsInt32Array())
+      *type = kMessageInt32Array;
+    else if (value->IsUint32Array())
+      *type = kMessageUint32Array;
+    else if (value->IsFloat32Array())
+      *type = kMessageFloat32Array;
+    else
+      *type = kMessageFloat64Array;
+    return true;
+  }
+
+  // Calls toJSON() and unwraps Number, String and Boolean objects, which is
+  // what JSON.stringify() does before it looks at a value. Buffers and typed
+  // arrays go out as raw bytes and are left alone. Returns an empty handle
+  // when an exception is pending.
+  Handle<Value> ToJSONValue(Handle<Value> value) {
+    uint8_t type;
+    if (IsTypedArray(value, &type) || Buffer::HasInstance(value))
+      return value;
+
+    if (value->IsObject() && !value->IsFunction()) {
+      Local<Object> object = value.As<Object>();
+      Local<Value> to_json = object->Get(env_->to_json_string());
+      if (to_json.IsEmpty())
+        return Handle<Value>();
+      if (to_json->IsFunction()) {
+        value = to_json.As<Function>()->Call(object, 0, NULL);
+        if (value.IsEmpty())
+          return Handle<Value>();
+      }
+    }
+
+    if (value->IsNumberObject())
+      value = Number::New(env_->isolate(), value.As<NumberObject>()->ValueOf());
+    else if (value->IsStringObject())
+      value = value.As<StringObject>()->ValueOf();
+    else if (value->IsBooleanObject())
+      value = Boolean::New(value.As<BooleanObject>()->ValueOf());
+
+    return value;
+  }
+
+  // Returns a pointer to at least |size| writable bytes at the end of the
+  // message.
+  char* Reserve(size_t size) {
+    if (capacity_ - length_ >= size)
+      return data_ + length_;
+
+    size_t capacity = capacity_;
+    while (capacity - length_ < size)
+      capacity *= 2;
+
+    char* data;
+    if (data_ == stack_storage_) {
+      data = static_cast<char*>(malloc(capacity));
+      if (data != NULL)
+        memcpy(data, data_, length_);
+    } else {
+      data = static_cast<char*>(realloc(data_, capacity));
+    }
+
+    if (data == NULL)
+      FatalError("node::MessageEncoder::Reserve(size_t)", "Out Of Memory");
+
+    data_ = data;
+    capacity_ = capacity;
+    return data_ + length_;
+  }
+
+  void WriteTag(uint8_t tag) {
+    *Reserve(1) = tag;
+    length_ += 1;
+  }
+
+  void WriteUint32(uint32_t value) {
+    memcpy(Reserve(sizeof(value)), &value, sizeof(value));
+    length_ += sizeof(value);
+  }
+
+  void WriteBytes(const char* data, size_t size) {
+    WriteUint32(static_cast<uint32_t>(size));
+    memcpy(Reserve(size), data, size);
+    length_ += size;
+  }
+
+  void WriteString(Handle<String> string) {
+    // Same trade-off as WriteStringImpl(): take the hit of computing the
+    // exact size of long strings rather than tripling the storage.
+    size_t size;
+    if (string->Length() > 65535)
+      size = string->Utf8Length();
+    else
+      size = 3 * string->Length();
+
+    char* data = Reserve(sizeof(uint32_t) + size);
+    uint32_t written = string->WriteUtf8(data + sizeof(written),
+                                         size,
+                                         NULL,
+                                         String::NO_NULL_TERMINATION);
+    memcpy(data, &written, sizeof(written));
+    length_ += sizeof(written) + written;
+  }
+
+  // |value| has been through ToJSONValue().
+  bool EncodeValue(Handle<Value> value, int depth) {
+    if (depth > kMessageMaxDepth) {
+      env_->ThrowTypeError("Message is circular or nested too deeply");
+      return false;
+    }
+
+    uint8_t type;
+    if (IsTypedArray(value, &type)) {
+      Local<ArrayBufferView> view = value.As<ArrayBufferView>();
+      WriteTag(kMessageTypedArray);
+      WriteTag(type);
+      WriteBytes(static_cast<const char*>(
+                     view->GetIndexedPropertiesExternalArrayData()),
+                 view->ByteLength());
+      return true;
+    }
+
+    if (Buffer::HasInstance(value)) {
+      WriteTag(kMessageBuffer);
+      WriteBytes(Buffer::Data(value), Buffer::Length(value));
+      return true;
+    }
+
+    if (IsSkipped(value)) {
+      WriteTag(kMessageUndefined);
+    } else if (value->IsNull()) {
+      WriteTag(kMessageNull);
+    } else if (value->IsTrue()) {
+      WriteTag(kMessageTrue);
+    } else if (value->IsFalse()) {
+      WriteTag(kMessageFalse);
+    } else if (value->IsInt32() ||
+               (value->IsNumber() && value->NumberValue() == 0)) {
+      // Also catches -0, which becomes 0 like in JSON.
+      int32_t number = value->Int32Value();
+      WriteTag(kMessageInt32);
+      memcpy(Reserve(sizeof(number)), &number, sizeof(number));
+      length_ += sizeof(number);
+    } else if (value->IsNumber()) {
+      double number = value->NumberValue();
+      // NaN and +/-Infinity become null, like in JSON.
+      if (number - number != 0) {
+        WriteTag(kMessageNull);
+        return true;
+      }
+      WriteTag(kMessageDouble);
+      memcpy(Reserve(sizeof(number)), &number, sizeof(number));
+      length_ += sizeof(number);
+    } else if (value->IsString()) {
+      WriteTag(kMessageString);
+      WriteString(value.As<String>());
+    } else if (value->IsArray()) {
+      Local<Array> array = value.As<Array>();
+      uint32_t count = array->Length();
+      WriteTag(kMessageArray);
+      WriteUint32(count);
+      for (uint32_t i = 0; i < count; i++) {
+        HandleScope scope(env_->isolate());
+        Handle<Value> element = array->Get(i);
+        if (element.IsEmpty())
+          return false;
+        element = ToJSONValue(element);
+        if (element.IsEmpty())
+          return false;
+        if (IsSkipped(element))
+          WriteTag(kMessageNull);
+        else if (!EncodeValue(element, depth + 1))
+          return false;
+      }
+    } else {
+      Local<Object> object = value.As<Object>();
+      Local<Array> keys = object->GetOwnPropertyNames();
+      if (keys.IsEmpty())
+        return false;
+      uint32_t count = keys->Length();
+      uint32_t encoded = 0;
+      WriteTag(kMessageObject);
+      // Skipped properties are not known up front, patch in the real count.
+      size_t count_offset = length_;
+      WriteUint32(count);
+      for (uint32_t i = 0; i < count; i++) {
+        HandleScope scope(env_->isolate());
+        Local<Value> key = keys->Get(i);
+        if (key.IsEmpty())
+          return false;
+        Handle<Value> property = object->Get(key);
+        if (property.IsEmpty())
+          return false;
+        // Decided after toJSON(), which may return undefined.
+        property = ToJSONValue(property);
+        if (property.IsEmpty())
+          return false;
+        if (IsSkipped(property))
+          continue;
+        WriteString(key->ToString());
+        if (!EncodeValue(property, depth + 1))
+          return false;
+        encoded += 1;
+      }
+      memcpy(data_ + count_offset, &encoded, sizeof(encoded));
+    }
+
+    return true;
+  }
+
+  Environment* const env_;
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+  char stack_storage_[16384];  // 16kb
+};
+
+
+class MessageDecoder {
+ public:
+  MessageDecoder(Environment* env, const char* data, size_t length)
+      : env_(env),
+        data_(data),
+        end_(data + length) {
+  }
+
+  // Returns an empty handle when the message is malformed.
+  Handle<Value> Decode() {
+    Handle<Value> value = DecodeValue(0);
+    if (data_ != end_)
+      return Handle<Value>();
+    return value;
+  }
+
+ private:
+  inline size_t available() const {
+    return end_ - data_;
+  }
+
+  bool Read(void* out, size_t size) {
+    if (available() < size)
+      return false;
+    memcpy(out, data_, size);
+    data_ += size;
+    return true;
+  }
+
+  // Reads a size prefix and returns a pointer to that many bytes.
+  const char* ReadBytes(uint32_t* size) {
+    if (!Read(size, sizeof(*size)) || available() < *size)
+      return NULL;
+    const char* data = data_;
+    data_ += *size;
+    return data;
+  }
+
+  Handle<String> DecodeString(String::NewStringType type) {
+    uint32_t size;
+    const char* data = ReadBytes(&size);
+    if (data == NULL)
+      return Handle<String>();
+    return String::NewFromUtf8(env_->isolate(), data, type, size);
+  }
+
+  Handle<Value> DecodeTypedArray() {
+    uint8_t type;
+    uint32_t size;
+    const char* data;
+    if (!Read(&type, sizeof(type)) ||
+        type > kMessageFloat64Array ||
+        (data = ReadBytes(&size)) == NULL ||
+        size % kMessageArrayElementSize[type] != 0) {
+      return Handle<Value>();
+    }
+
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(size);
+    size_t length = size / kMessageArrayElementSize[type];
+    Local<TypedArray> array;
+    switch (type) {
+#define V(Type)                                                               \
+      case kMessage##Type:                                                    \
+        array = Type::New(buffer, 0, length);                                 \
+        break;
+      V(Int8Array)
+      V(Uint8Array)
+      V(Uint8ClampedArray)
+      V(Int16Array)
+      V(Uint16Array)
+      V(Int32Array)
+      V(Uint32Array)
+      V(Float32Array)
+      V(Float64Array)
+#undef V
+    }
+    if (size > 0)
+      memcpy(array->GetIndexedPropertiesExternalArrayData(), data, size);
+    return array;
+  }
+
+  Handle<Value> DecodeValue(int depth) {
+    uint8_t tag;
+    if (depth > kMessageMaxDepth || !Read(&tag, sizeof(tag)))
+      return Handle<Value>();
+
+    switch (tag) {
+      case kMessageUndefined:
+        return Undefined(env_->isolate());
+      case kMessageNull:
+        return Null(env_->isolate());
+      case kMessageTrue:
+        return True(env_->isolate());
+      case kMessageFalse:
+        return False(env_->isolate());
+      case kMessageInt32: {
+        int32_t number;
+        if (!Read(&number, sizeof(number)))
+          return Handle<Value>();
+        return Integer::New(number, env_->isolate());
+      }
+      case kMessageDouble: {
+        double number;
+        if (!Read(&number, sizeof(number)))
+          return Handle<Value>();
+        return Number::New(env_->isolate(), number);
+      }
+      case kMessageString:
+        return DecodeString(String::kNormalString);
+      case kMessageBuffer: {
+        uint32_t size;
+        const char* data = ReadBytes(&size);
+        if (data == NULL)
+          return Handle<Value>();
+        return Buffer::New(env_, data, size);
+      }
+      case kMessageTypedArray:
+        return DecodeTypedArray();
+      case kMessageArray: {
+        uint32_t count;
+        // Every element takes up at least one byte. Don't let a bogus count
+        // make us allocate a huge array.
+        if (!Read(&count, sizeof(count)) || count > available())
+          return Handle<Value>();
+        Local<Array> array = Array::New(count);
+        for (uint32_t i = 0; i < count; i++) {
+          Handle<Value> element = DecodeValue(depth + 1);
+          if (element.IsEmpty())
+            return Handle<Value>();
+          array->Set(i, element);
+        }
+        return array;
+      }
+      case kMessageObject: {
+        uint32_t count;
+        if (!Read(&count, sizeof(count)))
+          return Handle<Value>();
+        Local<Object> object = Object::New();
+        for (uint32_t i = 0; i < count; i++) {
+          // Keys repeat a lot (think `cmd`), internalize them.
+          Handle<String> key = DecodeString(String::kInternalizedString);
+          if (key.IsEmpty())
+            return Handle<Value>();
+          Handle<Value> property = DecodeValue(depth + 1);
+          if (property.IsEmpty())
+            return Handle<Value>();
+          // Define an own property like JSON.parse() does, a plain Set()
+          // would run the __proto__ setter for a "__proto__" key.
+          object->ForceSet(key, property);
+        }
+        return object;
+      }
+    }
+
+    return Handle<Value>();
+  }
+
+  Environment* const env_;
+  const char* data_;
+  const char* const end_;
+};
+
+
+// writeMessage(req, message[, handle])
+void StreamWrap::WriteMessage(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  int err;
+
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.This());
+
+  assert(args[0]->IsObject());
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+
+  MessageEncoder encoder(env);
+  if (!encoder.Encode(args[1]))
+    return;  // Exception pending.
+
+  if (encoder.length() > INT_MAX) {
+    args.GetReturnValue().Set(UV_ENOBUFS);
+    return;
+  }
+
+  char* storage;
+  WriteWrap* req_wrap;
+  char* data;
+  size_t data_size = encoder.length();
+  uv_buf_t buf = uv_buf_init(encoder.data(), data_size);
+  uv_handle_t* send_handle = NULL;
+
+  // Try writing immediately unless there is a handle to pass along.
+  if (!wrap->is_named_pipe_ipc() || !args[2]->IsObject()) {
+    uv_buf_t* bufs = &buf;
+    size_t count = 1;
+    err = wrap->callbacks()->TryWrite(&bufs, &count);
+
+    // Failure
+    if (err != 0)
+      goto done;
+
+    // Success
+    if (count == 0)
+      goto done;
+
+    // Partial write
+    assert(count == 1);
+  }
+
+  // The encoder's storage goes away when we return, copy what's left.
+  storage = new char[sizeof(WriteWrap) + buf.len + 15];
+  req_wrap = new(storage) WriteWrap(env, req_wrap_obj, wrap);
+
+  data = reinterpret_cast<char*>(ROUND_UP(
+      reinterpret_cast<uintptr_t>(storage) + sizeof(WriteWrap), 16));
+  memcpy(data, buf.base, buf.len);
+  buf = uv_buf_init(data, buf.len);
+
+  if (wrap->is_named_pipe_ipc() && args[2]->IsObject()) {
+    Local<Object> send_handle_obj = args[2].As<Object>();
+    HandleWrap* wrap = Unwrap<HandleWrap>(send_handle_obj);
+    send_handle = wrap->GetHandle();
+    // Reference StreamWrap instance to prevent it from being garbage
+    // collected before `AfterWrite` is called.
+    assert(!req_wrap->persistent().IsEmpty());
+    req_wrap->object()->Set(env->handle_string(), send_handle_obj);
+  }
+
+  err = wrap->callbacks()->DoWrite(
+      req_wrap,
+      &buf,
+      1,
+      reinterpret_cast<uv_stream_t*>(send_handle),
+      StreamWrap::AfterWrite);
+
+  req_wrap->Dispatched();
+  req_wrap->object()->Set(env->async(), True(env->isolate()));
+
+  if (err) {
+    req_wrap->~WriteWrap();
+    delete[] storage;
+  }
+
+ done:
+  const char* msg = wrap->callbacks()->Error();
+  if (msg != NULL)
+    req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
+  req_wrap_obj->Set(env->bytes_string(),
+                    Integer::NewFromUnsigned(data_size, env->isolate()));
+  args.GetReturnValue().Set(err);
+}
+
+
+// readMessages(buffer, messages)
+// Decodes the complete messages in `buffer` and appends them to `messages`.
+// Returns the number of bytes consumed.
+void StreamWrap::ReadMessages(const FunctionCallbackInfo<Value>& args) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+
+  assert(Buffer::HasInstance(args[0]));
+  assert(args[1]->IsArray());
+
+  const char* data = Buffer::Data(args[0]);
+  size_t length = Buffer::Length(args[0]);
+  Local<Array> messages = args[1].As<Array>();
+  uint32_t count = messages->Length();
+
+  size_t offset = 0;
+  while (length - offset >= kMessageHeaderSize) {
+    uint32_t size;
+    memcpy(&size, data + offset, sizeof(size));
+    if (length - offset - kMessageHeaderSize < size)
+      break;  // Incomplete.
+
+    MessageDecoder decoder(env, data + offset + kMessageHeaderSize, size);
+    Handle<Value> message = decoder.Decode();
+    if (message.IsEmpty())
+      return env->ThrowError("Malformed IPC message");
+
+    messages->Set(count++, message);
+    offset += kMessageHeaderSize + size;
+  }
+
+  args.GetReturnValue().Set(static_cast<uint32_t>(offset));
+}
+
 void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
   HandleScope scope(env->isolate());
@@ -675,14 +1289,8 @@ void StreamWrapCallbacks::AfterWrite(WriteWrap* w) {
 void StreamWrapCallbacks::DoAlloc(uv_handle_t* handle,
                                   size_t suggested_size,
                                   uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
+  buf->base = wrap()->env()->slab_allocator()->Allocate(suggested_size);
   buf->len = suggested_size;
-
-  if (buf->base == NULL && suggested_size > 0) {
-    FatalError(
-        "node::StreamWrapCallbacks::DoAlloc(uv_handle_t*, size_t, uv_buf_t*)",
-        "Out Of Memory");
-  }
 }
 
 
@@ -701,21 +1309,18 @@ void StreamWrapCallbacks::DoRead(uv_stream_t* handle,
   };
 
   if (nread < 0)  {
-    if (buf->base != NULL)
-      free(buf->base);
+    env->slab_allocator()->Release(buf->base);
     wrap()->MakeCallback(env->onread_string(), ARRAY_SIZE(argv), argv);
     return;
   }
 
   if (nread == 0) {
-    if (buf->base != NULL)
-      free(buf->base);
+    env->slab_allocator()->Release(buf->base);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
   assert(static_cast<size_t>(nread) <= buf->len);
-  argv[1] = Buffer::Use(env, base, nread);
+  argv[1] = env->slab_allocator()->Shrink(env, buf->base, nread);
 
   Local<Object> pending_obj;
   if (pending == UV_TCP) {
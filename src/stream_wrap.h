@@ -126,6 +126,10 @@ class StreamWrap : public HandleWrap {
   static void WriteUtf8String(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteUcs2String(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Binary IPC message framing, see the `serialization` option of fork().
+  static void WriteMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ReadMessages(const v8::FunctionCallbackInfo<v8::Value>& args);
+
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   inline StreamWrapCallbacks* callbacks() const {
@@ -20,6 +20,7 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 
 #include "node.h"
 #include "node_buffer.h"
@@ -174,10 +175,10 @@ static const int unbase64_table[] =
 
 
 template <typename TypeName>
-size_t base64_decode(char* buf,
-                     size_t len,
-                     const TypeName* src,
-                     const size_t srcLen) {
+size_t base64_decode_slow(char* buf,
+                          size_t len,
+                          const TypeName* src,
+                          const size_t srcLen) {
   char a, b, c, d;
   char* dst = buf;
   char* dstEnd = buf + len;
@@ -225,6 +226,30 @@ size_t base64_decode(char* buf,
 }
 
 
+template <typename TypeName>
+size_t base64_decode(char* buf,
+                     size_t len,
+                     const TypeName* src,
+                     const size_t srcLen) {
+  return base64_decode_slow(buf, len, src, srcLen);
+}
+
+
+// One-byte input can take the vectorized path for the bulk of the data,
+// the scalar decoder deals with whitespace, padding and the tail.
+static size_t base64_decode(char* buf,
+                            size_t len,
+                            const char* src,
+                            const size_t srcLen) {
+  size_t written;
+  size_t consumed = simd::Base64Decode(src, srcLen, buf, len, &written);
+  return written + base64_decode_slow(buf + written,
+                                      len - written,
+                                      src + consumed,
+                                      srcLen - consumed);
+}
+
+
 //// HEX ////
 
 template <typename TypeName>
@@ -257,6 +282,21 @@ size_t hex_decode(char* buf,
 }
 
 
+// Like base64_decode(), one-byte input goes through the vectorized decoder
+// first and the scalar decoder picks up where it stopped.
+static size_t hex_decode(char* buf,
+                         size_t len,
+                         const char* src,
+                         const size_t srcLen) {
+  size_t written;
+  size_t consumed = simd::HexDecode(src, srcLen, buf, len, &written);
+  return written + hex_decode<char>(buf + written,
+                                    len - written,
+                                    src + consumed,
+                                    srcLen - consumed);
+}
+
+
 bool StringBytes::GetExternalParts(Isolate* isolate,
                                    Handle<Value> val,
                                    const char** data,
@@ -301,6 +341,7 @@ size_t StringBytes::Write(Isolate* isolate,
   const char* data;
   size_t len = 0;
   bool is_extern = GetExternalParts(isolate, val, &data, &len);
+  size_t extlen = len;
 
   Local<String> str = val.As<String>();
   len = len < buflen ? len : buflen;
@@ -341,8 +382,17 @@ size_t StringBytes::Write(Isolate* isolate,
       break;
 
     case BASE64:
-      if (is_extern) {
-        base64_decode(buf, buflen, data, len);
+      if (is_extern && !(val->IsString() && str->IsExternal())) {
+        // Buffer or external one-byte string.
+        len = base64_decode(buf, buflen, data, extlen);
+      } else if (str->IsOneByte()) {
+        // Make a one-byte copy rather than a two-byte String::Value, it's
+        // half the size and can be decoded by the vectorized decoder.
+        size_t slen = str->Length();
+        char* src = new char[slen];
+        str->WriteOneByte(reinterpret_cast<uint8_t*>(src), 0, slen, flags);
+        len = base64_decode(buf, buflen, src, slen);
+        delete[] src;
       } else {
         String::Value value(str);
         len = base64_decode(buf, buflen, *value, value.length());
@@ -353,8 +403,15 @@ size_t StringBytes::Write(Isolate* isolate,
       break;
 
     case HEX:
-      if (is_extern) {
-        hex_decode(buf, buflen, data, len);
+      if (is_extern && !(val->IsString() && str->IsExternal())) {
+        // Buffer or external one-byte string.
+        len = hex_decode(buf, buflen, data, extlen);
+      } else if (str->IsOneByte()) {
+        size_t slen = str->Length();
+        char* src = new char[slen];
+        str->WriteOneByte(reinterpret_cast<uint8_t*>(src), 0, slen, flags);
+        len = hex_decode(buf, buflen, src, slen);
+        delete[] src;
       } else {
         String::Value value(str);
         len = hex_decode(buf, buflen, *value, value.length());
@@ -497,6 +554,10 @@ static bool contains_non_ascii_slow(const char* buf, size_t len) {
 
 
 static bool contains_non_ascii(const char* src, size_t len) {
+  const size_t skip = simd::AsciiPrefix(src, len);
+  src += skip;
+  len -= skip;
+
   if (len < 16) {
     return contains_non_ascii_slow(src, len);
   }
@@ -546,6 +607,11 @@ static void force_ascii_slow(const char* src, char* dst, size_t len) {
 
 
 static void force_ascii(const char* src, char* dst, size_t len) {
+  const size_t skip = simd::ForceAscii(src, dst, len);
+  src += skip;
+  dst += skip;
+  len -= skip;
+
   if (len < 16) {
     force_ascii_slow(src, dst, len);
     return;
@@ -562,7 +628,7 @@ static void force_ascii(const char* src, char* dst, size_t len) {
       force_ascii_slow(src, dst, unalign);
       src += unalign;
       dst += unalign;
-      len -= src_unalign;
+      len -= unalign;
     } else {
       force_ascii_slow(src, dst, len);
       return;
@@ -611,8 +677,9 @@ static size_t base64_encode(const char* src,
                               "abcdefghijklmnopqrstuvwxyz"
                               "0123456789+/";
 
-  i = 0;
-  k = 0;
+  // Let the vectorized encoder do the bulk of the work, if available.
+  i = simd::Base64Encode(src, slen, dst);
+  k = i / 3 * 4;
   n = slen / 3 * 3;
 
   while (i < n) {
@@ -660,7 +727,8 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  size_t i = simd::HexEncode(src, slen, dst);
+  for (size_t k = i * 2; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -706,10 +774,20 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       break;
 
     case UTF8:
-      val = String::NewFromUtf8(isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+      // Pure ASCII is valid UTF-8 that maps byte for byte onto a one-byte
+      // string, skip the decoder. Large strings are externalized like the
+      // other one-byte encodings.
+      if (!contains_non_ascii(buf, buflen)) {
+        if (buflen < EXTERN_APEX)
+          val = OneByteString(isolate, buf, buflen);
+        else
+          val = ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+      } else {
+        val = String::NewFromUtf8(isolate,
+                                  buf,
+                                  String::kNormalString,
+                                  buflen);
+      }
       break;
 
     case BINARY:
@@ -0,0 +1,633 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "string_bytes_simd.h"
+
+#include <stdint.h>
+
+// The kernels are compiled with function level target attributes so that
+// the rest of node doesn't need to be built with -mssse3 or -mavx2. That
+// requires gcc >= 4.9 or clang >= 3.8, older compilers get the scalar code.
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    ((defined(__clang__) &&                                                   \
+      (__clang_major__ > 3 ||                                                 \
+       (__clang_major__ == 3 && __clang_minor__ >= 8))) ||                    \
+     (!defined(__clang__) && defined(__GNUC__) &&                             \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define NODE_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#define NODE_TARGET(features) __attribute__((target(features)))
+#endif
+
+namespace node {
+namespace simd {
+
+enum CpuLevel {
+  kScalar,
+  kSSE2,
+  kSSSE3,
+  kAVX2
+};
+
+
+static CpuLevel DetectCpuLevel() {
+#if defined(NODE_HAVE_X86_SIMD)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return kAVX2;
+  if (__builtin_cpu_supports("ssse3"))
+    return kSSSE3;
+  if (__builtin_cpu_supports("sse2"))
+    return kSSE2;
+#endif
+  return kScalar;
+}
+
+
+// Detection is idempotent so racing threads at worst detect twice.
+static CpuLevel cpu_level() {
+  static int level = -1;
+  if (level < 0)
+    level = DetectCpuLevel();
+  return static_cast<CpuLevel>(level);
+}
+
+
+#if defined(NODE_HAVE_X86_SIMD)
+
+//// Base 64 ////
+
+// The encoder and decoder follow Wojciech Muła and Daniel Lemire, "Faster
+// Base64 Encoding and Decoding using AVX2 Instructions" (2017). Every 32
+// bit lane holds 3 input bytes on the way in and 4 output characters on the
+// way out.
+
+// Spread 12 input bytes over 16 lanes of 6 bit indices.
+NODE_TARGET("ssse3")
+static inline __m128i Base64Unpack(__m128i in) {
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                         4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+
+// Map 6 bit indices to the characters of the regular base64 alphabet.
+NODE_TARGET("ssse3")
+static inline __m128i Base64Translate(__m128i indices) {
+  __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  offsets = _mm_or_si128(offsets, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                      '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                      '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                      '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(shift, offsets), indices);
+}
+
+
+// Map characters of the regular and URL-safe alphabets to 6 bit values.
+// `valid` is set to all ones for bytes that were part of either alphabet.
+NODE_TARGET("ssse3")
+static inline __m128i Base64Lookup(__m128i in, __m128i* valid) {
+  const __m128i upper =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), in));
+  const __m128i lower =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), in));
+  const __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), in));
+  const __m128i plus = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('+')),
+                                    _mm_cmpeq_epi8(in, _mm_set1_epi8('-')));
+  const __m128i slash = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')),
+                                     _mm_cmpeq_epi8(in, _mm_set1_epi8('_')));
+
+  __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+
+  __m128i values = _mm_add_epi8(in, shift);
+  values = _mm_andnot_si128(_mm_or_si128(plus, slash), values);
+  values = _mm_or_si128(values, _mm_and_si128(plus, _mm_set1_epi8(62)));
+  values = _mm_or_si128(values, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+  *valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                        _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+  return values;
+}
+
+
+// Pack 16 lanes of 6 bit values into 12 bytes at the bottom of the vector.
+NODE_TARGET("ssse3")
+static inline __m128i Base64Pack(__m128i values) {
+  const __m128i ab_bc = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i abc = _mm_madd_epi16(ab_bc, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(abc, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                             8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+
+NODE_TARGET("ssse3")
+static size_t Base64EncodeSSSE3(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
+
+  // Loads are 16 bytes wide but only 12 bytes are consumed per round.
+  while (i + 16 <= slen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i out = Base64Translate(Base64Unpack(in));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), out);
+    i += 12;
+    k += 16;
+  }
+
+  return i;
+}
+
+
+NODE_TARGET("ssse3")
+static size_t Base64DecodeSSSE3(const char* src,
+                                size_t slen,
+                                char* dst,
+                                size_t dlen,
+                                size_t* written) {
+  size_t i = 0;
+  size_t k = 0;
+
+  // Stores are 16 bytes wide but only 12 bytes are produced per round.
+  while (i + 16 <= slen && k + 16 <= dlen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i valid;
+    __m128i values = Base64Lookup(in, &valid);
+    if (_mm_movemask_epi8(valid) != 0xffff)
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), Base64Pack(values));
+    i += 16;
+    k += 12;
+  }
+
+  *written = k;
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static inline __m256i Load2x128(const char* lo, const char* hi) {
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+}
+
+
+NODE_TARGET("avx2")
+static size_t Base64EncodeAVX2(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
+
+  // Each 128 bit lane is loaded separately so it sees its own 12 bytes.
+  while (i + 28 <= slen) {
+    __m256i in = Load2x128(src + i, src + i + 12);
+
+    in = _mm256_shuffle_epi8(in, _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i offsets = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    offsets = _mm256_or_si256(offsets,
+                              _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    const __m256i shift = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0);
+    const __m256i out =
+        _mm256_add_epi8(_mm256_shuffle_epi8(shift, offsets), indices);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), out);
+    i += 24;
+    k += 32;
+  }
+
+  return i + Base64EncodeSSSE3(src + i, slen - i, dst + k);
+}
+
+
+NODE_TARGET("avx2")
+static size_t Base64DecodeAVX2(const char* src,
+                               size_t slen,
+                               char* dst,
+                               size_t dlen,
+                               size_t* written) {
+  size_t i = 0;
+  size_t k = 0;
+
+  while (i + 32 <= slen && k + 32 <= dlen) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+    const __m256i upper = _mm256_and_si256(
+        _mm256_cmpgt_epi8(in, _mm256_set1_epi8('A' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), in));
+    const __m256i lower = _mm256_and_si256(
+        _mm256_cmpgt_epi8(in, _mm256_set1_epi8('a' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), in));
+    const __m256i digit = _mm256_and_si256(
+        _mm256_cmpgt_epi8(in, _mm256_set1_epi8('0' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), in));
+    const __m256i plus = _mm256_or_si256(
+        _mm256_cmpeq_epi8(in, _mm256_set1_epi8('+')),
+        _mm256_cmpeq_epi8(in, _mm256_set1_epi8('-')));
+    const __m256i slash = _mm256_or_si256(
+        _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')),
+        _mm256_cmpeq_epi8(in, _mm256_set1_epi8('_')));
+
+    const __m256i valid = _mm256_or_si256(
+        _mm256_or_si256(upper, lower),
+        _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+    if (_mm256_movemask_epi8(valid) != -1)
+      break;
+
+    __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+    shift = _mm256_or_si256(
+        shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+    shift = _mm256_or_si256(
+        shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+
+    __m256i values = _mm256_add_epi8(in, shift);
+    values = _mm256_andnot_si256(_mm256_or_si256(plus, slash), values);
+    values = _mm256_or_si256(values,
+                             _mm256_and_si256(plus, _mm256_set1_epi8(62)));
+    values = _mm256_or_si256(values,
+                             _mm256_and_si256(slash, _mm256_set1_epi8(63)));
+
+    const __m256i ab_bc =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    __m256i out = _mm256_madd_epi16(ab_bc, _mm256_set1_epi32(0x00011000));
+    out = _mm256_shuffle_epi8(out, _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    // Move the 12 bytes of the upper lane next to those of the lower lane.
+    out = _mm256_permutevar8x32_epi32(out,
+                                      _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), out);
+    i += 32;
+    k += 24;
+  }
+
+  size_t tail;
+  i += Base64DecodeSSSE3(src + i, slen - i, dst + k, dlen - k, &tail);
+  *written = k + tail;
+  return i;
+}
+
+
+//// HEX ////
+
+NODE_TARGET("ssse3")
+static size_t HexEncodeSSSE3(const char* src, size_t slen, char* dst) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                       '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+
+  while (i + 16 <= slen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i hi = _mm_shuffle_epi8(digits,
+                                  _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+    __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(in, nibble));
+    __m128i* out = reinterpret_cast<__m128i*>(dst + 2 * i);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(hi, lo));
+    i += 16;
+  }
+
+  return i;
+}
+
+
+// Map hex digits to their values. `valid` is set to all ones for bytes that
+// were hex digits.
+NODE_TARGET("sse2")
+static inline __m128i HexLookup(__m128i in, __m128i* valid) {
+  const __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), in));
+  // Fold 'a'-'f' onto 'A'-'F'.
+  const __m128i folded = _mm_andnot_si128(_mm_set1_epi8(0x20), in);
+  const __m128i alpha =
+      _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('A' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('F' + 1), folded));
+
+  __m128i values = _mm_and_si128(digit, _mm_sub_epi8(in, _mm_set1_epi8('0')));
+  values = _mm_or_si128(values,
+      _mm_and_si128(alpha, _mm_sub_epi8(folded, _mm_set1_epi8('A' - 10))));
+
+  *valid = _mm_or_si128(digit, alpha);
+  return values;
+}
+
+
+NODE_TARGET("ssse3")
+static size_t HexDecodeSSSE3(const char* src,
+                             size_t slen,
+                             char* dst,
+                             size_t dlen,
+                             size_t* written) {
+  size_t i = 0;
+  size_t k = 0;
+
+  while (i + 16 <= slen && k + 8 <= dlen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i valid;
+    __m128i values = HexLookup(in, &valid);
+    if (_mm_movemask_epi8(valid) != 0xffff)
+      break;
+    // High nibble * 16 + low nibble, one 16 bit lane per output byte.
+    __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k),
+                     _mm_packus_epi16(pairs, pairs));
+    i += 16;
+    k += 8;
+  }
+
+  *written = k;
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static size_t HexEncodeAVX2(const char* src, size_t slen, char* dst) {
+  const __m256i digits = _mm256_setr_epi8(
+      '0', '1', '2', '3', '4', '5', '6', '7',
+      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+      '0', '1', '2', '3', '4', '5', '6', '7',
+      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+
+  while (i + 32 <= slen) {
+    __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    // Unpacking works within 128 bit lanes, spread the input so that the
+    // low halves of both lanes hold bytes 0-15 and the high halves 16-31.
+    in = _mm256_permute4x64_epi64(in, 0xd8);
+    __m256i hi = _mm256_shuffle_epi8(
+        digits, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+    __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(in, nibble));
+    __m256i* out = reinterpret_cast<__m256i*>(dst + 2 * i);
+    _mm256_storeu_si256(out + 0, _mm256_unpacklo_epi8(hi, lo));
+    _mm256_storeu_si256(out + 1, _mm256_unpackhi_epi8(hi, lo));
+    i += 32;
+  }
+
+  return i + HexEncodeSSSE3(src + i, slen - i, dst + 2 * i);
+}
+
+
+NODE_TARGET("avx2")
+static size_t HexDecodeAVX2(const char* src,
+                            size_t slen,
+                            char* dst,
+                            size_t dlen,
+                            size_t* written) {
+  size_t i = 0;
+  size_t k = 0;
+
+  while (i + 32 <= slen && k + 16 <= dlen) {
+    const char* p = src + i;
+    __m128i valid_lo;
+    __m128i valid_hi;
+    __m128i lo = HexLookup(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), &valid_lo);
+    __m128i hi = HexLookup(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)), &valid_hi);
+    if (_mm_movemask_epi8(_mm_and_si128(valid_lo, valid_hi)) != 0xffff)
+      break;
+    __m256i values =
+        _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    __m256i pairs =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+    // Packing works within 128 bit lanes, gather the two 8 byte results.
+    __m256i packed = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(pairs, pairs), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm256_castsi256_si128(packed));
+    i += 32;
+    k += 16;
+  }
+
+  size_t tail;
+  i += HexDecodeSSSE3(src + i, slen - i, dst + k, dlen - k, &tail);
+  *written = k + tail;
+  return i;
+}
+
+
+//// ASCII ////
+
+NODE_TARGET("sse2")
+static size_t AsciiPrefixSSE2(const char* src, size_t len) {
+  size_t i = 0;
+
+  while (i + 64 <= len) {
+    const __m128i* p = reinterpret_cast<const __m128i*>(src + i);
+    __m128i a = _mm_or_si128(_mm_loadu_si128(p + 0), _mm_loadu_si128(p + 1));
+    __m128i b = _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3));
+    if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+      break;
+    i += 64;
+  }
+
+  while (i + 16 <= len) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(in) != 0)
+      break;
+    i += 16;
+  }
+
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static size_t AsciiPrefixAVX2(const char* src, size_t len) {
+  size_t i = 0;
+
+  while (i + 64 <= len) {
+    const __m256i* p = reinterpret_cast<const __m256i*>(src + i);
+    __m256i in = _mm256_or_si256(_mm256_loadu_si256(p + 0),
+                                 _mm256_loadu_si256(p + 1));
+    if (_mm256_movemask_epi8(in) != 0)
+      break;
+    i += 64;
+  }
+
+  return i + AsciiPrefixSSE2(src + i, len - i);
+}
+
+
+NODE_TARGET("sse2")
+static size_t ForceAsciiSSE2(const char* src, char* dst, size_t len) {
+  const __m128i mask = _mm_set1_epi8(0x7f);
+  size_t i = 0;
+
+  while (i + 16 <= len) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_and_si128(in, mask));
+    i += 16;
+  }
+
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static size_t ForceAsciiAVX2(const char* src, char* dst, size_t len) {
+  const __m256i mask = _mm256_set1_epi8(0x7f);
+  size_t i = 0;
+
+  while (i + 32 <= len) {
+    __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_and_si256(in, mask));
+    i += 32;
+  }
+
+  return i + ForceAsciiSSE2(src + i, dst + i, len - i);
+}
+
+#endif  // defined(NODE_HAVE_X86_SIMD)
+
+
+size_t Base64Encode(const char* src, size_t slen, char* dst) {
+  switch (cpu_level()) {
+#if defined(NODE_HAVE_X86_SIMD)
+    case kAVX2:
+      return Base64EncodeAVX2(src, slen, dst);
+    case kSSSE3:
+      return Base64EncodeSSSE3(src, slen, dst);
+#endif
+    default:
+      return 0;
+  }
+}
+
+
+size_t Base64Decode(const char* src,
+                    size_t slen,
+                    char* dst,
+                    size_t dlen,
+                    size_t* written) {
+  switch (cpu_level()) {
+#if defined(NODE_HAVE_X86_SIMD)
+    case kAVX2:
+      return Base64DecodeAVX2(src, slen, dst, dlen, written);
+    case kSSSE3:
+      return Base64DecodeSSSE3(src, slen, dst, dlen, written);
+#endif
+    default:
+      *written = 0;
+      return 0;
+  }
+}
+
+
+
+size_t HexEncode(const char* src, size_t slen, char* dst) {
+  switch (cpu_level()) {
+#if defined(NODE_HAVE_X86_SIMD)
+    case kAVX2:
+      return HexEncodeAVX2(src, slen, dst);
+    case kSSSE3:
+      return HexEncodeSSSE3(src, slen, dst);
+#endif
+    default:
+      return 0;
+  }
+}
+
+
+size_t HexDecode(const char* src,
+                 size_t slen,
+                 char* dst,
+                 size_t dlen,
+                 size_t* written) {
+  switch (cpu_level()) {
+#if defined(NODE_HAVE_X86_SIMD)
+    case kAVX2:
+      return HexDecodeAVX2(src, slen, dst, dlen, written);
+    case kSSSE3:
+      return HexDecodeSSSE3(src, slen, dst, dlen, written);
+#endif
+    default:
+      *written = 0;
+      return 0;
+  }
+}
+
+
+size_t AsciiPrefix(const char* src, size_t len) {
+  switch (cpu_level()) {
+#if defined(NODE_HAVE_X86_SIMD)
+    case kAVX2:
+      return AsciiPrefixAVX2(src, len);
+    case kSSSE3:
+    case kSSE2:
+      return AsciiPrefixSSE2(src, len);
+#endif
+    default:
+      return 0;
+  }
+}
+
+
+size_t ForceAscii(const char* src, char* dst, size_t len) {
+  switch (cpu_level()) {
+#if defined(NODE_HAVE_X86_SIMD)
+    case kAVX2:
+      return ForceAsciiAVX2(src, dst, len);
+    case kSSSE3:
+    case kSSE2:
+      return ForceAsciiSSE2(src, dst, len);
+#endif
+    default:
+      return 0;
+  }
+}
+
+}  // namespace simd
+}  // namespace node
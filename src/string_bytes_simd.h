@@ -0,0 +1,80 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_STRING_BYTES_SIMD_H_
+#define SRC_STRING_BYTES_SIMD_H_
+
+#include <stddef.h>
+
+// Vectorized kernels for the hot loops in string_bytes.cc. The best kernel
+// for the CPU we're running on is picked on first use; on CPUs or compilers
+// without support for it every function is a no-op that consumes nothing.
+//
+// Kernels only handle the bulk of the input: they stop early at anything
+// that needs special treatment and report how far they got, the scalar code
+// in string_bytes.cc then picks up where they left off.
+
+namespace node {
+namespace simd {
+
+// Encode as many whole 3 byte groups of `src` as possible into `dst`, which
+// must have room for the full base64 encoding of `slen` bytes. Returns the
+// number of source bytes consumed, always a multiple of 3.
+size_t Base64Encode(const char* src, size_t slen, char* dst);
+
+// Decode base64 from `src` into `dst` until the input runs out, `dst` fills
+// up or a character that is not part of the (regular or URL-safe) alphabet
+// is seen; padding and whitespace are left to the caller. Sets `*written`
+// to the number of bytes stored in `dst` and returns the number of source
+// characters consumed, always a multiple of 4.
+size_t Base64Decode(const char* src,
+                    size_t slen,
+                    char* dst,
+                    size_t dlen,
+                    size_t* written);
+
+// Encode as many bytes of `src` as possible as lowercase hex into `dst`,
+// which must have room for 2 * `slen` characters. Returns the number of
+// source bytes consumed.
+size_t HexEncode(const char* src, size_t slen, char* dst);
+
+// Decode hex pairs from `src` into `dst` until the input runs out, `dst`
+// fills up or a character that is not a hex digit is seen. Sets `*written`
+// to the number of bytes stored in `dst` and returns the number of source
+// characters consumed, always 2 * `*written`.
+size_t HexDecode(const char* src,
+                 size_t slen,
+                 char* dst,
+                 size_t dlen,
+                 size_t* written);
+
+// Return the length of a prefix of `src` that is known to be 7 bit ASCII.
+// The byte that follows is not necessarily non-ASCII.
+size_t AsciiPrefix(const char* src, size_t len);
+
+// Copy bytes from `src` to `dst` with the high bit cleared. Returns the
+// number of bytes processed.
+size_t ForceAscii(const char* src, char* dst, size_t len);
+
+}  // namespace simd
+}  // namespace node
+
+#endif  // SRC_STRING_BYTES_SIMD_H_
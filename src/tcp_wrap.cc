@@ -117,6 +117,8 @@ void TCPWrap::Initialize(Handle<Object> target,
 #endif
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "TCP"), t->GetFunction());
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "UV_TCP_REUSEPORT"),
+              Integer::New(UV_TCP_REUSEPORT, env->isolate()));
   env->set_tcp_constructor_template(t);
 }
 
@@ -256,15 +258,17 @@ void TCPWrap::Bind(const FunctionCallbackInfo<Value>& args) {
 
   TCPWrap* wrap = Unwrap<TCPWrap>(args.This());
 
+  // bind(ip, port[, flags])
   String::AsciiValue ip_address(args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->Uint32Value();
 
   sockaddr_in addr;
   int err = uv_ip4_addr(*ip_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
 
   args.GetReturnValue().Set(err);
@@ -277,15 +281,17 @@ void TCPWrap::Bind6(const FunctionCallbackInfo<Value>& args) {
 
   TCPWrap* wrap = Unwrap<TCPWrap>(args.This());
 
+  // bind6(ip, port[, flags])
   String::AsciiValue ip6_address(args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->Uint32Value();
 
   sockaddr_in6 addr;
   int err = uv_ip6_addr(*ip6_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
 
   args.GetReturnValue().Set(err);
@@ -82,9 +82,18 @@ TLSCallbacks::TLSCallbacks(Environment* env,
       shutdown_(false),
       error_(NULL),
       cycle_depth_(0),
-      eof_(false) {
+      eof_(false),
+      async_handshake_(false),
+      handshake_work_(NULL),
+      offload_in_(NULL),
+      offload_info_(0) {
   node::Wrap<TLSCallbacks>(object(), this);
 
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  offload_sni_ = NULL;
+  offload_sni_used_ = false;
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+
   // Initialize queue for clearIn writes
   QUEUE_INIT(&write_item_queue_);
   QUEUE_INIT(&pending_write_items_);
@@ -98,6 +107,23 @@ TLSCallbacks::TLSCallbacks(Environment* env,
 
 
 TLSCallbacks::~TLSCallbacks() {
+  if (handshake_work_ != NULL) {
+    HandshakeWork* work = handshake_work_;
+    handshake_work_ = NULL;
+
+    // The thread pool may be inside SSL_do_handshake(), wait for it before
+    // `ssl_` goes away. HandshakeAfterCb() frees the orphaned request.
+    if (uv_cancel(reinterpret_cast<uv_req_t*>(&work->req)) != 0) {
+      uv_mutex_lock(&work->mutex);
+      while (!work->done)
+        uv_cond_wait(&work->cond, &work->mutex);
+      uv_mutex_unlock(&work->mutex);
+    }
+    work->callbacks = NULL;
+  }
+  delete offload_in_;
+  offload_in_ = NULL;
+
   enc_in_ = NULL;
   enc_out_ = NULL;
   delete clear_in_;
@@ -168,6 +194,11 @@ void TLSCallbacks::InitSSL() {
   // Initialize SSL
   enc_in_ = NodeBIO::New();
   enc_out_ = NodeBIO::New();
+  NodeBIO::FromBIO(enc_in_)->AssignEnvironment(env());
+  NodeBIO::FromBIO(enc_out_)->AssignEnvironment(env());
+
+  // Socket reads land here, make room for a whole ClientHello or record
+  NodeBIO::FromBIO(enc_in_)->set_initial(NodeBIO::kThroughputBufferLength);
 
   SSL_set_bio(ssl_, enc_in_, enc_out_);
 
@@ -202,6 +233,7 @@ void TLSCallbacks::InitSSL() {
 
   // Initialize ring for queud clear data
   clear_in_ = new NodeBIO();
+  clear_in_->AssignEnvironment(env());
 }
 
 
@@ -289,33 +321,214 @@ void TLSCallbacks::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // a non-const SSL* in OpenSSL <= 0.9.7e.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSCallbacks* c = static_cast<TLSCallbacks*>(SSL_get_app_data(ssl));
-  Environment* env = c->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
-  Local<Object> object = c->object();
+
+  // Called from the thread pool, report once back on the loop thread
+  if (c->handshake_work_ != NULL) {
+    c->offload_info_ |= where;
+    return;
+  }
+
+  c->OnHandshakeInfo(where);
+}
+
+
+void TLSCallbacks::OnHandshakeInfo(int where) {
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  Local<Object> object = this->object();
 
   if (where & SSL_CB_HANDSHAKE_START) {
-    Local<Value> callback = object->Get(env->onhandshakestart_string());
+    Local<Value> callback = object->Get(env()->onhandshakestart_string());
     if (callback->IsFunction()) {
-      c->MakeCallback(callback.As<Function>(), 0, NULL);
+      MakeCallback(callback.As<Function>(), 0, NULL);
     }
   }
 
   if (where & SSL_CB_HANDSHAKE_DONE) {
-    c->established_ = true;
-    Local<Value> callback = object->Get(env->onhandshakedone_string());
+    established_ = true;
+    Local<Value> callback = object->Get(env()->onhandshakedone_string());
     if (callback->IsFunction()) {
-      c->MakeCallback(callback.As<Function>(), 0, NULL);
+      MakeCallback(callback.As<Function>(), 0, NULL);
     }
   }
 }
 
 
+bool TLSCallbacks::OffloadHandshake() {
+  if (!async_handshake_ || !is_server() || established_)
+    return false;
+  if (SSL_is_init_finished(ssl_))
+    return false;
+
+  // Nothing for SSL_do_handshake() to work on
+  if (NodeBIO::FromBIO(enc_in_)->Length() == 0)
+    return false;
+
+  // These callbacks call into JavaScript from inside OpenSSL
+  if (session_callbacks_ || !npn_protos_.IsEmpty())
+    return false;
+
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  // SelectSNIContextCallback() can't look at `sni_context` from the thread
+  // pool, resolve it now. Let the synchronous path report bad contexts.
+  HandleScope handle_scope(env()->isolate());
+  Local<Value> ctx = object()->Get(env()->sni_context_string());
+  offload_sni_ = NULL;
+  offload_sni_used_ = false;
+  if (ctx->IsObject()) {
+    Local<FunctionTemplate> cons = env()->secure_context_constructor_template();
+    if (!cons->HasInstance(ctx))
+      return false;
+    offload_sni_ = Unwrap<SecureContext>(ctx.As<Object>());
+    InitNPN(offload_sni_, this);
+  }
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+
+  // The handshake appends to `enc_out_`, which is still being written out.
+  // EncOutCb() picks the handshake up again.
+  if (write_size_ != 0)
+    return true;
+
+  if (offload_in_ == NULL) {
+    offload_in_ = new NodeBIO();
+    offload_in_->AssignEnvironment(env());
+  }
+
+  // The chunk freelist is for the loop thread only
+  NodeBIO::FromBIO(enc_in_)->AssignEnvironment(NULL);
+  NodeBIO::FromBIO(enc_out_)->AssignEnvironment(NULL);
+
+  HandshakeWork* work = new HandshakeWork();
+  work->req.data = this;
+  work->callbacks = this;
+  uv_mutex_init(&work->mutex);
+  uv_cond_init(&work->cond);
+  work->done = false;
+  work->ret = 0;
+  work->err = SSL_ERROR_NONE;
+  work->error_count = 0;
+
+  handshake_work_ = work;
+  ssl_offloaded_ = true;
+  offload_info_ = 0;
+  uv_queue_work(env()->event_loop(),
+                &work->req,
+                HandshakeWorkCb,
+                HandshakeAfterCb);
+  return true;
+}
+
+
+void TLSCallbacks::HandshakeWorkCb(uv_work_t* req) {
+  HandshakeWork* work = CONTAINER_OF(req, HandshakeWork, req);
+  SSL* ssl = work->callbacks->ssl_;
+
+  work->ret = SSL_do_handshake(ssl);
+  work->err = SSL_get_error(ssl, work->ret);
+
+  unsigned long err;
+  const char* file;
+  int line;
+  while ((err = ERR_get_error_line(&file, &line)) != 0) {
+    if (work->error_count == static_cast<int>(ARRAY_SIZE(work->errors)))
+      continue;
+    work->errors[work->error_count] = err;
+    work->error_files[work->error_count] = file;
+    work->error_lines[work->error_count] = line;
+    work->error_count++;
+  }
+
+  uv_mutex_lock(&work->mutex);
+  work->done = true;
+  uv_cond_signal(&work->cond);
+  uv_mutex_unlock(&work->mutex);
+}
+
+
+void TLSCallbacks::HandshakeAfterCb(uv_work_t* req, int status) {
+  HandshakeWork* work = CONTAINER_OF(req, HandshakeWork, req);
+  TLSCallbacks* c = work->callbacks;
+  int ret = work->ret;
+  int err = work->err;
+
+  if (c != NULL) {
+    assert(status == 0);
+    assert(c->handshake_work_ == work);
+    c->handshake_work_ = NULL;
+    c->ssl_offloaded_ = false;
+    NodeBIO::FromBIO(c->enc_in_)->AssignEnvironment(c->env());
+    NodeBIO::FromBIO(c->enc_out_)->AssignEnvironment(c->env());
+
+    for (int i = 0; i < work->error_count; i++) {
+      unsigned long e = work->errors[i];
+      ERR_put_error(ERR_GET_LIB(e),
+                    ERR_GET_FUNC(e),
+                    ERR_GET_REASON(e),
+                    work->error_files[i],
+                    work->error_lines[i]);
+    }
+  }
+
+  uv_cond_destroy(&work->cond);
+  uv_mutex_destroy(&work->mutex);
+  delete work;
+
+  if (c == NULL)
+    return;
+
+  // Hand over what was received in the meantime
+  NodeBIO* enc_in = NodeBIO::FromBIO(c->enc_in_);
+  while (c->offload_in_->Length() > 0) {
+    size_t avail = 0;
+    char* data = c->offload_in_->Peek(&avail);
+    enc_in->Write(data, avail);
+    c->offload_in_->Read(NULL, avail);
+  }
+
+  Environment* env = c->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  if (c->offload_sni_used_) {
+    c->sni_context_.Dispose();
+    c->sni_context_.Reset(env->isolate(),
+                          c->object()->Get(env->sni_context_string()));
+  }
+  c->offload_sni_ = NULL;
+  c->offload_sni_used_ = false;
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+
+  int where = c->offload_info_;
+  c->offload_info_ = 0;
+  if (where != 0)
+    c->OnHandshakeInfo(where);
+
+  if (ret <= 0 && err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+    Local<Value> arg = c->GetSSLError(ret, &err, NULL);
+    if (!arg.IsEmpty())
+      c->MakeCallback(env->onerror_string(), 1, &arg);
+
+    // Flush the alert
+    c->EncOut();
+    return;
+  }
+
+  // Send our part of the handshake before looking at the next one
+  c->EncOut();
+  c->Cycle();
+}
+
+
 void TLSCallbacks::EncOut() {
   // Ignore cycling data if ClientHello wasn't yet parsed
   if (!hello_parser_.IsEnded())
     return;
 
+  // Handshake in progress on the thread pool
+  if (handshake_work_ != NULL)
+    return;
+
   // Write in progress
   if (write_size_ != 0)
     return;
@@ -378,6 +591,10 @@ void TLSCallbacks::EncOutCb(uv_write_t* req, int status) {
   // Try writing more data
   callbacks->write_size_ = 0;
   callbacks->EncOut();
+
+  // OffloadHandshake() waits for the write to finish
+  if (callbacks->async_handshake_ && !callbacks->established_)
+    callbacks->ClearOut();
 }
 
 
@@ -446,21 +663,27 @@ void TLSCallbacks::ClearOut() {
   if (!hello_parser_.IsEnded())
     return;
 
+  if (handshake_work_ != NULL || OffloadHandshake())
+    return;
+
   HandleScope handle_scope(env()->isolate());
   Context::Scope context_scope(env()->context());
 
   assert(ssl_ != NULL);
 
-  char out[kClearOutChunkSize];
+  SlabAllocator* allocator = env()->slab_allocator();
   int read;
   do {
-    read = SSL_read(ssl_, out, sizeof(out));
+    char* out = allocator->Allocate(kClearOutChunkSize);
+    read = SSL_read(ssl_, out, kClearOutChunkSize);
     if (read > 0) {
       Local<Value> argv[] = {
         Integer::New(read, env()->isolate()),
-        Buffer::New(env(), out, read)
+        allocator->Shrink(env(), out, read)
       };
       wrap()->MakeCallback(env()->onread_string(), ARRAY_SIZE(argv), argv);
+    } else {
+      allocator->Release(out);
     }
   } while (read > 0);
 
@@ -487,6 +710,10 @@ bool TLSCallbacks::ClearIn() {
   if (!hello_parser_.IsEnded())
     return false;
 
+  // Keep SSL_write() away from a handshake that may go to the thread pool
+  if (handshake_work_ != NULL || (async_handshake_ && !established_))
+    return false;
+
   int written = 0;
   while (clear_in_->Length() > 0) {
     size_t avail = 0;
@@ -576,12 +803,52 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
     return 0;
   }
 
+  // Every SSL_write() emits at least one record with its own header and MAC,
+  // so runs of small buffers are gathered into `stage` and written as a
+  // single full-sized record. Large buffers are handed to OpenSSL as is,
+  // after whatever has been staged before them.
+  char stage[kClearInChunkSize];
+  size_t off = 0;
   int written = 0;
-  for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    assert(written == -1 || written == static_cast<int>(bufs[i].len));
-    if (written == -1)
-      break;
+  i = 0;
+  while (i < count) {
+    // Only small buffers are ever split across stages, so a large buffer
+    // always starts at offset zero.
+    if (off == 0 && (bufs[i].len >= sizeof(stage) || i + 1 == count)) {
+      written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
+      assert(written == -1 || written == static_cast<int>(bufs[i].len));
+      if (written == -1)
+        break;
+      i++;
+      continue;
+    }
+
+    size_t j = i;
+    size_t joff = off;
+    size_t staged = 0;
+    while (j < count && staged < sizeof(stage)) {
+      if (joff == 0 && bufs[j].len >= sizeof(stage))
+        break;
+      size_t avail = bufs[j].len - joff;
+      if (avail > sizeof(stage) - staged)
+        avail = sizeof(stage) - staged;
+      memcpy(stage + staged, bufs[j].base + joff, avail);
+      staged += avail;
+      joff += avail;
+      if (joff == bufs[j].len) {
+        j++;
+        joff = 0;
+      }
+    }
+
+    if (staged != 0) {
+      written = SSL_write(ssl_, stage, staged);
+      assert(written == -1 || written == static_cast<int>(staged));
+      if (written == -1)
+        break;
+    }
+    i = j;
+    off = joff;
   }
 
   if (i != count) {
@@ -593,7 +860,8 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
       return UV_EPROTO;
 
     // No errors, queue rest
-    for (; i < count; i++)
+    clear_in_->Write(bufs[i].base + off, bufs[i].len - off);
+    for (i++; i < count; i++)
       clear_in_->Write(bufs[i].base, bufs[i].len);
   }
 
@@ -612,6 +880,12 @@ void TLSCallbacks::AfterWrite(WriteWrap* w) {
 void TLSCallbacks::DoAlloc(uv_handle_t* handle,
                            size_t suggested_size,
                            uv_buf_t* buf) {
+  if (handshake_work_ != NULL) {
+    buf->base = offload_in_->PeekWritable(&suggested_size);
+    buf->len = suggested_size;
+    return;
+  }
+
   buf->base = NodeBIO::FromBIO(enc_in_)->PeekWritable(&suggested_size);
   buf->len = suggested_size;
 }
@@ -642,6 +916,12 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
   // Only client connections can receive data
   assert(ssl_ != NULL);
 
+  // `enc_in_` belongs to the thread pool, HandshakeAfterCb() moves it over
+  if (handshake_work_ != NULL) {
+    offload_in_->Commit(nread);
+    return;
+  }
+
   // Commit read data
   NodeBIO* enc_in = NodeBIO::FromBIO(enc_in_);
   enc_in->Commit(nread);
@@ -660,7 +940,7 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
 
 
 int TLSCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
-  if (SSL_shutdown(ssl_) == 0)
+  if (handshake_work_ == NULL && SSL_shutdown(ssl_) == 0)
     SSL_shutdown(ssl_);
   shutdown_ = true;
   EncOut();
@@ -673,6 +953,8 @@ void TLSCallbacks::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.This());
+  if (wrap->ThrowIfSSLOffloaded())
+    return;
 
   if (args.Length() < 2 || !args[0]->IsBoolean() || !args[1]->IsBoolean())
     return env->ThrowTypeError("Bad arguments, expected two booleans");
@@ -723,6 +1005,18 @@ void TLSCallbacks::EnableHelloParser(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSCallbacks::EnableAsyncHandshake(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.This());
+
+  if (wrap->is_server())
+    wrap->async_handshake_ = true;
+}
+
+
 void TLSCallbacks::OnClientHelloParseEnd(void* arg) {
   TLSCallbacks* c = static_cast<TLSCallbacks*>(arg);
   c->Cycle();
@@ -735,6 +1029,8 @@ void TLSCallbacks::GetServername(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.This());
+  if (wrap->ThrowIfSSLOffloaded())
+    return;
 
   const char* servername = SSL_get_servername(wrap->ssl_,
                                               TLSEXT_NAMETYPE_host_name);
@@ -769,7 +1065,8 @@ void TLSCallbacks::SetServername(const FunctionCallbackInfo<Value>& args) {
 
 
 int TLSCallbacks::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
-  TLSCallbacks* p = static_cast<TLSCallbacks*>(arg);
+  // `arg` is the last connection created with this context, not this one
+  TLSCallbacks* p = static_cast<TLSCallbacks*>(SSL_get_app_data(s));
   Environment* env = p->env();
 
   const char* servername = SSL_get_servername(s, TLSEXT_NAMETYPE_host_name);
@@ -777,6 +1074,15 @@ int TLSCallbacks::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   if (servername == NULL)
     return SSL_TLSEXT_ERR_OK;
 
+  // On the thread pool, use what OffloadHandshake() found
+  if (p->handshake_work_ != NULL) {
+    if (p->offload_sni_ == NULL)
+      return SSL_TLSEXT_ERR_NOACK;
+    p->offload_sni_used_ = true;
+    SSL_set_SSL_CTX(s, p->offload_sni_->ctx_);
+    return SSL_TLSEXT_ERR_OK;
+  }
+
   HandleScope scope(env->isolate());
   // Call the SNI callback and use its return value as context
   Local<Object> object = p->object();
@@ -825,6 +1131,9 @@ void TLSCallbacks::Initialize(Handle<Object> target,
   NODE_SET_PROTOTYPE_METHOD(t,
                             "enableHelloParser",
                             EnableHelloParser);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "enableAsyncHandshake",
+                            EnableAsyncHandshake);
 
   SSLWrap<TLSCallbacks>::AddMethods(env, t);
 
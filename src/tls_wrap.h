@@ -70,7 +70,13 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   void NewSessionDoneCb();
 
  protected:
-  static const int kClearOutChunkSize = 1024;
+  // Cleartext is read straight into slab memory, size chunks to hold
+  // a full TLS record.
+  static const int kClearOutChunkSize = 16 * 1024;
+
+  // Small cleartext buffers are coalesced up to the maximum TLS record
+  // payload before being passed to SSL_write()
+  static const int kClearInChunkSize = 16 * 1024;
 
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
@@ -96,7 +102,31 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
                StreamWrapCallbacks* old);
   ~TLSCallbacks();
 
+  // The part of a server's initial handshake that runs on the thread pool
+  struct HandshakeWork {
+    uv_work_t req;
+    TLSCallbacks* callbacks;  // NULL when the connection is gone
+
+    // Set by the thread pool after the last access to `callbacks`
+    uv_mutex_t mutex;
+    uv_cond_t cond;
+    bool done;
+
+    int ret;
+    int err;
+
+    // The error queue is thread local, carried back to the loop thread
+    unsigned long errors[8];
+    const char* error_files[8];
+    int error_lines[8];
+    int error_count;
+  };
+
   static void SSLInfoCallback(const SSL* ssl_, int where, int ret);
+  void OnHandshakeInfo(int where);
+  bool OffloadHandshake();
+  static void HandshakeWorkCb(uv_work_t* req);
+  static void HandshakeAfterCb(uv_work_t* req, int status);
   void InitSSL();
   void EncOut();
   static void EncOutCb(uv_write_t* req, int status);
@@ -131,6 +161,8 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableHelloParser(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncHandshake(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -158,8 +190,22 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   // after the `UV_EOF` on socket.
   bool eof_;
 
+  // Server handshake steps may run on the thread pool, see OffloadHandshake()
+  bool async_handshake_;
+  HandshakeWork* handshake_work_;
+
+  // Encrypted input received while `handshake_work_` owns `enc_in_`
+  NodeBIO* offload_in_;
+
+  // SSL_CB_HANDSHAKE_* events seen on the thread pool
+  int offload_info_;
+
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   v8::Persistent<v8::Value> sni_context_;
+
+  // `sni_context` property resolved before going to the thread pool
+  crypto::SecureContext* offload_sni_;
+  bool offload_sni_used_;
 #endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
 
   static size_t error_off_;
@@ -24,15 +24,20 @@
 #include "env-inl.h"
 #include "node_buffer.h"
 #include "handle_wrap.h"
+#include "node_internals.h"
 #include "req_wrap.h"
+#include "slab_allocator.h"
+#include "smalloc.h"
 #include "util.h"
 #include "util-inl.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -42,12 +47,60 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Object;
+using v8::Persistent;
 using v8::PropertyAttribute;
 using v8::PropertyCallbackInfo;
 using v8::String;
 using v8::Uint32;
 using v8::Undefined;
 using v8::Value;
+using v8::kExternalUnsignedIntArray;
+
+
+// Batch delivery hands JS a single Buffer with the datagrams back to back and
+// a table of (offset, length, family, port, address index) entries. Source
+// addresses are interned in a small per-socket cache whose strings live in
+// the `addresses` array passed along with every batch.
+struct UDPWrap::Batch {
+  static const size_t kMaxEntries = 64;
+  static const size_t kFieldsPerEntry = 5;
+  static const size_t kAddressCacheSize = 16;
+  static const uint32_t kNoAddress = static_cast<uint32_t>(-1);
+
+  struct Entry {
+    const char* data;
+    uint32_t size;
+    uint32_t family;
+    uint32_t port;
+    uint32_t address;
+  };
+
+  // An address is keyed on its raw bytes. `serial` is the number of the
+  // batch that last used it, a slot still referenced by the pending batch
+  // can't be reused until that batch is flushed.
+  struct CachedAddress {
+    unsigned char bytes[16];
+    uint32_t family;
+    uint32_t serial;
+  };
+
+  Batch() : count(0), bytes(0), serial(1), next_slot(0), used_slots(0) {
+    memset(addresses, 0, sizeof(addresses));
+  }
+
+  ~Batch() {
+    strings.Dispose();
+  }
+
+  Entry entries[kMaxEntries];
+  size_t count;
+  size_t bytes;
+  uint32_t serial;
+  CachedAddress addresses[kAddressCacheSize];
+  size_t next_slot;
+  size_t used_slots;
+  Persistent<Array> strings;
+};
 
 
 class SendWrap : public ReqWrap<uv_udp_send_t> {
@@ -76,13 +129,18 @@ UDPWrap::UDPWrap(Environment* env, Handle<Object> object)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      mmsg_buf_(NULL),
+      mmsg_len_(0),
+      batch_(NULL) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   assert(r == 0);  // can't fail anyway
 }
 
 
 UDPWrap::~UDPWrap() {
+  free(mmsg_buf_);
+  delete batch_;
 }
 
 
@@ -118,11 +176,15 @@ void UDPWrap::Initialize(Handle<Object> target,
   NODE_SET_PROTOTYPE_METHOD(t, "setMulticastLoopback", SetMulticastLoopback);
   NODE_SET_PROTOTYPE_METHOD(t, "setBroadcast", SetBroadcast);
   NODE_SET_PROTOTYPE_METHOD(t, "setTTL", SetTTL);
+  NODE_SET_PROTOTYPE_METHOD(t, "setRecvmmsg", SetRecvmmsg);
+  NODE_SET_PROTOTYPE_METHOD(t, "setBatchDelivery", SetBatchDelivery);
 
   NODE_SET_PROTOTYPE_METHOD(t, "ref", HandleWrap::Ref);
   NODE_SET_PROTOTYPE_METHOD(t, "unref", HandleWrap::Unref);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "UDP"), t->GetFunction());
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "UV_UDP_REUSEPORT"),
+              Integer::New(UV_UDP_REUSEPORT, env->isolate()));
   env->set_udp_constructor_function(t->GetFunction());
 }
 
@@ -207,10 +269,30 @@ X(SetTTL, uv_udp_set_ttl)
 X(SetBroadcast, uv_udp_set_broadcast)
 X(SetMulticastTTL, uv_udp_set_multicast_ttl)
 X(SetMulticastLoopback, uv_udp_set_multicast_loop)
+X(SetRecvmmsg, uv_udp_set_recvmmsg)
 
 #undef X
 
 
+void UDPWrap::SetBatchDelivery(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.This());
+
+  if (args[0]->BooleanValue()) {
+    if (wrap->batch_ == NULL) {
+      wrap->batch_ = new Batch;
+      wrap->batch_->strings.Reset(env->isolate(), Array::New());
+    }
+  } else {
+    // JS only runs between batches, there is nothing left to deliver.
+    assert(wrap->batch_ == NULL || wrap->batch_->count == 0);
+    delete wrap->batch_;
+    wrap->batch_ = NULL;
+  }
+}
+
+
 void UDPWrap::SetMembership(const FunctionCallbackInfo<Value>& args,
                             uv_membership membership) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
@@ -381,13 +463,158 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  // libuv only asks for more than one datagram's worth in recvmmsg() mode.
+  if (suggested_size > 64 * 1024) {
+    if (wrap->mmsg_buf_ == NULL) {
+      wrap->mmsg_buf_ = static_cast<char*>(malloc(suggested_size));
+      if (wrap->mmsg_buf_ == NULL)
+        FatalError("node::UDPWrap::OnAlloc()", "Out Of Memory");
+      wrap->mmsg_len_ = suggested_size;
+    }
+    buf->base = wrap->mmsg_buf_;
+    buf->len = wrap->mmsg_len_;
+    return;
+  }
+
+  buf->base = wrap->env()->slab_allocator()->Allocate(suggested_size);
   buf->len = suggested_size;
+}
+
 
-  if (buf->base == NULL && suggested_size > 0) {
-    FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
-               "Out Of Memory");
+bool UDPWrap::IsMmsgChunk(const char* data) const {
+  return data >= mmsg_buf_ && data < mmsg_buf_ + mmsg_len_;
+}
+
+
+uint32_t UDPWrap::InternAddress(const struct sockaddr* addr) {
+  const unsigned char* bytes;
+  size_t size;
+
+  if (addr->sa_family == AF_INET6) {
+    const sockaddr_in6* a6 = reinterpret_cast<const sockaddr_in6*>(addr);
+    bytes = reinterpret_cast<const unsigned char*>(&a6->sin6_addr);
+    size = sizeof(a6->sin6_addr);
+  } else {
+    const sockaddr_in* a4 = reinterpret_cast<const sockaddr_in*>(addr);
+    bytes = reinterpret_cast<const unsigned char*>(&a4->sin_addr);
+    size = sizeof(a4->sin_addr);
   }
+
+  for (size_t i = 0; i < batch_->used_slots; i++) {
+    Batch::CachedAddress* cached = &batch_->addresses[i];
+    if (cached->family == addr->sa_family &&
+        memcmp(cached->bytes, bytes, size) == 0) {
+      cached->serial = batch_->serial;
+      return i;
+    }
+  }
+
+  // Every slot is taken by the pending batch.
+  size_t slot = batch_->next_slot;
+  if (batch_->addresses[slot].serial == batch_->serial)
+    return Batch::kNoAddress;
+
+  batch_->next_slot = (slot + 1) % Batch::kAddressCacheSize;
+  if (batch_->used_slots < Batch::kAddressCacheSize)
+    batch_->used_slots += 1;
+
+  Batch::CachedAddress* cached = &batch_->addresses[slot];
+  memset(cached->bytes, 0, sizeof(cached->bytes));
+  memcpy(cached->bytes, bytes, size);
+  cached->family = addr->sa_family;
+  cached->serial = batch_->serial;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  char ip[INET6_ADDRSTRLEN];
+  uv_inet_ntop(addr->sa_family, bytes, ip, sizeof(ip));
+  Local<Array> strings = PersistentToLocal(env->isolate(), batch_->strings);
+  strings->Set(slot, OneByteString(env->isolate(), ip));
+
+  return slot;
+}
+
+
+// Returns false when the pending batch has to be flushed first.
+bool UDPWrap::Enqueue(const char* data,
+                      size_t size,
+                      const struct sockaddr* addr) {
+  if (batch_->count == Batch::kMaxEntries)
+    return false;
+
+  uint32_t address = InternAddress(addr);
+  if (address == Batch::kNoAddress)
+    return false;
+
+  Batch::Entry* entry = &batch_->entries[batch_->count++];
+  entry->data = data;
+  entry->size = size;
+  if (addr->sa_family == AF_INET6) {
+    entry->family = 6;
+    entry->port = ntohs(reinterpret_cast<const sockaddr_in6*>(addr)->sin6_port);
+  } else {
+    entry->family = 4;
+    entry->port = ntohs(reinterpret_cast<const sockaddr_in*>(addr)->sin_port);
+  }
+  entry->address = address;
+  batch_->bytes += size;
+  return true;
+}
+
+
+// The datagrams are copied into one slab buffer, the memory they point to is
+// only valid until libuv reads the next batch.
+void UDPWrap::FlushBatch() {
+  Batch* batch = batch_;
+  if (batch->count == 0)
+    return;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  SlabAllocator* slab_allocator = env->slab_allocator();
+
+  char* data = slab_allocator->Allocate(batch->bytes);
+  Local<Object> table = Object::New();
+  uint32_t length = batch->count * Batch::kFieldsPerEntry;
+  smalloc::Alloc(env,
+                 table,
+                 length * sizeof(uint32_t),
+                 kExternalUnsignedIntArray);
+  table->Set(env->length_string(),
+             Uint32::NewFromUnsigned(length, env->isolate()));
+
+  uint32_t* fields =
+      static_cast<uint32_t*>(table->GetIndexedPropertiesExternalArrayData());
+  uint32_t offset = 0;
+
+  for (size_t i = 0; i < batch->count; i++) {
+    const Batch::Entry* entry = &batch->entries[i];
+    memcpy(data + offset, entry->data, entry->size);
+    *fields++ = offset;
+    *fields++ = entry->size;
+    *fields++ = entry->family;
+    *fields++ = entry->port;
+    *fields++ = entry->address;
+    offset += entry->size;
+  }
+
+  Local<Value> argv[] = {
+    Integer::NewFromUnsigned(batch->count, env->isolate()),
+    object(),
+    slab_allocator->Shrink(env, data, batch->bytes),
+    table,
+    PersistentToLocal(env->isolate(), batch->strings)
+  };
+
+  // Reset first, the callback may turn batch delivery off.
+  batch->count = 0;
+  batch->bytes = 0;
+  batch->serial += 1;
+
+  MakeCallback(env->onbatch_string(), ARRAY_SIZE(argv), argv);
 }
 
 
@@ -396,15 +623,39 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  Environment* env = wrap->env();
+  SlabAllocator* slab_allocator = env->slab_allocator();
+  bool chunk = wrap->IsMmsgChunk(buf->base);
+
+  // In batch mode datagrams are collected until libuv is done with the
+  // receive buffer, it signals that with nread == 0 and no address. Note
+  // that FlushBatch() calls into JS, which may turn batch delivery off.
+  if (wrap->batch_ != NULL && nread > 0 &&
+      !wrap->Enqueue(buf->base, nread, addr)) {
+    wrap->FlushBatch();
+    if (wrap->batch_ != NULL) {
+      bool queued = wrap->Enqueue(buf->base, nread, addr);
+      assert(queued);
+    }
+  }
+
+  if (wrap->batch_ != NULL) {
+    if (nread <= 0 || !chunk)
+      wrap->FlushBatch();
+    if (nread >= 0) {
+      if (!chunk)
+        slab_allocator->Release(buf->base);
+      return;
+    }
+  }
+
   if (nread == 0) {
-    if (buf->base != NULL)
-      free(buf->base);
+    if (!chunk)
+      slab_allocator->Release(buf->base);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
-  Environment* env = wrap->env();
-
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
@@ -417,14 +668,19 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != NULL)
-      free(buf->base);
+    if (!chunk)
+      slab_allocator->Release(buf->base);
     wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
-  argv[2] = Buffer::Use(env, base, nread);
+  if (chunk) {
+    char* data = slab_allocator->Allocate(nread);
+    memcpy(data, buf->base, nread);
+    argv[2] = slab_allocator->Shrink(env, data, nread);
+  } else {
+    argv[2] = slab_allocator->Shrink(env, buf->base, nread);
+  }
   argv[3] = AddressToJS(env, addr);
   wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
 }
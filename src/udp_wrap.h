@@ -52,6 +52,9 @@ class UDPWrap: public HandleWrap {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTTL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetRecvmmsg(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetBatchDelivery(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static v8::Local<v8::Object> Instantiate(Environment* env);
   uv_udp_t* UVHandle();
@@ -77,7 +80,22 @@ class UDPWrap: public HandleWrap {
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  inline bool IsMmsgChunk(const char* data) const;
+
+  struct Batch;
+  bool Enqueue(const char* data, size_t size, const struct sockaddr* addr);
+  uint32_t InternAddress(const struct sockaddr* addr);
+  void FlushBatch();
+
   uv_udp_t handle_;
+  // Receive buffer that libuv cuts into slots when it reads a batch of
+  // datagrams with recvmmsg(). Allocated on first use and reused for every
+  // batch, the datagrams are copied out into right sized slab buffers.
+  char* mmsg_buf_;
+  size_t mmsg_len_;
+  // Datagrams waiting to be delivered in one onbatch callback. NULL unless
+  // batch delivery is on.
+  Batch* batch_;
 };
 
 }  // namespace node
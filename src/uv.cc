@@ -27,12 +27,16 @@
 namespace node {
 namespace uv {
 
+using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -49,12 +53,72 @@ void ErrName(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static Local<Object> ThreadpoolClassStats(
+    Isolate* isolate,
+    const uv_threadpool_class_stats_t& stats) {
+  Local<Object> info = Object::New();
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "queued"),
+            Integer::NewFromUnsigned(stats.queued, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "running"),
+            Integer::NewFromUnsigned(stats.running, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "limit"),
+            Integer::NewFromUnsigned(stats.limit, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "completed"),
+            Number::New(isolate, static_cast<double>(stats.completed)));
+
+  Local<Array> wait = Array::New(UV_THREADPOOL_WAIT_BUCKETS);
+  for (int i = 0; i < UV_THREADPOOL_WAIT_BUCKETS; i++)
+    wait->Set(i, Number::New(isolate, static_cast<double>(stats.wait[i])));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "wait"), wait);
+
+  return info;
+}
+
+
+// Counters of the libuv thread pool. `wait` is a histogram of queueing
+// delays, wait[0] counts waits under 1 us and wait[i] waits of
+// [2^(i-1), 2^i) us.
+void GetThreadpoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+  Isolate* isolate = env->isolate();
+
+  uv_threadpool_stats_t stats;
+  int err = uv_threadpool_stats(&stats);
+  if (err)
+    return env->ThrowUVException(err, "uv_threadpool_stats");
+
+  Local<Object> info = Object::New();
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "threads"),
+            Integer::NewFromUnsigned(stats.threads, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "idle"),
+            Integer::NewFromUnsigned(stats.idle, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "minThreads"),
+            Integer::NewFromUnsigned(stats.min_threads, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "maxThreads"),
+            Integer::NewFromUnsigned(stats.max_threads, isolate));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "cpu"),
+            ThreadpoolClassStats(isolate, stats.classes[UV_THREADPOOL_CPU]));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "io"),
+            ThreadpoolClassStats(isolate, stats.classes[UV_THREADPOOL_IO]));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "dns"),
+            ThreadpoolClassStats(isolate, stats.classes[UV_THREADPOOL_DNS]));
+  info->Set(FIXED_ONE_BYTE_STRING(isolate, "slowCpu"),
+            ThreadpoolClassStats(isolate,
+                                 stats.classes[UV_THREADPOOL_SLOW_CPU]));
+
+  args.GetReturnValue().Set(info);
+}
+
+
 void Initialize(Handle<Object> target,
                 Handle<Value> unused,
                 Handle<Context> context) {
   Environment* env = Environment::GetCurrent(context);
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "errname"),
               FunctionTemplate::New(ErrName)->GetFunction());
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "getThreadpoolStats"),
+              FunctionTemplate::New(GetThreadpoolStats)->GetFunction());
 #define V(name, _)                                                            \
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "UV_" # name),            \
               Integer::New(UV_ ## name, env->isolate()));
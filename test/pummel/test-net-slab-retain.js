@@ -0,0 +1,92 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Flags: --expose-gc
+
+// Read buffers are carved out of shared slabs. Holding on to small reads
+// must not keep the slabs they came from alive: every round trip streams a
+// bulk payload that is dropped, then a short message that is kept.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+assert(typeof gc === 'function', 'Run this test with --expose-gc');
+
+var ROUNDS = 2000;
+var BULK = 64 * 1024;
+var MESSAGE = 'retain me';
+
+var retained = [];
+var before = 0;
+
+var server = net.createServer(function(socket) {
+  var pending = 0;
+  socket.on('data', function(chunk) {
+    if (pending < BULK) {
+      pending += chunk.length;
+      if (pending === BULK)
+        socket.write('a');
+      return;
+    }
+    // The message is written only after the bulk is acknowledged, so it
+    // arrives on its own.
+    assert.equal(chunk.toString(), MESSAGE);
+    retained.push(chunk);
+    pending = 0;
+    socket.write('b');
+  });
+});
+
+server.listen(common.PORT, function() {
+  var bulk = new Buffer(BULK);
+  bulk.fill(42);
+  var rounds = 0;
+
+  gc();
+  before = process.memoryUsage().rss;
+
+  var client = net.connect(common.PORT, function() {
+    client.write(bulk);
+  });
+
+  client.on('data', function(data) {
+    for (var i = 0; i < data.length; i++) {
+      if (data[i] === 97 /* a */) {
+        client.write(MESSAGE);
+      } else if (++rounds < ROUNDS) {
+        client.write(bulk);
+      } else {
+        client.end();
+        server.close();
+      }
+    }
+  });
+});
+
+process.on('exit', function() {
+  gc();
+  var grown = (process.memoryUsage().rss - before) / 1024;
+  console.log('%d kB retained for %d messages', grown, retained.length);
+  assert.equal(retained.length, ROUNDS);
+  // Pinning the slabs would keep about ROUNDS * BULK = 128 MB alive.
+  assert(grown < 48 * 1024);
+});
@@ -0,0 +1,77 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Exercise the base64 encoder and decoder at and around the block sizes
+// of the vectorized code paths.
+
+var common = require('../common');
+var assert = require('assert');
+
+var alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+function reference(buf) {
+  var out = '';
+  for (var i = 0; i < buf.length; i += 3) {
+    var n = buf.length - i;
+    var a = buf[i];
+    var b = n > 1 ? buf[i + 1] : 0;
+    var c = n > 2 ? buf[i + 2] : 0;
+    out += alphabet[a >> 2];
+    out += alphabet[((a & 3) << 4) | (b >> 4)];
+    out += n > 1 ? alphabet[((b & 15) << 2) | (c >> 6)] : '=';
+    out += n > 2 ? alphabet[c & 63] : '=';
+  }
+  return out;
+}
+
+function pattern(length, seed) {
+  var buf = new Buffer(length);
+  for (var i = 0; i < length; i++)
+    buf[i] = (i * 7 + seed * 13) & 255;
+  return buf;
+}
+
+for (var length = 0; length < 200; length++) {
+  var buf = pattern(length, length);
+  var encoded = reference(buf);
+  assert.equal(buf.toString('base64'), encoded);
+  assert.deepEqual(new Buffer(encoded, 'base64'), buf);
+
+  // URL-safe alphabet.
+  var urlsafe = encoded.replace(/\+/g, '-').replace(/\//g, '_');
+  assert.deepEqual(new Buffer(urlsafe, 'base64'), buf);
+
+  // Whitespace anywhere in the input is skipped.
+  var middle = (encoded.length >> 1) & ~3;
+  var spaced = encoded.slice(0, middle) + '\r\n' + encoded.slice(middle);
+  assert.deepEqual(new Buffer(spaced, 'base64'), buf);
+}
+
+// Large input, including an encoded string that v8 externalizes.
+var large = pattern(3 * 1024 * 1024 + 1, 42);
+var encoded = large.toString('base64');
+assert.equal(encoded, reference(large));
+assert.deepEqual(new Buffer(encoded, 'base64'), large);
+
+// Writing into a short buffer stops when it is full.
+var short = new Buffer(10);
+assert.equal(short.write(reference(pattern(64, 1)), 'base64'), 10);
+assert.deepEqual(short, pattern(64, 1).slice(0, 10));
@@ -0,0 +1,84 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Exercise the hex, ascii and utf8 coders at and around the block sizes
+// of the vectorized code paths.
+
+var common = require('../common');
+var assert = require('assert');
+
+var digits = '0123456789abcdef';
+
+function reference(buf) {
+  var out = '';
+  for (var i = 0; i < buf.length; i++)
+    out += digits[buf[i] >> 4] + digits[buf[i] & 15];
+  return out;
+}
+
+function pattern(length, seed) {
+  var buf = new Buffer(length);
+  for (var i = 0; i < length; i++)
+    buf[i] = (i * 7 + seed * 13) & 255;
+  return buf;
+}
+
+for (var length = 0; length < 200; length++) {
+  var buf = pattern(length, length);
+  var encoded = reference(buf);
+  assert.equal(buf.toString('hex'), encoded);
+  assert.deepEqual(new Buffer(encoded, 'hex'), buf);
+  assert.deepEqual(new Buffer(encoded.toUpperCase(), 'hex'), buf);
+
+  // Decoding stops at the first pair that is not hex.
+  if (length > 0) {
+    var at = length >> 1;
+    var bad = encoded.slice(0, at * 2) + 'g' + encoded.slice(at * 2 + 1);
+    assert.deepEqual(new Buffer(bad, 'hex'), buf.slice(0, at));
+  }
+
+  // ascii strips the high bit, utf8 passes ascii through untouched.
+  var ascii = '';
+  for (var i = 0; i < length; i++)
+    ascii += String.fromCharCode(buf[i] & 127);
+  assert.equal(buf.toString('ascii'), ascii);
+  assert.equal(buf.toString('ascii', 1), ascii.slice(1));
+  assert.equal(new Buffer(ascii, 'ascii').toString('utf8'), ascii);
+
+  // A multi-byte sequence anywhere still goes through the utf8 decoder.
+  var text = ascii.slice(0, length >> 1) + 'é€' +
+             ascii.slice(length >> 1);
+  assert.equal(new Buffer(text, 'utf8').toString('utf8'), text);
+}
+
+// Large input, including an encoded string that v8 externalizes.
+var large = pattern(1024 * 1024 + 3, 42);
+var encoded = large.toString('hex');
+assert.equal(encoded, reference(large));
+assert.deepEqual(new Buffer(encoded, 'hex'), large);
+
+var text = new Array(1024 * 1024 + 2).join('x');
+assert.equal(new Buffer(text).toString('utf8'), text);
+
+// Writing into a short buffer stops when it is full.
+var short = new Buffer(10);
+assert.equal(short.write(reference(pattern(64, 1)), 'hex'), 10);
+assert.deepEqual(short, pattern(64, 1).slice(0, 10));
@@ -0,0 +1,126 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Round-trip messages over a binary IPC channel. The child echoes every
+// message back to the parent.
+
+var assert = require('assert');
+var common = require('../common');
+var fork = require('child_process').fork;
+
+if (process.argv[2] === 'child') {
+  process.on('message', function(m) {
+    if (m === 'done')
+      process.disconnect();
+    else
+      process.send(m);
+  });
+  return;
+}
+
+assert.throws(function() {
+  fork(__filename, ['child'], { serialization: 'xml' });
+}, TypeError);
+
+var child = fork(__filename, ['child'], { serialization: 'binary' });
+
+var big = new Buffer(4 * 1024 * 1024);
+for (var i = 0; i < big.length; i++) big[i] = i % 251;
+
+var tests = [
+  // Same result as a JSON round-trip.
+  [{ a: 1, b: 'two', c: [3, 4.5, null, true, false], d: { e: {} } },
+   { a: 1, b: 'two', c: [3, 4.5, null, true, false], d: { e: {} } }],
+  ['é€😀', 'é€😀'],
+  [-2147483648, -2147483648],
+  [4294967296, 4294967296],
+  [[undefined, function() {}, NaN, Infinity], [null, null, null, null]],
+  [{ skip: undefined, fn: function() {}, keep: 0 }, { keep: 0 }],
+  [new Date(0), '1970-01-01T00:00:00.000Z'],
+  [new String('boxed'), 'boxed'],
+  [{ toJSON: function() { return 42; } }, 42],
+  // Properties are dropped after toJSON(), not before.
+  [{ gone: { toJSON: function() {} }, keep: 0 }, { keep: 0 }],
+  [[{ toJSON: function() {} }], [null]],
+  [null, null],
+  // -0 comes out as 0.
+  [-0, 0],
+  // An own __proto__ property stays one and doesn't replace the prototype.
+  [JSON.parse('{"__proto__":{"x":1},"y":2}'),
+   JSON.parse('{"__proto__":{"x":1},"y":2}')],
+  // Binary data is copied as-is.
+  [new Buffer('hello'), new Buffer('hello')],
+  [big, big],
+  [{ cmd: 'data', payload: new Buffer([1, 2, 3]) },
+   { cmd: 'data', payload: new Buffer([1, 2, 3]) }]
+];
+
+var received = 0;
+
+child.on('message', function(m) {
+  if (received === tests.length) {
+    assert(m[0] instanceof Uint16Array);
+    assert.equal(m[0].length, 3);
+    assert.equal(m[0][2], 65535);
+    assert(m[1] instanceof Float64Array);
+    assert.equal(m[1][0], 0.5);
+    received++;
+    child.send('done');
+    return;
+  }
+
+  var expected = tests[received++][1];
+  if (Buffer.isBuffer(expected)) {
+    assert(Buffer.isBuffer(m));
+    assert.equal(m.toString('hex'), expected.toString('hex'));
+  } else if (expected && Buffer.isBuffer(expected.payload)) {
+    assert.equal(m.cmd, expected.cmd);
+    assert(Buffer.isBuffer(m.payload));
+    assert.equal(m.payload.toString('hex'), expected.payload.toString('hex'));
+  } else {
+    assert.deepEqual(m, expected);
+    if (expected === 0)
+      assert.equal(1 / m, Infinity);
+    if (expected !== null && typeof expected === 'object') {
+      assert.equal(Object.getPrototypeOf(m), Object.getPrototypeOf(expected));
+      assert.deepEqual(Object.keys(m), Object.keys(expected));
+    }
+  }
+
+  // Typed arrays last, they don't survive assert.deepEqual().
+  if (received === tests.length) {
+    var floats = new Float64Array(2);
+    floats[0] = 0.5;
+    child.send([new Uint16Array([1, 2, 65535]), floats]);
+  }
+});
+
+tests.forEach(function(test) {
+  child.send(test[0]);
+});
+
+var a = [];
+a.push(a);
+assert.throws(function() { child.send(a); }, TypeError);
+
+process.on('exit', function() {
+  assert.equal(received, tests.length + 1);
+});
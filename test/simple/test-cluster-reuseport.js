@@ -0,0 +1,102 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Every worker binds its own SO_REUSEPORT socket. Check that a request for
+// port 0 resolves to the same port in all workers and that every connection
+// is accepted by one of them.
+
+var NUM_WORKERS = 4;
+var NUM_CONNECTIONS = 64;
+
+var assert = require('assert');
+var cluster = require('cluster');
+var common = require('../common');
+var net = require('net');
+
+if (process.platform !== 'linux') {
+  console.error('Skipping test, SO_REUSEPORT balancing is Linux only.');
+  process.exit(0);
+}
+
+if (cluster.isMaster)
+  master();
+else
+  worker();
+
+
+function master() {
+  var ports = [];
+  var accepted = 0;
+  var skipped = false;
+
+  cluster.schedulingPolicy = cluster.SCHED_REUSEPORT;
+
+  for (var i = 0; i < NUM_WORKERS; i++) {
+    cluster.fork().on('message', function(msg) {
+      if (msg.cmd === 'accepted') accepted++;
+      if (msg.cmd === 'enotsup') skip();
+    });
+  }
+
+  cluster.on('listening', function(worker, address) {
+    ports.push(address.port);
+    if (ports.length < NUM_WORKERS)
+      return;
+
+    ports.forEach(function(port) {
+      assert.notEqual(port, 0);
+      assert.equal(port, ports[0]);
+    });
+
+    var done = 0;
+    for (var i = 0; i < NUM_CONNECTIONS; i++) {
+      net.connect(ports[0], '127.0.0.1').on('close', function() {
+        if (++done === NUM_CONNECTIONS) cluster.disconnect();
+      }).resume();
+    }
+  });
+
+  function skip() {
+    if (skipped) return;
+    skipped = true;
+    console.error('Skipping test, kernel does not support SO_REUSEPORT.');
+    cluster.disconnect();
+  }
+
+  process.on('exit', function() {
+    if (skipped) return;
+    assert.equal(ports.length, NUM_WORKERS);
+    assert.equal(accepted, NUM_CONNECTIONS);
+  });
+}
+
+
+function worker() {
+  var server = net.createServer(function(conn) {
+    process.send({ cmd: 'accepted' });
+    conn.end();
+  });
+  server.on('error', function(err) {
+    assert.equal(err.code, 'ENOTSUP');
+    process.send({ cmd: 'enotsup' });
+  });
+  server.listen(0, '127.0.0.1');
+}
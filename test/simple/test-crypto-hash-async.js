@@ -0,0 +1,91 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+crypto.DEFAULT_ENCODING = 'buffer';
+
+var big = new Buffer(3 * 1024 * 1024 + 17);
+for (var i = 0; i < big.length; i++)
+  big[i] = i & 0xff;
+
+function syncHash(algo, data) {
+  return crypto.createHash(algo).update(data).digest('hex');
+}
+
+function syncHmac(algo, key, data) {
+  return crypto.createHmac(algo, key).update(data).digest('hex');
+}
+
+var pending = 0;
+function expect(expected) {
+  pending++;
+  return function(err, digest) {
+    assert.ifError(err);
+    assert.equal(digest, expected);
+    pending--;
+  };
+}
+
+['md5', 'sha1', 'sha256', 'sha512'].forEach(function(algo) {
+  var expected = syncHash(algo, big);
+  crypto.hashAsync(algo, big, { encoding: 'hex' }, expect(expected));
+  // Chunked, with a chunk size that doesn't divide the input.
+  crypto.hashAsync(algo, big, { encoding: 'hex', chunkSize: 65536 },
+                   expect(expected));
+  crypto.hashAsync(algo, big, { encoding: 'hex', chunkSize: 0 },
+                   expect(expected));
+
+  expected = syncHmac(algo, 'secret', big);
+  crypto.hmacAsync(algo, 'secret', big, { encoding: 'hex', chunkSize: 1000 },
+                   expect(expected));
+});
+
+// Buffer result, empty input and empty key
+pending++;
+crypto.hashAsync('sha1', new Buffer(0), function(err, digest) {
+  assert.ifError(err);
+  assert(Buffer.isBuffer(digest));
+  assert.equal(digest.toString('hex'), syncHash('sha1', ''));
+  pending--;
+});
+crypto.hmacAsync('sha1', '', 'data', { encoding: 'base64' },
+                 expect(crypto.createHmac('sha1', '').update('data')
+                                                     .digest('base64')));
+
+assert.throws(function() {
+  crypto.hashAsync('no-such-hash', big, function() {});
+}, /Digest method not supported/);
+
+assert.throws(function() {
+  crypto.hashAsync('sha1', big);
+}, /No callback provided/);
+
+process.on('exit', function() {
+  assert.equal(pending, 0);
+});
@@ -0,0 +1,116 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+function md5(data) {
+  return crypto.createHash('md5').update(data).digest('hex');
+}
+
+var words = ['foo', 'bar', '', 'baz', new Buffer('quux')];
+var expected = words.map(md5);
+
+// Array of inputs
+assert.deepEqual(crypto.hashBatch('md5', words, { encoding: 'hex' }),
+                 expected);
+
+var digests = crypto.hashBatch('sha256', words);
+assert.equal(digests.length, words.length);
+assert(Buffer.isBuffer(digests[0]));
+assert.equal(digests[0].length, 32);
+assert.equal(digests[3].toString('hex'),
+             crypto.createHash('sha256').update('baz').digest('hex'));
+
+// One buffer and offsets, as an array or typed array
+var data = new Buffer('foobarbazquux');
+assert.deepEqual(crypto.hashBatch('md5', data, {
+  offsets: [0, 3, 6, 6, 9, 13],
+  encoding: 'hex'
+}), expected);
+assert.deepEqual(crypto.hashBatch('md5', data, {
+  offsets: new Uint32Array([3, 6, 9]),
+  encoding: 'hex'
+}), ['bar', 'baz'].map(md5));
+assert.deepEqual(crypto.hashBatch('md5', data, { offsets: [4] }), []);
+
+assert.deepEqual(crypto.hashBatch('md5', []), []);
+
+assert.throws(function() {
+  crypto.hashBatch('md5', data, { offsets: [0, 6, 3] });
+}, RangeError);
+assert.throws(function() {
+  crypto.hashBatch('md5', data, { offsets: [0, 14] });
+}, RangeError);
+assert.throws(function() {
+  crypto.hashBatch('md5', data, { offsets: [0, -1] });
+}, RangeError);
+assert.throws(function() {
+  crypto.hashBatch('md5', data);
+}, /offsets are required/);
+assert.throws(function() {
+  crypto.hashBatch('md5', 'foo');
+}, /inputs must be/);
+assert.throws(function() {
+  crypto.hashBatch('no-such-digest', words);
+}, /Digest method not supported/);
+
+// On the thread pool, large enough to be split across threads
+var big = [];
+for (var i = 0; i < 200; i++) {
+  var buf = new Buffer(4096 + i);
+  buf.fill(i);
+  big.push(buf);
+}
+
+var calls = 0;
+crypto.hashBatch('md5', big, { encoding: 'hex' }, function(err, res) {
+  assert.ifError(err);
+  assert.deepEqual(res, big.map(md5));
+  calls++;
+});
+
+crypto.hashBatch('sha1', words, function(err, res) {
+  assert.ifError(err);
+  assert.equal(res[1].toString('hex'),
+               crypto.createHash('sha1').update('bar').digest('hex'));
+  calls++;
+});
+
+var sync = true;
+crypto.hashBatch('md5', [], function(err, res) {
+  assert.ifError(err);
+  assert.deepEqual(res, []);
+  assert(!sync);
+  calls++;
+});
+sync = false;
+
+process.on('exit', function() {
+  assert.equal(calls, 3);
+});
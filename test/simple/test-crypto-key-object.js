@@ -0,0 +1,129 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+crypto.DEFAULT_ENCODING = 'buffer';
+
+var fs = require('fs');
+
+function read(name) {
+  return fs.readFileSync(common.fixturesDir + '/' + name, 'ascii');
+}
+
+var rsaPriv = read('test_rsa_privkey.pem');
+var rsaPub = read('test_rsa_pubkey.pem');
+var rsaEncrypted = read('test_rsa_privkey_encrypted.pem');
+var dsaPriv = read('test_dsa_privkey.pem');
+var dsaPub = read('test_dsa_pubkey.pem');
+var ecPriv = read('keys/ec-key.pem');
+var ecCert = read('keys/ec-cert.pem');
+var certPem = read('test_cert.pem');
+var keyPem = read('test_key.pem');
+
+var data = 'Test123 to be signed';
+
+// Key object properties
+var key = crypto.createPrivateKey(rsaPriv);
+assert(key instanceof crypto.KeyObject);
+assert.equal(key.type, 'private');
+assert.equal(key.asymmetricKeyType, 'rsa');
+assert.equal(key.size, 1024);
+
+key = crypto.createPublicKey(rsaPub);
+assert.equal(key.type, 'public');
+assert.equal(key.asymmetricKeyType, 'rsa');
+
+assert.equal(crypto.createPrivateKey(dsaPriv).asymmetricKeyType, 'dsa');
+assert.equal(crypto.createPublicKey(dsaPub).asymmetricKeyType, 'dsa');
+assert.equal(crypto.createPrivateKey(ecPriv).asymmetricKeyType, 'ec');
+assert.equal(crypto.createPublicKey(ecCert).asymmetricKeyType, 'ec');
+assert.equal(crypto.createPublicKey(certPem).asymmetricKeyType, 'rsa');
+
+assert.throws(function() {
+  crypto.createPrivateKey('not a key');
+}, /PEM_read_bio_PrivateKey|no start line/);
+assert.throws(function() {
+  crypto.createPublicKey('not a key');
+}, /PEM_read_bio_PUBKEY|no start line/);
+assert.throws(function() {
+  crypto.createPrivateKey({ key: rsaEncrypted, passphrase: 'wrong' });
+});
+
+// Signatures made with a key object match the ones made from PEM
+[
+  [rsaPriv, rsaPub, 'RSA-SHA256'],
+  [keyPem, certPem, 'RSA-SHA1'],
+  [{ key: rsaEncrypted, passphrase: 'password' }, rsaPub, 'RSA-SHA256']
+].forEach(function(t) {
+  var priv = crypto.createPrivateKey(t[0]);
+  var pub = crypto.createPublicKey(t[1]);
+
+  var expected = crypto.createSign(t[2]).update(data).sign(t[0], 'hex');
+  var sig = crypto.createSign(t[2]).update(data).sign(priv, 'hex');
+  assert.equal(sig, expected);
+  assert.equal(crypto.sign(t[2], data, priv, 'hex'), expected);
+  assert.equal(crypto.sign(t[2], data, t[0], 'hex'), expected);
+
+  assert(crypto.createVerify(t[2]).update(data).verify(pub, sig, 'hex'));
+  assert(crypto.createVerify(t[2]).update(data).verify(priv, sig, 'hex'));
+  assert(crypto.verify(t[2], data, pub, sig, 'hex'));
+  assert(crypto.verify(t[2], data, t[1], sig, 'hex'));
+  assert(!crypto.verify(t[2], data + '!', pub, sig, 'hex'));
+});
+
+// DSA and ECDSA signatures are randomized, check that they verify
+[
+  [dsaPriv, dsaPub, 'DSS1'],
+  [ecPriv, ecCert, 'SHA256']
+].forEach(function(t) {
+  var priv = crypto.createPrivateKey(t[0]);
+  var pub = crypto.createPublicKey(t[1]);
+
+  var sig = crypto.sign(t[2], data, priv);
+  assert(Buffer.isBuffer(sig));
+  assert(crypto.verify(t[2], data, pub, sig));
+  assert(crypto.verify(t[2], data, t[1], sig));
+  assert(crypto.createVerify(t[2]).update(data).verify(pub, sig));
+
+  sig = crypto.createSign(t[2]).update(data).sign(priv);
+  assert(crypto.verify(t[2], data, pub, sig));
+});
+
+// A public key can't sign
+assert.throws(function() {
+  crypto.createSign('RSA-SHA256').update(data)
+        .sign(crypto.createPublicKey(rsaPub));
+}, /Not a private key/);
+assert.throws(function() {
+  crypto.sign('RSA-SHA256', data, crypto.createPublicKey(rsaPub));
+}, /Not a private key/);
+
+assert.throws(function() {
+  crypto.sign('no-such-digest', data, crypto.createPrivateKey(rsaPriv));
+}, /Unknown message digest/);
@@ -76,3 +76,27 @@ function checkCall(cb, desc) {
 assert.throws(function() {
   crypto.randomBytes(0x3fffffff + 1);
 }, TypeError);
+
+// Small async requests may be served from a pool of pregenerated bytes.
+// They must still call back asynchronously and never repeat themselves.
+setTimeout(function() {
+  var seen = {};
+  var pending = 5000;
+  var sync = true;
+  for (var i = 0; i < 5000; i++) {
+    crypto.randomBytes(16, function(ex, buf) {
+      assert.equal(null, ex);
+      assert.equal(16, buf.length);
+      assert(!sync);
+      var hex = buf.toString('hex');
+      assert(!seen[hex], 'random bytes repeated');
+      seen[hex] = true;
+      pending--;
+    });
+  }
+  sync = false;
+
+  process.on('exit', function() {
+    assert.equal(0, pending);
+  });
+}, 50);
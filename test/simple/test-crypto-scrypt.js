@@ -0,0 +1,139 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+// RFC 7914, section 12.
+var vectors = [
+  {
+    password: '',
+    salt: '',
+    N: 16, r: 1, p: 1,
+    expected:
+        '77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442' +
+        'fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906'
+  },
+  {
+    password: 'password',
+    salt: 'NaCl',
+    N: 1024, r: 8, p: 16,
+    expected:
+        'fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162' +
+        '2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640'
+  },
+  {
+    password: 'pleaseletmein',
+    salt: 'SodiumChloride',
+    N: 16384, r: 8, p: 1,
+    expected:
+        '7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2' +
+        'd5432955613f0fcf62d49705242a9af9e61e85dc0d651e40dfcf017b45575887'
+  }
+];
+
+vectors.forEach(function(v) {
+  var options = { N: v.N, r: v.r, p: v.p };
+  var key = crypto.scryptSync(v.password, v.salt, 64, options);
+  assert.equal(key.toString('hex'), v.expected);
+
+  crypto.scrypt(v.password, v.salt, 64, options,
+                common.mustCall(function(er, key) {
+    assert.ifError(er);
+    assert.equal(key.toString('hex'), v.expected);
+  }));
+});
+
+// The defaults are N=16384, r=8, p=1, which is the third vector.
+assert.equal(crypto.scryptSync('pleaseletmein', 'SodiumChloride', 64)
+                   .toString('hex'),
+             vectors[2].expected);
+
+assert.throws(function() {
+  crypto.scrypt('password', 'salt', 64);
+}, /No callback provided to scrypt/);
+
+// N must be a power of two greater than one.
+[0, 1, 3, 1000, 1.5, -16].forEach(function(N) {
+  assert.throws(function() {
+    crypto.scryptSync('password', 'salt', 64, { N: N });
+  }, /Invalid scrypt parameters/);
+});
+
+assert.throws(function() {
+  crypto.scryptSync('password', 'salt', 64, { N: 16, r: 0 });
+}, /Invalid scrypt parameters/);
+
+assert.throws(function() {
+  crypto.scryptSync('password', 'salt', 64, { N: 16, p: 0 });
+}, /Invalid scrypt parameters/);
+
+// 128 * N * r bytes for N=2^20, r=8 is a gigabyte.
+assert.throws(function() {
+  crypto.scryptSync('password', 'salt', 64, { N: 1 << 20 });
+}, /scrypt parameters exceed maxmem/);
+
+assert.throws(function() {
+  crypto.scryptSync('password', 'salt', 64, { maxmem: -1 });
+}, /Bad maxmem/);
+
+assert.throws(function() {
+  crypto.scryptSync('password', 'salt', -1);
+}, /Bad key length/);
+
+// Cancelling fails the request with ECANCELED instead of deriving the key,
+// whether it is still queued or already running.
+function expectCancel(er, key) {
+  assert(er instanceof Error);
+  assert.equal(er.code, 'ECANCELED');
+  assert.equal(key, undefined);
+}
+
+var options = { N: 1 << 18, maxmem: 1 << 30 };
+var req = crypto.scrypt('password', 'salt', 64, options,
+                        common.mustCall(expectCancel));
+req.cancel();
+
+req = crypto.pbkdf2('password', 'salt', 1e9, 64, common.mustCall(expectCancel));
+setTimeout(function() {
+  req.cancel();
+}, 50);
+
+// Cancelling a request that has completed does nothing.
+var done = crypto.pbkdf2('password', 'salt', 1, 20,
+                         common.mustCall(function(er, key) {
+  assert.ifError(er);
+  assert.equal(key.toString('hex'), '0c60c80f961f0e71f3a9b524af6012062fe037a6');
+  done.cancel();
+}));
+
+if (process.platform !== 'win32') {
+  var stats = process.binding('uv').getThreadpoolStats();
+  assert.equal(typeof stats.slowCpu.limit, 'number');
+  assert(stats.slowCpu.limit > 0);
+}
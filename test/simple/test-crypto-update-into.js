@@ -0,0 +1,134 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+var key = new Buffer('0123456789abcdef0123456789abcdef', 'hex');
+var iv = new Buffer('fedcba9876543210fedcba9876543210', 'hex');
+
+var plain = new Buffer(1000);
+for (var i = 0; i < plain.length; i++)
+  plain[i] = i & 0xff;
+
+function expected(alg) {
+  var c = crypto.createCipheriv(alg, key, iv);
+  return Buffer.concat([c.update(plain), c.final()]);
+}
+
+// Stream mode: into a separate buffer at an offset, in pieces.
+(function() {
+  var c = crypto.createCipheriv('aes-128-ctr', key, iv);
+  var out = new Buffer(plain.length + 10);
+  var off = 10;
+  off += c.updateInto(plain.slice(0, 333), out, off);
+  off += c.updateInto(plain.slice(333), out, off);
+  assert.equal(off, plain.length + 10);
+  assert.equal(c.final().length, 0);
+  assert.deepEqual(out.slice(10), expected('aes-128-ctr'));
+})();
+
+// Stream mode: in place, both ways.
+(function() {
+  var buf = new Buffer(plain);
+  var c = crypto.createCipheriv('aes-128-ctr', key, iv);
+  assert.equal(c.updateInto(buf), plain.length);
+  assert.deepEqual(buf, expected('aes-128-ctr'));
+
+  var d = crypto.createDecipheriv('aes-128-ctr', key, iv);
+  assert.equal(d.updateInto(buf, buf), plain.length);
+  assert.deepEqual(buf, plain);
+})();
+
+// GCM in place, the tag still checks out.
+(function() {
+  var buf = new Buffer(plain);
+  var c = crypto.createCipheriv('aes-128-gcm', key, iv.slice(0, 12));
+  c.updateInto(buf);
+  c.final();
+  var tag = c.getAuthTag();
+
+  var d = crypto.createDecipheriv('aes-128-gcm', key, iv.slice(0, 12));
+  d.setAuthTag(tag);
+  d.updateInto(buf);
+  d.final();
+  assert.deepEqual(buf, plain);
+})();
+
+// Block mode: output may lag the input by a block.
+(function() {
+  var c = crypto.createCipheriv('aes-128-cbc', key, iv);
+  var out = new Buffer(plain.length + 16);
+  var n = c.updateInto(plain.slice(0, 10), out, 0);
+  assert.equal(n, 0);
+  n += c.updateInto(plain.slice(10), out, n);
+  var rest = c.final();
+  assert.deepEqual(Buffer.concat([out.slice(0, n), rest]),
+                   expected('aes-128-cbc'));
+
+  var d = crypto.createDecipheriv('aes-128-cbc', key, iv);
+  var enc = expected('aes-128-cbc');
+  var dec = new Buffer(enc.length + 16);
+  n = d.updateInto(enc, dec, 0);
+  rest = d.final();
+  assert.deepEqual(Buffer.concat([dec.slice(0, n), rest]), plain);
+})();
+
+// Block modes can't work in place.
+assert.throws(function() {
+  crypto.createCipheriv('aes-128-cbc', key, iv).updateInto(new Buffer(32));
+}, /in place/);
+
+// Overlapping, but not aliased, buffers are refused for stream modes too.
+assert.throws(function() {
+  var buf = new Buffer(64);
+  crypto.createCipheriv('aes-128-ctr', key, iv).updateInto(buf.slice(0, 32),
+                                                           buf.slice(1));
+}, /in place/);
+
+// Not enough room.
+assert.throws(function() {
+  crypto.createCipheriv('aes-128-cbc', key, iv).updateInto(new Buffer(32),
+                                                           new Buffer(40));
+}, RangeError);
+assert.throws(function() {
+  crypto.createCipheriv('aes-128-ctr', key, iv).updateInto(new Buffer(32),
+                                                           new Buffer(32),
+                                                           1);
+}, RangeError);
+assert.throws(function() {
+  crypto.createCipheriv('aes-128-ctr', key, iv).updateInto(new Buffer(1),
+                                                           new Buffer(1),
+                                                           2);
+}, RangeError);
+
+// Only buffers are accepted.
+assert.throws(function() {
+  crypto.createCipheriv('aes-128-ctr', key, iv).updateInto('abc',
+                                                           new Buffer(32));
+}, TypeError);
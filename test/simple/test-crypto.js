@@ -810,6 +810,71 @@ var p = 'FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74' +
 var bad_dh = crypto.createDiffieHellman(p, 'hex');
 assert.equal(bad_dh.verifyError, constants.DH_NOT_SUITABLE_GENERATOR);
 
+// Test ECDH
+var ecdh1 = crypto.createECDH('prime256v1');
+var ecdh2 = crypto.createECDH('prime256v1');
+key1 = ecdh1.generateKeys();
+key2 = ecdh2.generateKeys('hex');
+var secret1 = ecdh1.computeSecret(key2, 'hex', 'base64');
+var secret2 = ecdh2.computeSecret(key1, 'binary', 'buffer');
+
+assert.equal(secret1, secret2.toString('base64'));
+assert.equal(secret2.length, 32);
+
+// Point formats
+assert.equal(ecdh1.getPublicKey('buffer', 'uncompressed')[0], 4);
+var firstByte = ecdh1.getPublicKey('buffer', 'compressed')[0];
+assert(firstByte === 2 || firstByte === 3);
+firstByte = ecdh1.getPublicKey('buffer', 'hybrid')[0];
+assert(firstByte === 6 || firstByte === 7);
+assert.throws(function() {
+  ecdh1.getPublicKey('buffer', 'sideways');
+}, /Bad format/);
+
+// Compressed and uncompressed keys give the same secret
+assert.equal(ecdh2.computeSecret(ecdh1.getPublicKey('hex', 'compressed'),
+                                 'hex', 'base64'),
+             secret1);
+
+// ECDH should check that point is on curve
+var ecdh3 = crypto.createECDH('secp256k1');
+var key3 = ecdh3.generateKeys();
+
+assert.throws(function() {
+  var secret3 = ecdh2.computeSecret(key3, 'binary', 'buffer');
+});
+
+// Setting the private key derives the public key
+var ecdh4 = crypto.createECDH('prime256v1');
+var ecdh5 = crypto.createECDH('prime256v1');
+ecdh4.setPrivateKey(new Array(32).join('00') + '2a', 'hex');
+ecdh5.setPrivateKey(new Buffer([7]));
+assert.equal(ecdh4.getPublicKey('hex', 'compressed'),
+             '026780c5fc70275e2c7061a0e7877bb174deadeb9887027f3fa83654158ba7f50c');
+assert.equal(ecdh5.getPrivateKey('hex'), new Array(32).join('00') + '07');
+assert.equal(ecdh4.computeSecret(ecdh5.getPublicKey(), null, 'hex'),
+             '8ac04c276d3c8b7eb1d132087534d1f5311b80c9f88825ff6c1de0cd2556182b');
+
+// Keys outside of [1, order) are rejected
+assert.throws(function() {
+  ecdh4.setPrivateKey(new Buffer([0]));
+}, /not valid/);
+assert.throws(function() {
+  ecdh4.setPrivateKey(new Array(33).join('ff'), 'hex');
+}, /not valid/);
+
+// Setting only the public key allows nothing but reading it back
+var ecdh6 = crypto.createECDH('prime256v1');
+ecdh6.setPublicKey(ecdh5.getPublicKey());
+assert.equal(ecdh6.getPublicKey('hex'), ecdh5.getPublicKey('hex'));
+assert.throws(function() {
+  ecdh6.computeSecret(ecdh4.getPublicKey());
+}, /No private key/);
+
+assert.throws(function() {
+  crypto.createECDH('no-such-curve');
+}, /valid curve name/);
+
 // Test RSA key signing/verification
 var rsaSign = crypto.createSign('RSA-SHA1');
 var rsaVerify = crypto.createVerify('RSA-SHA1');
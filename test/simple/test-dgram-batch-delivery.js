@@ -0,0 +1,98 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+// Linux routes all of 127/8 to the loopback interface. Use more sources
+// than the socket caches addresses for.
+var hosts = ['127.0.0.1', '127.0.0.1'];
+if (process.platform === 'linux')
+  for (var i = 2; i <= 20; i++)
+    hosts.push('127.0.0.' + i);
+
+var PER_SOURCE = 5;
+var N = hosts.length * PER_SOURCE;
+
+var target = dgram.createSocket('udp4');
+var sources = [];
+var received = {};
+var batches = 0;
+var count = 0;
+
+process.on('exit', function() {
+  assert.equal(count, N);
+  assert(batches > 0);
+  // Elsewhere there is no recvmmsg() and every batch holds one datagram.
+  if (process.platform === 'linux')
+    assert(batches < N);
+});
+
+target.setBatchDelivery(true);
+
+target.on('message', function() {
+  assert.fail('message event in batch mode');
+});
+
+target.on('batch', function(buf, entries, addresses) {
+  batches++;
+  assert(Buffer.isBuffer(buf));
+  assert.equal(entries.length % 5, 0);
+
+  for (var i = 0; i < entries.length; i += 5) {
+    var msg = buf.slice(entries[i], entries[i] + entries[i + 1]).toString();
+    var family = entries[i + 2];
+    var port = entries[i + 3];
+    var address = addresses[entries[i + 4]];
+
+    // Every message names the source it was sent from.
+    var parts = msg.split(' ');
+    assert.equal(family, 4);
+    assert.equal(address, parts[0]);
+    assert.equal(port, +parts[1]);
+    assert(!received[msg]);
+    received[msg] = true;
+    count++;
+  }
+
+  if (count === N) {
+    sources.forEach(function(source) {
+      source.close();
+    });
+    target.close();
+  }
+});
+
+target.on('listening', function() {
+  hosts.forEach(function(host) {
+    var source = dgram.createSocket('udp4');
+    sources.push(source);
+    source.bind(0, host, function() {
+      for (var k = 0; k < PER_SOURCE; k++) {
+        var buf = new Buffer(host + ' ' + source.address().port + ' ' + k);
+        source.send(buf, 0, buf.length, common.PORT, '127.0.0.1');
+      }
+    });
+  });
+});
+
+target.bind(common.PORT);
@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var N = 100;
+
+var source = dgram.createSocket('udp4');
+var target = dgram.createSocket('udp4');
+var received = [];
+
+function payload(i) {
+  // Mix tiny datagrams with ones that take most of a receive slot.
+  var buf = new Buffer(i % 10 === 0 ? 9000 : i + 1);
+  buf.fill(i);
+  return buf;
+}
+
+process.on('exit', function() {
+  assert.equal(received.length, N);
+});
+
+target.setBatchReceive(true);
+
+target.on('message', function(buf, rinfo) {
+  assert.equal(rinfo.address, '127.0.0.1');
+  assert.equal(rinfo.port, source.address().port);
+  assert.equal(rinfo.size, buf.length);
+  received.push(buf);
+
+  if (received.length < N)
+    return;
+
+  // Batches are read into a buffer that is reused, check that every message
+  // kept its own copy.
+  received.sort(function(a, b) { return a[0] - b[0]; });
+  received.forEach(function(buf, i) {
+    assert.deepEqual(buf, payload(i));
+  });
+
+  target.setBatchReceive(false);
+  source.close();
+  target.close();
+});
+
+target.on('listening', function() {
+  source.bind(0, '127.0.0.1', function() {
+    for (var i = 0; i < N; i++) {
+      var buf = payload(i);
+      source.send(buf, 0, buf.length, common.PORT, '127.0.0.1');
+    }
+  });
+});
+
+target.bind(common.PORT);
@@ -0,0 +1,164 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+
+var filename = path.join(common.tmpDir, 'sendfile.txt');
+var copyname = path.join(common.tmpDir, 'sendfile-copy.txt');
+
+// Big enough to fill the socket buffer a couple of times over.
+var data = new Buffer(4 * 1024 * 1024 + 17);
+for (var i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(filename, data);
+
+// File to file, synchronous and asynchronous.
+var inFd = fs.openSync(filename, 'r');
+var outFd = fs.openSync(copyname, 'w');
+var sent = 0;
+while (sent < 1024) {
+  var n = fs.sendfileSync(outFd, inFd, 100 + sent, 1024 - sent);
+  assert(n > 0);
+  sent += n;
+}
+assert.equal(fs.sendfileSync(outFd, inFd, data.length, 10), 0);
+fs.closeSync(outFd);
+assert.deepEqual(fs.readFileSync(copyname), data.slice(100, 1124));
+
+assert.throws(function() {
+  fs.sendfileSync(outFd, inFd, -1, 10);
+}, TypeError);
+
+var asyncDone = false;
+outFd = fs.openSync(copyname, 'w');
+fs.sendfile(outFd, inFd, 0, 4096, function(er, bytesSent) {
+  assert.ifError(er);
+  assert.equal(bytesSent, 4096);
+  fs.closeSync(outFd);
+  fs.closeSync(inFd);
+  assert.deepEqual(fs.readFileSync(copyname), data.slice(0, 4096));
+  asyncDone = true;
+});
+
+// Piping a ReadStream into a socket, whole file and a range. Writes made
+// while the file is going out must not end up in the middle of it.
+function check(options, expected, cb) {
+  var server = net.createServer(function(socket) {
+    socket.write('header\n');
+    var stream = fs.createReadStream(filename, options);
+    var ended = false;
+    stream.on('end', function() {
+      ended = true;
+    });
+    stream.pipe(socket, { end: false });
+    if (process.platform !== 'win32')
+      assert.equal(stream._sendfile, true);
+    socket.write('trai');
+    socket.end('ler\n');
+    socket.on('finish', function() {
+      assert(ended);
+    });
+  });
+
+  server.listen(common.PORT, function() {
+    var chunks = [];
+    var client = net.connect(common.PORT);
+    client.on('data', function(chunk) {
+      chunks.push(chunk);
+    });
+    client.on('end', function() {
+      var received = Buffer.concat(chunks);
+      assert.equal(received.length, expected.length + 15);
+      assert.equal(received.slice(0, 7).toString(), 'header\n');
+      assert.deepEqual(received.slice(7, -8), expected);
+      assert.equal(received.slice(-8).toString(), 'trailer\n');
+      server.close(cb);
+    });
+  });
+}
+
+// Destroying the socket in the middle of a transfer stops it and closes
+// the file. The connection accepted next, which is likely to get the same
+// fd number, must only see its own bytes.
+function checkDestroy(cb) {
+  var fileClosed = false;
+  var connections = 0;
+  var server = net.createServer(function(socket) {
+    if (++connections === 2)
+      return socket.end('second');
+    var stream = fs.createReadStream(filename);
+    stream.on('close', function() {
+      fileClosed = true;
+    });
+    stream.pipe(socket);
+    setTimeout(function() {
+      socket.destroy();
+    }, 50);
+  });
+
+  server.listen(common.PORT, function() {
+    // Don't read until the server gave up, so the file can't go out in
+    // one go.
+    var first = net.connect(common.PORT);
+    first.pause();
+    setTimeout(function() {
+      first.resume();
+    }, 100);
+    first.on('error', function() {});
+    first.on('close', function() {
+      var received = '';
+      var second = net.connect(common.PORT);
+      second.setEncoding('utf8');
+      second.on('data', function(chunk) {
+        received += chunk;
+      });
+      second.on('end', function() {
+        assert.equal(received, 'second');
+        server.close(function() {
+          assert(fileClosed);
+          cb();
+        });
+      });
+    });
+  });
+}
+
+var pipesDone = 0;
+check({}, data, function() {
+  pipesDone++;
+  check({ start: 1000, end: 1999 }, data.slice(1000, 2000), function() {
+    pipesDone++;
+    checkDestroy(function() {
+      pipesDone++;
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert(asyncDone);
+  assert.equal(pipesDone, 3);
+  fs.unlinkSync(filename);
+  fs.unlinkSync(copyname);
+});
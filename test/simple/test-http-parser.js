@@ -556,3 +556,158 @@ function expectBody(expected) {
   parser[kOnHeadersComplete] = onHeadersComplete2;
   parser.execute(req2, 0, req2.length);
 })();
+
+
+//
+// Test headers fed one byte at a time across pipelined requests.
+//
+(function() {
+  var request = '';
+  var expected = [];
+  for (var i = 0; i < 2; ++i) {
+    var headers = [];
+    request += 'GET /req' + i + ' HTTP/1.1' + CRLF;
+    for (var j = 0; j < 10; ++j) {
+      headers.push('X-Header-' + j, 'value ' + i + ' ' + j);
+      request += 'X-Header-' + j + ': value ' + i + ' ' + j + CRLF;
+    }
+    request += CRLF;
+    expected.push(headers);
+  }
+  request = Buffer(request);
+
+  var seen = 0;
+  var parser = newParser(REQUEST);
+
+  parser[kOnHeadersComplete] = mustCall(function(info) {
+    assert.equal(info.url || parser.url, '/req' + seen);
+    assert.deepEqual(info.headers || parser.headers, expected[seen]);
+    parser.headers = [];
+    parser.url = '';
+    seen++;
+  }, 2);
+
+  for (var i = 0; i < request.length; ++i) {
+    parser.execute(request.slice(i, i + 1));
+  }
+})();
+
+
+//
+// Test flat header mode.
+//
+(function() {
+  var request = Buffer(
+      'GET /flat HTTP/1.1' + CRLF +
+      'Host: example.com' + CRLF +
+      'Content-Type: text/plain' + CRLF +
+      CRLF);
+
+  var parser = newParser(REQUEST);
+  parser.setFlatHeaders(true);
+
+  parser[kOnHeadersComplete] = mustCall(function(info) {
+    var data = info.headers;
+    var table = info.headerTable;
+    assert.ok(Buffer.isBuffer(data));
+    assert.equal(table.length, 8);
+
+    var headers = [];
+    for (var i = 0; i < table.length; i += 2) {
+      var start = table[i];
+      headers.push(data.toString('binary', start, start + table[i + 1]));
+    }
+    assert.deepEqual(headers,
+        ['Host', 'example.com',
+         'Content-Type', 'text/plain']);
+    assert.equal(info.url, '/flat');
+  });
+
+  parser.execute(request);
+})();
+
+
+//
+// Test that many headers are delivered in a single callback.
+//
+(function() {
+  var request = 'GET /many HTTP/1.1' + CRLF;
+  for (var i = 0; i < 100; ++i)
+    request += 'X-Header-' + i + ': ' + i + CRLF;
+  request = Buffer(request + CRLF);
+
+  var parser = newParser(REQUEST);
+
+  parser[kOnHeaders] = function() {
+    assert.ok(false, 'Function should not be called.');
+  };
+
+  parser[kOnHeadersComplete] = mustCall(function(info) {
+    assert.equal(info.url, '/many');
+    assert.equal(info.headers.length, 2 * 100);
+    for (var i = 0; i < 100; ++i) {
+      assert.equal(info.headers[2 * i], 'X-Header-' + i);
+      assert.equal(info.headers[2 * i + 1], String(i));
+    }
+  });
+
+  parser.execute(request);
+})();
+
+
+//
+// Test that headers beyond the parser's table are flushed in batches.
+//
+(function() {
+  var request = 'GET /more HTTP/1.1' + CRLF;
+  for (var i = 0; i < 1500; ++i)
+    request += 'X-Header-' + i + ': ' + i + CRLF;
+  request = Buffer(request + CRLF);
+
+  var parser = newParser(REQUEST);
+  var flushes = 0;
+
+  parser[kOnHeaders] = function(headers, url) {
+    flushes++;
+    parser.headers = parser.headers.concat(headers);
+    parser.url += url;
+  };
+
+  parser[kOnHeadersComplete] = mustCall(function(info) {
+    assert.equal(flushes, 2);
+    assert.equal(info.headers, undefined);
+    assert.equal(info.url, undefined);
+    assert.equal(parser.url, '/more');
+    var headers = parser.headers;
+    assert.equal(headers.length, 2 * 1500);
+    for (var i = 0; i < 1500; ++i) {
+      assert.equal(headers[2 * i], 'X-Header-' + i);
+      assert.equal(headers[2 * i + 1], String(i));
+    }
+  });
+
+  parser.execute(request);
+})();
+
+//
+// Test a large header value fed one byte at a time.
+//
+(function() {
+  var value = new Array(64 * 1024 + 1).join('x');
+  var request = Buffer(
+      'GET /large HTTP/1.1' + CRLF +
+      'X-Large: ' + value + CRLF +
+      CRLF);
+
+  var parser = newParser(REQUEST);
+
+  parser[kOnHeadersComplete] = mustCall(function(info) {
+    var headers = info.headers || parser.headers;
+    assert.equal(headers.length, 2);
+    assert.equal(headers[0], 'X-Large');
+    assert.equal(headers[1], value);
+  });
+
+  for (var i = 0; i < request.length; ++i)
+    parser.execute(request, i, 1);
+})();
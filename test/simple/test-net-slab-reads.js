@@ -0,0 +1,81 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Read buffers are carved out of shared slabs. Make sure buffers handed out
+// to different connections don't overlap and stay intact while later reads
+// reuse the same slab.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var CONNECTIONS = 20;
+var WRITES = 50;
+var received = [];
+var closed = 0;
+
+var server = net.createServer(function(socket) {
+  var chunks = [];
+  socket.on('data', function(chunk) {
+    // Keep every chunk alive so that its slab can't be freed or reused.
+    chunks.push(chunk);
+  });
+  socket.on('end', function() {
+    received.push(Buffer.concat(chunks));
+    socket.end();
+  });
+});
+
+server.listen(common.PORT, function() {
+  for (var i = 0; i < CONNECTIONS; i++)
+    connect(i);
+});
+
+function connect(id) {
+  var socket = net.connect(common.PORT);
+  var payload = new Buffer(id + 1);
+  payload.fill(id);
+
+  socket.on('connect', function() {
+    var n = 0;
+    (function write() {
+      if (n++ === WRITES)
+        return socket.end();
+      socket.write(payload, write);
+    })();
+  });
+
+  socket.on('close', function() {
+    if (++closed === CONNECTIONS)
+      server.close();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(received.length, CONNECTIONS);
+  received.forEach(function(buf) {
+    assert.ok(buf.length > 0);
+    var id = buf[0];
+    assert.equal(buf.length, (id + 1) * WRITES);
+    for (var i = 0; i < buf.length; i++)
+      assert.equal(buf[i], id);
+  });
+});
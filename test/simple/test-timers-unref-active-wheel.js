@@ -0,0 +1,84 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var spawn = require('child_process').spawn;
+var timers = require('timers');
+
+if (process.execArgv.indexOf('--timer-wheel') !== -1 &&
+    !process._timerWheel) {
+  console.error('Skipping: timer wheel is not supported on this platform.');
+  return;
+}
+
+if (!process._timerWheel) {
+  var child = spawn(process.execPath, ['--timer-wheel', __filename], {
+    stdio: 'inherit'
+  });
+  child.on('exit', function(code) {
+    assert.equal(code, 0);
+  });
+  return;
+}
+
+var fired = [];
+var keepAlive = setTimeout(function() {}, 1000);
+
+function makeItem(name, msecs) {
+  var item = {
+    _onTimeout: function() {
+      assert.ok(Date.now() - start >= this._idleTimeout - 1);
+      fired.push(name);
+    }
+  };
+  timers.enroll(item, msecs);
+  timers._unrefActive(item);
+  return item;
+}
+
+var start = Date.now();
+makeItem('c', 150);
+var b = makeItem('b', 100);
+makeItem('a', 50);
+var cancelled = makeItem('cancelled', 20);
+timers.unenroll(cancelled);
+
+// Resetting an item postpones its timeout.
+for (var i = 0; i < 1000; i++)
+  timers._unrefActive(b);
+
+// Re-enrolling an item replaces its timeout, the old one must not fire.
+var moved = makeItem('moved', 30);
+timers.enroll(moved, 120);
+timers._unrefActive(moved);
+
+// So does moving it to a regular timer.
+var active = makeItem('active', 40);
+timers.enroll(active, 130);
+timers.active(active);
+
+// Items that are never reset must not hold the loop open.
+makeItem('unref', 5000);
+
+process.on('exit', function() {
+  assert.deepEqual(fired, ['a', 'b', 'moved', 'active', 'c']);
+});
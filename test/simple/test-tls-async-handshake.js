@@ -0,0 +1,125 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var fs = require('fs');
+var net = require('net');
+var tls = require('tls');
+
+function loadPEM(n) {
+  return fs.readFileSync(common.fixturesDir + '/keys/' + n + '.pem');
+}
+
+var options = {
+  key: loadPEM('agent2-key'),
+  cert: loadPEM('agent2-cert'),
+  asyncHandshake: true
+};
+
+var clients = 10;
+var secured = 0;
+var echoed = 0;
+var sniChecked = false;
+var clientErrors = 0;
+
+var server = tls.createServer(options, function(conn) {
+  secured++;
+  conn.pipe(conn);
+});
+server.on('clientError', function(err) {
+  clientErrors++;
+});
+
+if (process.features.tls_sni) {
+  server.addContext('a.example.com', {
+    key: loadPEM('agent1-key'),
+    cert: loadPEM('agent1-cert')
+  });
+}
+
+server.listen(common.PORT, function() {
+  var pending = clients + 2;
+  function done() {
+    if (--pending === 0)
+      server.close();
+  }
+
+  // Several handshakes in flight at once, data is written before they finish.
+  for (var i = 0; i < clients; i++) {
+    (function(i) {
+      var conn = tls.connect({
+        port: common.PORT,
+        rejectUnauthorized: false
+      });
+      var msg = 'hello ' + i;
+      var received = '';
+      conn.setEncoding('utf8');
+      conn.write(msg);
+      conn.on('data', function(d) {
+        received += d;
+        if (received.length < msg.length)
+          return;
+        assert.equal(received, msg);
+        echoed++;
+        conn.end();
+      });
+      conn.on('close', done);
+    })(i);
+  }
+
+  // The SNI context is picked off the main thread.
+  if (process.features.tls_sni) {
+    var sni = tls.connect({
+      port: common.PORT,
+      servername: 'a.example.com',
+      rejectUnauthorized: false
+    }, function() {
+      assert.equal(sni.getPeerCertificate().subject.CN, 'agent1');
+      sniChecked = true;
+      sni.end();
+    });
+    sni.on('close', done);
+  } else {
+    sniChecked = true;
+    done();
+  }
+
+  // Bad handshakes are still reported.
+  var junk = net.connect(common.PORT, function() {
+    junk.end(new Array(64).join('junk\r\n'));
+  });
+  junk.on('error', function() {});
+  junk.on('close', done);
+});
+
+process.on('exit', function() {
+  assert.equal(secured, clients + 1);
+  assert.equal(echoed, clients);
+  assert(sniChecked);
+  assert.equal(clientErrors, 1);
+});
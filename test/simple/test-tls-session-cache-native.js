@@ -0,0 +1,157 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+var common = require('../common');
+var assert = require('assert');
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var constants = require('constants');
+var fs = require('fs');
+var tls = require('tls');
+
+var options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  // Session ids only, tickets would bypass the cache.
+  secureOptions: constants.SSL_OP_NO_TICKET
+};
+
+function connect(port, session, cb) {
+  var conn = tls.connect({
+    port: port,
+    session: session,
+    rejectUnauthorized: false
+  }, function() {
+    var reused = conn.isSessionReused();
+    var sess = conn.getSession();
+    conn.end();
+    cb(reused, sess);
+  });
+}
+
+function listen(server, port, cb) {
+  server.on('secureConnection', function(conn) {
+    conn.end();
+  });
+  server.on('resumeSession', function() {
+    assert(false, 'resumeSession must not be emitted on a cache hit');
+  });
+  server.listen(port, cb);
+}
+
+// Without a cache there's nothing to resume from.
+function testNoCache(next) {
+  var server = tls.createServer(options);
+  listen(server, common.PORT, function() {
+    connect(common.PORT, null, function(reused, session) {
+      assert(!reused);
+      connect(common.PORT, session, function(reused) {
+        assert(!reused);
+        server.close(next);
+      });
+    });
+  });
+}
+
+function testInProcess(next) {
+  options.sessionCacheSize = 16;
+  var server = tls.createServer(options);
+  delete options.sessionCacheSize;
+
+  listen(server, common.PORT, function() {
+    connect(common.PORT, null, function(reused, session) {
+      assert(!reused);
+      connect(common.PORT, session, function(reused) {
+        assert(reused);
+        connect(common.PORT, session, function(reused) {
+          assert(reused);
+          var stats = server.getSessionCacheStats();
+          assert.equal(stats.size, 1);
+          assert.equal(stats.hits, 2);
+          assert.equal(stats.shared, undefined);
+          server.close(next);
+        });
+      });
+    });
+  });
+}
+
+// Two servers with their own contexts stand in for two cluster workers.
+function testShared(next) {
+  if (process.platform === 'win32')
+    return next();
+
+  var name = 'node-test-' + common.PORT;
+  tls.unlinkSharedSessionCache(name);
+
+  options.sharedSessionCache = name;
+  var a = tls.createServer(options);
+  var b = tls.createServer(options);
+  // A different size doesn't fit the existing segment, it gets a new one.
+  options.sessionCacheSize = 64;
+  var c = tls.createServer(options);
+  delete options.sessionCacheSize;
+  delete options.sharedSessionCache;
+  assert.equal(c.getSessionCacheStats().shared.capacity, 64);
+
+  listen(a, common.PORT, function() {
+    listen(b, common.PORT + 1, function() {
+      connect(common.PORT, null, function(reused, session) {
+        assert(!reused);
+        connect(common.PORT + 1, session, function(reused) {
+          assert(reused);
+          var stats = b.getSessionCacheStats();
+          assert.equal(stats.shared.hits, 1);
+          assert(stats.shared.capacity >= 4096);
+          assert(a.getSessionCacheStats().shared.stores >= 1);
+          assert.equal(tls.unlinkSharedSessionCache(name), true);
+          assert.equal(tls.unlinkSharedSessionCache(name), false);
+          a.close();
+          b.close(next);
+        });
+      });
+    });
+  });
+}
+
+assert.throws(function() {
+  tls.createServer({ sharedSessionCache: 'a/b' });
+}, /sharedSessionCache/);
+
+assert.throws(function() {
+  tls.unlinkSharedSessionCache('a/b');
+}, TypeError);
+
+var done = false;
+testNoCache(function() {
+  testInProcess(function() {
+    testShared(function() {
+      done = true;
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert(done);
+});
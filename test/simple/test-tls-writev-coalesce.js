@@ -0,0 +1,91 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Small cleartext writes in a writev() batch are coalesced into full TLS
+// records, large ones are written as is. The bytes on the other end must
+// be exactly what was written, in order.
+
+var common = require('../common');
+var assert = require('assert');
+var tls = require('tls');
+var fs = require('fs');
+
+var dir = common.fixturesDir;
+var options = { key: fs.readFileSync(dir + '/test_key.pem'),
+                cert: fs.readFileSync(dir + '/test_cert.pem') };
+
+var kStage = 16 * 1024;
+var seed = 0;
+
+function chunk(size) {
+  var b = new Buffer(size);
+  for (var i = 0; i < size; i++)
+    b[i] = seed++ % 253;
+  return b;
+}
+
+var batches = [
+  // Small, large, small.
+  [chunk(10), chunk(100 * 1024), chunk(20)],
+  // Small buffers that exactly fill the stage, then more at offset zero.
+  [chunk(kStage / 2), chunk(kStage / 2), chunk(300), chunk(kStage)],
+  // A small buffer that straddles the stage boundary, then a large one
+  // while the stage is partially filled.
+  [chunk(kStage - 100), chunk(1000), chunk(3 * kStage), chunk(5),
+   chunk(kStage - 1), chunk(7)]
+];
+
+var expected = Buffer.concat(batches.map(Buffer.concat));
+var received = [];
+
+var server = tls.createServer(options, function(conn) {
+  conn.on('data', function(data) {
+    received.push(data);
+  });
+  conn.on('end', function() {
+    conn.end();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var conn = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  }, function() {
+    batches.forEach(function(batch) {
+      conn.cork();
+      batch.forEach(function(b) {
+        conn.write(b);
+      });
+      conn.uncork();
+    });
+    conn.end();
+  });
+  conn.on('end', function() {
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  var actual = Buffer.concat(received);
+  assert.equal(actual.length, expected.length);
+  assert.deepEqual(actual, expected);
+});
@@ -0,0 +1,68 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dns = require('dns');
+var fs = require('fs');
+var zlib = require('zlib');
+
+var uv = process.binding('uv');
+
+if (process.platform === 'win32') {
+  assert.throws(uv.getThreadpoolStats, /ENOSYS/);
+  return;
+}
+
+function sum(list) {
+  return list.reduce(function(a, b) { return a + b; }, 0);
+}
+
+var before = uv.getThreadpoolStats();
+var pending = 3;
+
+fs.stat(__filename, done);
+dns.lookup('localhost', done);
+zlib.deflate(new Buffer('threadpool'), done);
+
+function done(er) {
+  assert.ifError(er);
+  if (--pending > 0)
+    return;
+
+  var stats = uv.getThreadpoolStats();
+  assert(stats.threads >= stats.minThreads);
+  assert(stats.threads <= stats.maxThreads);
+  assert(stats.idle <= stats.threads);
+
+  ['cpu', 'io', 'dns'].forEach(function(name) {
+    var c = stats[name];
+    assert(c.completed > before[name].completed, name);
+    assert.equal(c.running, 0);
+    assert(c.limit >= 1 && c.limit <= stats.maxThreads);
+    assert.equal(c.wait.length, 24);
+    assert.equal(sum(c.wait), c.completed);
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(pending, 0);
+});